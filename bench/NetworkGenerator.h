@@ -0,0 +1,201 @@
+#ifndef FEUP_DA1_NETWORKGENERATOR_H
+#define FEUP_DA1_NETWORKGENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Generator of synthetic rail networks in the schema of data/stations.csv and data/network.csv
+ *
+ * @details The network is built like the real one:
+ * - districts lie on a grid, each with a hub and a few municipalities;
+ * - trunk lines join the hubs of neighbouring districts through intermediate stations, with a mix of STANDARD
+ *   and ALFA PENDULAR services and larger capacities;
+ * - branch lines start at a junction (any station of a district) and run for a few stations, STANDARD only and
+ *   with small capacities, sometimes ending at another station of the district and closing a loop.
+ *
+ * Capacities are even (the total of both directions, as in network.csv) and follow the distribution of the real
+ * network. The same seed and size always give the same network.
+ */
+class NetworkGenerator {
+private:
+    struct Station {
+        int district;
+        int municipality;
+        int line;
+    };
+
+    struct Link {
+        int a, b, capacity;
+        bool alfa;
+    };
+
+    std::mt19937_64 _rng;
+    std::vector<Station> _stations;
+    std::vector<Link> _links;
+    std::vector<std::vector<int>> _districtStations;
+    int _numLines = 0;
+    int _municipalitiesPerDistrict = 1;
+
+    int random(int low, int high) {
+        return std::uniform_int_distribution<int>(low, high)(_rng);
+    }
+
+    bool chance(double p) {
+        return std::bernoulli_distribution(p)(_rng);
+    }
+
+    int addStation(int district, int line) {
+        // Consecutive stations of a line usually share the municipality
+        int municipality = random(0, _municipalitiesPerDistrict - 1);
+        if (!_stations.empty() && _stations.back().district == district && _stations.back().line == line && chance(0.7)) {
+            municipality = _stations.back().municipality;
+        }
+
+        _stations.push_back({district, municipality, line});
+        _districtStations[district].push_back((int) _stations.size() - 1);
+        return (int) _stations.size() - 1;
+    }
+
+    int trunkCapacity() {
+        static const int capacities[] = {4, 4, 6, 8, 10};
+        return capacities[random(0, 4)];
+    }
+
+    int branchCapacity() {
+        int p = random(0, 99);
+        return p < 60 ? 2 : p < 90 ? 4 : p < 97 ? 6 : 8;
+    }
+
+    /**
+     * @brief Join two stations through new intermediate stations of a new line
+     */
+    void addTrunk(int from, int to, int intermediate) {
+        int line = _numLines++;
+        bool alfa = chance(0.35);
+        int capacity = trunkCapacity();
+        int previous = from;
+        for (int i = 0; i < intermediate; i++) {
+            int district = i < intermediate / 2 ? _stations[from].district : _stations[to].district;
+            int station = addStation(district, line);
+            _links.push_back({previous, station, capacity, alfa});
+            previous = station;
+        }
+        _links.push_back({previous, to, capacity, alfa});
+    }
+
+public:
+    /**
+     * @brief Build a network
+     *
+     * @details Time Complexity: O(n)
+     *
+     * @param numStations Number of stations (at least 1)
+     * @param seed Seed of the random generator
+     */
+    NetworkGenerator(int numStations, uint64_t seed): _rng(seed) {
+        numStations = std::max(1, numStations);
+        int side = std::max(1, (int) std::lround(std::sqrt(0.8 * std::sqrt((double) numStations))));
+        int num_districts = std::min(numStations, side * side);
+        side = std::max(1, (int) std::ceil(std::sqrt((double) num_districts)));
+        _municipalitiesPerDistrict = std::max(1, numStations / (num_districts * 3));
+        _districtStations.resize(num_districts);
+        _stations.reserve(numStations);
+
+        std::vector<int> hubs;
+        for (int d = 0; d < num_districts; d++) {
+            hubs.push_back(addStation(d, _numLines++));
+        }
+
+        // About a fifth of the stations are on trunk lines between neighbouring districts
+        int num_trunks = 0;
+        for (int d = 0; d < num_districts; d++) {
+            num_trunks += (d % side + 1 < side && d + 1 < num_districts) + (d + side < num_districts);
+        }
+        int trunk_budget = std::max(0, numStations / 5 - num_districts);
+        int intermediate = num_trunks ? trunk_budget / num_trunks : 0;
+        for (int d = 0; d < num_districts && (int) _stations.size() < numStations; d++) {
+            if (d % side + 1 < side && d + 1 < num_districts) {
+                addTrunk(hubs[d], hubs[d + 1], std::min(intermediate, numStations - (int) _stations.size()));
+            }
+            if (d + side < num_districts && (int) _stations.size() < numStations) {
+                addTrunk(hubs[d], hubs[d + side], std::min(intermediate, numStations - (int) _stations.size()));
+            }
+        }
+
+        // Branch lines until every station exists
+        std::geometric_distribution<int> branch_length(1.0 / 8);
+        while ((int) _stations.size() < numStations) {
+            int district = random(0, num_districts - 1);
+            const std::vector<int>& candidates = _districtStations[district];
+            int junction = candidates[random(0, (int) candidates.size() - 1)];
+            int line = _numLines++;
+            int capacity = branchCapacity();
+
+            int length = std::min(1 + branch_length(_rng), numStations - (int) _stations.size());
+            int previous = junction;
+            for (int i = 0; i < length; i++) {
+                int station = addStation(district, line);
+                _links.push_back({previous, station, capacity, false});
+                previous = station;
+            }
+
+            // Some branches end at another station of the district
+            if (chance(0.2) && candidates.size() > 2) {
+                int end = candidates[random(0, (int) candidates.size() - 1)];
+                if (end != previous && end != junction) {
+                    _links.push_back({previous, end, capacity, false});
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Get the name of a station
+     */
+    static std::string stationName(int station) {
+        return "Station " + std::to_string(station);
+    }
+
+    int getNumStations() const {
+        return (int) _stations.size();
+    }
+
+    int getNumLinks() const {
+        return (int) _links.size();
+    }
+
+    /**
+     * @brief Write the stations in the schema of data/stations.csv
+     */
+    void writeStations(std::ostream& out) const {
+        out << "Name,District,Municipality,Township,Line\n";
+        for (size_t i = 0; i < _stations.size(); i++) {
+            const Station& s = _stations[i];
+            std::string district = "DISTRICT " + std::to_string(s.district);
+            out << stationName((int) i) << ','
+                << district << ','
+                << district << " MUNICIPALITY " << s.municipality << ','
+                << "Township " << i << ','
+                << "Line " << s.line << '\n';
+        }
+    }
+
+    /**
+     * @brief Write the links in the schema of data/network.csv
+     */
+    void writeNetwork(std::ostream& out) const {
+        out << "Station_A,Station_B,Capacity,Service\n";
+        for (const Link& link: _links) {
+            out << stationName(link.a) << ',' << stationName(link.b) << ',' << link.capacity << ','
+                << (link.alfa ? "ALFA PENDULAR" : "STANDARD") << '\n';
+        }
+    }
+};
+
+#endif // FEUP_DA1_NETWORKGENERATOR_H
@@ -0,0 +1,283 @@
+#include "NetworkGenerator.h"
+
+#include "BitsetBFS.h"
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "GraphKernels.h"
+#include "GraphStorage.h"
+#include "MaxFlowSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Compares the two searches of BitsetBFS, direction optimizing and a plain queue, over the same flow network, on
+ * data/network.csv, on generated networks (see NetworkGenerator.h) and on a dense random network:
+ * - pairs: from a station until another station is reached;
+ * - reach: every station reachable from a station (no target, like the cut side of a max flow);
+ * - regions: from every station of a district until a station of another district is reached (many sources, the
+ *   first levels are large);
+ * - max flow: MaxFlowSolver, which finds its augmenting paths with BitsetBFS::search, against kernels::edmondsKarp
+ *   on the CSR storage.
+ * Each time is the fastest of a few runs. The checksums (length of the paths found, or stations reached) must match
+ * between the two searches.
+ *
+ * Usage: bench_bfs [--seed S] [--queries N] [--sizes N,N,...] [stations.csv network.csv]
+ */
+
+namespace {
+    /**
+     * @brief Runs of each search, the fastest is kept to reduce the noise
+     */
+    const int REPEATS = 5;
+
+    /**
+     * @brief Stations of the dense network, and its arcs per station
+     */
+    const int DENSE_STATIONS = 5000;
+    const int DENSE_ARCS = 16;
+
+    double millis(const std::function<void()>& f) {
+        double best = 0;
+        for (int i = 0; i < REPEATS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    void row(const std::string& dataset, const std::string& search, double ms, long long checksum) {
+        std::cout << std::left << std::setw(16) << dataset << std::setw(32) << search
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << ms
+                  << std::setw(16) << checksum << '\n';
+    }
+
+    struct Query {
+        std::vector<int> sources;
+        std::vector<int> targets;
+    };
+
+    /**
+     * @brief Arcs from the sources to the target reached, every search must find a path with the fewest arcs
+     */
+    long long pathLength(const FlowNetwork& network, const BitsetBFS& bfs, int target) {
+        long long length = 0;
+        for (int v = target; v != -1 && bfs.getParent(v) != -2; v = network.getHead(network.getTwin(bfs.getParent(v)))) {
+            length++;
+        }
+        return length;
+    }
+
+    void compareSearches(const std::string& dataset, const FlowNetwork& network, const std::string& name,
+                         const std::vector<Query>& queries) {
+        BitsetBFS bfs(network);
+        auto usable = [&network](int a) {
+            return network.getCapacity(a) > 0;
+        };
+
+        // With no target the checksum is the number of stations visited
+        auto checksum = [&](int target) {
+            if (target != -1) {
+                return pathLength(network, bfs, target);
+            }
+            long long visited = 0;
+            for (int v = 0; v < network.getNumVertex(); v++) {
+                visited += bfs.isVisited(v);
+            }
+            return visited;
+        };
+
+        long long sum = 0;
+        double ms = millis([&]() {
+            sum = 0;
+            for (const auto &query: queries) {
+                bfs.setTargets(query.targets);
+                sum += checksum(bfs.searchDirectionOptimizing(query.sources, usable));
+            }
+        });
+        row(dataset, name + ", direction optimizing", ms, sum);
+
+        ms = millis([&]() {
+            sum = 0;
+            for (const auto &query: queries) {
+                bfs.setTargets(query.targets);
+                sum += checksum(bfs.searchTopDown(query.sources, usable));
+            }
+        });
+        row(dataset, name + ", queue", ms, sum);
+    }
+
+    void run(const std::string& dataset, const Graph& g, int numQueries, std::mt19937_64& rng) {
+        FlowNetwork network(g);
+        int n = network.getNumVertex();
+        std::cout << dataset << ": " << n << " stations, " << network.getNumArcs() << " arcs, search() is "
+                  << (BitsetBFS(network).isDirectionOptimizing() ? "direction optimizing" : "a queue") << '\n';
+        std::uniform_int_distribution<int> vertex(0, n - 1);
+
+        std::vector<Query> pairs;
+        while ((int) pairs.size() < numQueries && n > 1) {
+            int s = vertex(rng), t = vertex(rng);
+            if (s != t) {
+                pairs.push_back({{s}, {t}});
+            }
+        }
+        compareSearches(dataset, network, "pairs", pairs);
+
+        std::vector<Query> reach;
+        for (int i = 0; i < numQueries / 10 && n > 0; i++) {
+            reach.push_back({{vertex(rng)}, {}});
+        }
+        compareSearches(dataset, network, "reach", reach);
+
+        std::map<std::string, std::vector<int>> districts;
+        auto vertexes = g.getVertexSet();
+        for (int v = 0; v < n; v++) {
+            districts[vertexes[v]->getStation().getDistrict()].push_back(v);
+        }
+        std::vector<const std::vector<int>*> stations;
+        for (const auto &district: districts) {
+            stations.push_back(&district.second);
+        }
+        std::uniform_int_distribution<int> district(0, (int) stations.size() - 1);
+        std::vector<Query> regions;
+        while ((int) regions.size() < numQueries && stations.size() > 1) {
+            int a = district(rng), b = district(rng);
+            if (a != b) {
+                regions.push_back({*stations[a], *stations[b]});
+            }
+        }
+        compareSearches(dataset, network, "regions", regions);
+
+        long long checksum = 0;
+        MaxFlowSolver solver(network);
+        double ms = millis([&]() {
+            checksum = 0;
+            for (const auto &pair: pairs) {
+                checksum += std::max(0, solver.maxFlow(pair.sources[0], pair.targets[0]));
+            }
+        });
+        row(dataset, "max flow, MaxFlowSolver", ms, checksum);
+
+        CsrStorage<int> csr(network);
+        ms = millis([&]() {
+            checksum = 0;
+            for (const auto &pair: pairs) {
+                checksum += kernels::edmondsKarp<TrainCapacity>(csr, pair.sources[0], pair.targets[0]);
+            }
+        });
+        row(dataset, "max flow, kernels CSR", ms, checksum);
+    }
+
+    /**
+     * @brief Random network with many more links per station than a rail network, where bottom-up levels pay off
+     */
+    Graph denseNetwork(int numStations, int arcsPerStation, std::mt19937_64& rng) {
+        const int NUM_DISTRICTS = 50;
+        Graph g;
+        for (int i = 0; i < numStations; i++) {
+            std::string district = "DISTRICT " + std::to_string(i % NUM_DISTRICTS);
+            g.addVertex(Station(NetworkGenerator::stationName(i), district, district + " MUNICIPALITY",
+                                "Township " + std::to_string(i), "Line"));
+        }
+
+        // Each bidirectional link is an arc from each end
+        std::uniform_int_distribution<int> station(0, numStations - 1);
+        for (long long i = 0; i < (long long) numStations * arcsPerStation / 2; i++) {
+            int a = station(rng), b = station(rng);
+            if (a != b) {
+                g.addBidirectionalEdge(NetworkGenerator::stationName(a), NetworkGenerator::stationName(b), 2, "STANDARD");
+            }
+        }
+        return g;
+    }
+
+    bool parseSizes(const std::string& list, std::vector<int>& sizes) {
+        sizes.clear();
+        std::stringstream ss(list);
+        std::string size;
+        while (getline(ss, size, ',')) {
+            try {
+                sizes.push_back(std::stoi(size));
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t seed = 1;
+    int num_queries = 2000;
+    std::vector<int> sizes = {2000, 10000};
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--queries") == 0 && has_value) {
+            num_queries = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--sizes") == 0 && has_value && parseSizes(argv[i + 1], sizes)) {
+            i++;
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if (files.size() != 0 && files.size() != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--seed S] [--queries N] [--sizes N,N,...] [stations.csv network.csv]\n";
+        return 1;
+    }
+    std::string stations = files.size() == 2 ? files[0] : "../data/stations.csv";
+    std::string network_file = files.size() == 2 ? files[1] : "../data/network.csv";
+
+    std::cout << std::left << std::setw(16) << "network" << std::setw(32) << "search"
+              << std::right << std::setw(12) << "ms" << std::setw(16) << "checksum" << '\n';
+
+    std::mt19937_64 rng(seed);
+    Graph data;
+    if (!data.readData(stations, network_file)) {
+        std::cerr << "Could not read " << stations << " and " << network_file << '\n';
+        return 1;
+    }
+    run("data", data, num_queries, rng);
+
+    namespace fs = std::filesystem;
+    for (int size: sizes) {
+        fs::path stations_file = fs::temp_directory_path() / ("feup_da1_bfs_" + std::to_string(size) + "_stations.csv");
+        fs::path network_path = fs::temp_directory_path() / ("feup_da1_bfs_" + std::to_string(size) + "_network.csv");
+        {
+            NetworkGenerator generator(size, seed);
+            std::ofstream stations_out(stations_file);
+            std::ofstream network_out(network_path);
+            generator.writeStations(stations_out);
+            generator.writeNetwork(network_out);
+        }
+
+        Graph g;
+        bool loaded = g.readData(stations_file.string(), network_path.string());
+        fs::remove(stations_file);
+        fs::remove(network_path);
+        if (!loaded) {
+            std::cerr << "Could not read the generated network of " << size << " stations\n";
+            return 1;
+        }
+        run("generated-" + std::to_string(size), g, num_queries, rng);
+    }
+
+    run("dense-" + std::to_string(DENSE_STATIONS), denseNetwork(DENSE_STATIONS, DENSE_ARCS, rng), num_queries, rng);
+
+    return 0;
+}
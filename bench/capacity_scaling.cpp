@@ -0,0 +1,183 @@
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "MaxFlowSolver.h"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Compares plain Edmonds-Karp with the capacity scaling variant on instances with a wide spread of capacities.
+ * The last instance needs 64 bit flows. The spread column is the variant FlowNetwork::prefersCapacityScaling picks
+ * from the capacities, as Graph::maxTrainsArriving does.
+ *
+ * Usage: bench_capacity_scaling [pairs] [stations.csv network.csv]
+ */
+
+namespace {
+    /**
+     * @brief Copy a graph changing the capacity of every link
+     */
+    Graph rescale(const Graph& g, const std::function<int(int)>& capacity) {
+        Graph scaled;
+        for (auto v: g.getVertexSet()) {
+            scaled.addVertex(v->getStation());
+        }
+
+        for (auto v: g.getVertexSet()) {
+            for (auto e: v->getAdj()) {
+                auto r = e->getReverse();
+                if (r != nullptr && std::less<const Edge *>()(r, e)) {
+                    continue; // already added with the reverse edge
+                }
+
+                int c = capacity(e->getWeight());
+                const std::string& a = e->getOrigin()->getStation().getName();
+                const std::string& b = e->getDest()->getStation().getName();
+                if (r != nullptr) {
+                    scaled.addBidirectionalEdge(a, b, c, e->getService());
+                } else {
+                    scaled.addEdge(a, b, c, e->getService());
+                }
+            }
+        }
+
+        return scaled;
+    }
+
+    /**
+     * @brief Square mesh of stations with capacities spread over six orders of magnitude
+     */
+    Graph mesh(int side, std::mt19937& rng) {
+        std::uniform_real_distribution<double> exponent(0, 6);
+        auto name = [side](int i, int j) { return "m" + std::to_string(i * side + j); };
+
+        Graph g;
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                g.addVertex(Station(name(i, j), "", "", "", ""));
+            }
+        }
+
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                if (i + 1 < side) {
+                    g.addBidirectionalEdge(name(i, j), name(i + 1, j), (int) std::pow(10, exponent(rng)), "STANDARD");
+                }
+                if (j + 1 < side) {
+                    g.addBidirectionalEdge(name(i, j), name(i, j + 1), (int) std::pow(10, exponent(rng)), "STANDARD");
+                }
+            }
+        }
+
+        return g;
+    }
+
+    /**
+     * @brief Sources and sink of a query
+     */
+    struct Query {
+        std::vector<int> sources;
+        int sink;
+    };
+
+    /**
+     * @brief Queries of the trains arriving at every station: from the terminal stations that reach it, as if linked
+     * to a super source with unlimited capacity (like Graph::maxTrainsArriving)
+     */
+    template <typename Capacity>
+    std::vector<Query> arrivals(const BasicFlowNetwork<Capacity>& network) {
+        std::vector<Query> queries;
+        for (int t = 0; t < network.getNumVertex(); t++) {
+            queries.push_back({network.arrivalSources(t), t});
+        }
+        return queries;
+    }
+
+    template <typename Capacity>
+    void run(const std::string& name, const Graph& g, std::vector<Query> queries, bool arrivalQueries = false) {
+        BasicFlowNetwork<Capacity> network(g);
+        BasicMaxFlowSolver<Capacity> solver(network);
+        if (arrivalQueries) {
+            queries = arrivals(network);
+        }
+
+        long long augmentations[2] = {0, 0};
+        double seconds[2] = {0, 0};
+        int mismatches = 0;
+
+        for (const auto &query: queries) {
+            Capacity flows[2];
+            for (int scaling = 0; scaling < 2; scaling++) {
+                auto start = std::chrono::steady_clock::now();
+                flows[scaling] = solver.maxFlow(query.sources, {query.sink}, scaling);
+                seconds[scaling] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                augmentations[scaling] += solver.getAugmentations();
+            }
+            mismatches += flows[0] != flows[1];
+        }
+
+        std::cout << std::left << std::setw(34) << name
+                  << std::right << std::setw(14) << augmentations[0] << std::setw(14) << augmentations[1]
+                  << std::setw(12) << std::fixed << std::setprecision(3) << seconds[0] * 1000
+                  << std::setw(12) << seconds[1] * 1000
+                  << std::setw(12) << mismatches
+                  << std::setw(10) << (network.prefersCapacityScaling() ? "scaling" : "plain") << '\n';
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int num_pairs = argc >= 2 ? std::stoi(argv[1]) : 2000;
+    std::string stations = argc >= 4 ? argv[2] : "../data/stations.csv";
+    std::string network = argc >= 4 ? argv[3] : "../data/network.csv";
+
+    Graph g;
+    if (!g.readData(stations, network)) {
+        std::cerr << "Could not read " << stations << " and " << network << '\n';
+        return 1;
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> jitter(0, 999);
+
+    Graph wide = rescale(g, [&rng, &jitter](int c) { return c * 1000 + jitter(rng); });
+
+    std::uniform_int_distribution<int> vertex(0, g.getNumVertex() - 1);
+    std::vector<Query> pairs;
+    while ((int) pairs.size() < num_pairs) {
+        int s = vertex(rng), t = vertex(rng);
+        if (s != t) {
+            pairs.push_back({{s}, t});
+        }
+    }
+
+    std::cout << std::left << std::setw(34) << "instance"
+              << std::right << std::setw(14) << "augm plain" << std::setw(14) << "augm scaling"
+              << std::setw(12) << "ms plain" << std::setw(12) << "ms scaling" << std::setw(12) << "mismatches"
+              << std::setw(10) << "spread" << '\n';
+
+    run<int>("network (random pairs)", g, pairs);
+    run<int>("capacities x1000 (random pairs)", wide, pairs);
+    run<int>("arrivals", g, {}, true);
+    run<int>("capacities x1000, arrivals", wide, {}, true);
+
+    const int side = 40;
+    Graph grid = mesh(side, rng);
+    std::vector<Query> corners;
+    std::uniform_int_distribution<int> border(0, side - 1);
+    for (int i = 0; i < 50; i++) {
+        corners.push_back({{border(rng)}, (side - 1) * side + border(rng)}); // first row to last row
+    }
+    run<int>("40x40 mesh, capacities 1..1e6", grid, corners);
+
+    // Flows between the rows of this mesh do not fit in an int
+    Graph wide_grid = rescale(grid, [](int c) { return c * 1000; });
+    run<long long>("40x40 mesh, capacities 1e3..1e9", wide_grid, corners);
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include "NetworkGenerator.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/**
+ * Writes a synthetic rail network (see NetworkGenerator.h) in the schema of the files in data/.
+ *
+ * Usage: generate_network <stations> <stations.csv> <network.csv> [seed]
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 4 && argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <stations> <stations.csv> <network.csv> [seed]\n";
+        return 2;
+    }
+
+    int num_stations = std::stoi(argv[1]);
+    uint64_t seed = argc == 5 ? std::stoull(argv[4]) : 1;
+
+    std::ofstream stations(argv[2]);
+    std::ofstream network(argv[3]);
+    if (!stations.is_open() || !network.is_open()) {
+        std::cerr << "Could not write " << argv[2] << " and " << argv[3] << '\n';
+        return 1;
+    }
+
+    NetworkGenerator generator(num_stations, seed);
+    generator.writeStations(stations);
+    generator.writeNetwork(network);
+
+    std::cout << generator.getNumStations() << " stations, " << generator.getNumLinks() << " links\n";
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "CostPolicy.h"
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "GraphKernels.h"
+#include "GraphStorage.h"
+#include "MaxFlowSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Compares the graph kernels instantiated for each storage: the adjacency lists of Graph, the flow network (CSR)
+ * and an overlay over it. Dijkstra is also compared with the previous Graph::dijkstra, which compared the service
+ * names in every relaxation. Each time is the fastest of a few runs.
+ *
+ * Usage: bench_kernels [pairs] [stations.csv network.csv]
+ */
+
+namespace {
+    /**
+     * @brief Dijkstra as Graph::dijkstra was before the kernels, the cost is taken from the service name
+     */
+    void stringCostDijkstra(Vertex *source, unsigned int epoch) {
+        auto cmp = [epoch](Vertex *a, Vertex *b) {
+            return a->getDistance(epoch) > b->getDistance(epoch);
+        };
+        std::priority_queue<Vertex *, std::vector<Vertex *>, decltype(cmp)> pq(cmp);
+
+        source->setDistance(0, epoch);
+        pq.push(source);
+        while (!pq.empty()) {
+            Vertex * u = pq.top(); pq.pop();
+            u->setVisited(epoch);
+
+            for (auto e : u->getAdj()) {
+                Vertex* v = e->getDest();
+                int w = e->getService() == "STANDARD" ? 2 : 4;
+                int u_distance = u->getDistance(epoch);
+                if (!v->isVisited(epoch) && u_distance != std::numeric_limits<int>::max() && (u_distance + w < v->getDistance(epoch))) {
+                    v->setDistance(u_distance + w, epoch);
+                    v->setPath(e);
+                    pq.push(v);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Runs of each kernel, the fastest is kept to reduce the noise
+     */
+    const int REPEATS = 5;
+
+    double millis(const std::function<void()>& f) {
+        double best = 0;
+        for (int i = 0; i < REPEATS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    void row(const std::string& name, double ms, long long checksum) {
+        std::cout << std::left << std::setw(40) << name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << ms
+                  << std::setw(16) << checksum << '\n';
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int num_pairs = argc >= 2 ? std::stoi(argv[1]) : 500;
+    std::string stations = argc >= 4 ? argv[2] : "../data/stations.csv";
+    std::string network_file = argc >= 4 ? argv[3] : "../data/network.csv";
+
+    Graph g;
+    if (!g.readData(stations, network_file)) {
+        std::cerr << "Could not read " << stations << " and " << network_file << '\n';
+        return 1;
+    }
+
+    FlowNetwork network(g);
+    CsrStorage<int> csr(network);
+    OverlayStorage<int> overlay(network);
+    AdjacencyStorage adjacency(g);
+    std::vector<Vertex *> vertexes = g.getVertexSet();
+    int n = network.getNumVertex();
+
+    std::cout << std::left << std::setw(40) << "kernel"
+              << std::right << std::setw(12) << "ms" << std::setw(16) << "checksum" << '\n';
+
+    // Dijkstra from every station, the checksum is the sum of the distances to the reachable stations
+    Graph reference = g;
+    std::vector<Vertex *> reference_vertexes = reference.getVertexSet();
+    long long checksum = 0;
+    unsigned int epoch = 1u << 31; // far from the epochs used by the graph
+    double ms = millis([&]() {
+        checksum = 0;
+        for (auto v: reference_vertexes) {
+            stringCostDijkstra(v, ++epoch);
+            for (auto w: reference_vertexes) {
+                checksum += w->getDistance(epoch) != std::numeric_limits<int>::max() ? w->getDistance(epoch) : 0;
+            }
+        }
+    });
+    row("dijkstra, service names (before)", ms, checksum);
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (auto v: vertexes) {
+            kernels::dijkstra<ServiceCost>(adjacency, v);
+            for (auto w: vertexes) {
+                checksum += adjacency.getDistance(w) != std::numeric_limits<int>::max() ? adjacency.getDistance(w) : 0;
+            }
+        }
+    });
+    row("dijkstra<ServiceCost>, adjacency", ms, checksum);
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (int v = 0; v < n; v++) {
+            kernels::dijkstra<ServiceCost>(csr, v);
+            for (int w = 0; w < n; w++) {
+                checksum += csr.getDistance(w) != std::numeric_limits<int>::max() ? csr.getDistance(w) : 0;
+            }
+        }
+    });
+    row("dijkstra<ServiceCost>, CSR", ms, checksum);
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (int v = 0; v < n; v++) {
+            kernels::dijkstra<ServiceCost>(overlay, v);
+            for (int w = 0; w < n; w++) {
+                checksum += overlay.getDistance(w) != std::numeric_limits<int>::max() ? overlay.getDistance(w) : 0;
+            }
+        }
+    });
+    row("dijkstra<ServiceCost>, overlay", ms, checksum);
+
+    // Max flow between random pairs, the checksum is the sum of the flows
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> vertex(0, n - 1);
+    std::vector<std::pair<int, int>> pairs;
+    while ((int) pairs.size() < num_pairs) {
+        int s = vertex(rng), t = vertex(rng);
+        if (s != t) {
+            pairs.emplace_back(s, t);
+        }
+    }
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (const auto &pair: pairs) {
+            checksum += kernels::edmondsKarp<TrainCapacity>(adjacency, vertexes[pair.first], vertexes[pair.second]);
+        }
+    });
+    row("edmondsKarp<TrainCapacity>, adjacency", ms, checksum);
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (const auto &pair: pairs) {
+            checksum += kernels::edmondsKarp<TrainCapacity>(csr, pair.first, pair.second);
+        }
+    });
+    row("edmondsKarp<TrainCapacity>, CSR", ms, checksum);
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (const auto &pair: pairs) {
+            checksum += kernels::edmondsKarp<TrainCapacity>(overlay, pair.first, pair.second);
+        }
+    });
+    row("edmondsKarp<TrainCapacity>, overlay", ms, checksum);
+
+    MaxFlowSolver solver(network);
+    ms = millis([&]() {
+        checksum = 0;
+        for (const auto &pair: pairs) {
+            int flow = solver.maxFlow(pair.first, pair.second);
+            checksum += flow == -1 ? 0 : flow;
+        }
+    });
+    row("MaxFlowSolver (BitsetBFS), CSR", ms, checksum);
+
+    ms = millis([&]() {
+        checksum = 0;
+        for (const auto &pair: pairs) {
+            checksum += kernels::edmondsKarp<UnitCapacity>(csr, pair.first, pair.second);
+        }
+    });
+    row("edmondsKarp<UnitCapacity>, CSR", ms, checksum);
+
+    return 0;
+}
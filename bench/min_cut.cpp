@@ -0,0 +1,281 @@
+#include "NetworkGenerator.h"
+
+#include "FlowNetwork.h"
+#include "GlobalMinCut.h"
+#include "GomoryHuTree.h"
+#include "Graph.h"
+#include "IndexedHeap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <vector>
+
+/**
+ * Compares the ways of finding the global minimum cut on synthetic networks (see NetworkGenerator.h) of growing
+ * size: GlobalMinCut (Stoer-Wagner), the same algorithm with other heaps (binary and 8-ary IndexedHeap, and a
+ * std::priority_queue with lazy deletion, where an increased key is queued again), the lightest edge of the
+ * Gomory-Hu tree (a max flow per station) and the minimum of the max flow of every pair of stations. Every way
+ * must give the same value, it is printed as the checksum.
+ *
+ * Usage: bench_min_cut [--seed S] [--tree-limit N] [--all-pairs-limit N] [sizes...]
+ */
+
+namespace {
+    using Adjacency = std::vector<std::vector<std::pair<int, long long>>>;
+
+    /**
+     * @brief Max heap with the interface of IndexedHeap over a std::priority_queue, an increased key is queued
+     * again and the old entry is skipped when popped
+     */
+    class LazyHeap {
+    private:
+        std::priority_queue<std::pair<long long, int>> _queue;
+        std::vector<long long> _key;
+        std::vector<bool> _inHeap;
+        int _size = 0;
+
+    public:
+        explicit LazyHeap(int numItems): _key(numItems, 0), _inHeap(numItems, false) {}
+
+        bool empty() const {
+            return _size == 0;
+        }
+
+        bool contains(int item) const {
+            return _inHeap[item];
+        }
+
+        const long long& getKey(int item) const {
+            return _key[item];
+        }
+
+        void push(int item, long long key) {
+            _key[item] = key;
+            _inHeap[item] = true;
+            _size++;
+            _queue.emplace(key, item);
+        }
+
+        void increaseKey(int item, long long key) {
+            if (_key[item] < key) {
+                _key[item] = key;
+                _queue.emplace(key, item);
+            }
+        }
+
+        int pop() {
+            while (!_inHeap[_queue.top().second] || _queue.top().first != _key[_queue.top().second]) {
+                _queue.pop();
+            }
+            int item = _queue.top().second;
+            _queue.pop();
+            _inHeap[item] = false;
+            _size--;
+            return item;
+        }
+    };
+
+    /**
+     * @brief Undirected view of the network like GlobalMinCut: a link weighs its largest capacity
+     */
+    Adjacency undirected(const FlowNetwork& network) {
+        Adjacency adj(network.getNumVertex());
+        for (int v = 0; v < network.getNumVertex(); v++) {
+            for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+                int twin = network.getTwin(a);
+                long long weight = std::max(network.getCapacity(a), network.getCapacity(twin));
+                if (a < twin && weight > 0) {
+                    adj[v].emplace_back(network.getHead(a), weight);
+                    adj[network.getHead(a)].emplace_back(v, weight);
+                }
+            }
+        }
+        return adj;
+    }
+
+    /**
+     * @brief Value of the minimum cut by Stoer-Wagner with a given heap (0 if the network is split)
+     */
+    template <typename Heap>
+    long long stoerWagner(Adjacency adj) {
+        int n = (int) adj.size();
+        std::vector<int> merged_into(n);
+        std::iota(merged_into.begin(), merged_into.end(), 0);
+        auto find = [&merged_into](int v) {
+            while (merged_into[v] != v) {
+                merged_into[v] = merged_into[merged_into[v]];
+                v = merged_into[v];
+            }
+            return v;
+        };
+
+        std::vector<int> active(n);
+        std::iota(active.begin(), active.end(), 0);
+        long long best = std::numeric_limits<long long>::max();
+        while (active.size() > 1) {
+            Heap heap(n);
+            for (int v: active) {
+                heap.push(v, 0);
+            }
+            int s = -1, t = -1;
+            long long cut_of_phase = 0;
+            while (!heap.empty()) {
+                int u = heap.pop();
+                cut_of_phase = heap.getKey(u);
+                s = t;
+                t = u;
+                for (const auto &link: adj[u]) {
+                    int w = find(link.first);
+                    if (heap.contains(w)) {
+                        heap.increaseKey(w, heap.getKey(w) + link.second);
+                    }
+                }
+            }
+            best = std::min(best, cut_of_phase);
+
+            merged_into[t] = s;
+            adj[s].insert(adj[s].end(), adj[t].begin(), adj[t].end());
+            Adjacency::value_type().swap(adj[t]);
+            adj[s].erase(std::remove_if(adj[s].begin(), adj[s].end(), [&find, s](const std::pair<int, long long>& link) {
+                return find(link.first) == s;
+            }), adj[s].end());
+            active.erase(std::find(active.begin(), active.end(), t));
+        }
+        return best;
+    }
+
+    double millis(const std::function<void()>& f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void row(int size, const std::string& operation, double ms, long long checksum) {
+        std::cout << std::right << std::setw(10) << size << "  "
+                  << std::left << std::setw(40) << operation
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(3) << ms
+                  << std::setw(16) << checksum << '\n';
+    }
+
+    void skipped(int size, const std::string& operation) {
+        std::cout << std::right << std::setw(10) << size << "  "
+                  << std::left << std::setw(40) << operation
+                  << std::right << std::setw(14) << "-" << "  skipped (size limit)\n";
+    }
+
+    void run(int size, uint64_t seed, int treeLimit, int allPairsLimit) {
+        namespace fs = std::filesystem;
+        fs::path stations_file = fs::temp_directory_path() / ("feup_da1_cut_" + std::to_string(size) + "_stations.csv");
+        fs::path network_file = fs::temp_directory_path() / ("feup_da1_cut_" + std::to_string(size) + "_network.csv");
+        {
+            NetworkGenerator generator(size, seed);
+            std::ofstream stations(stations_file);
+            std::ofstream network(network_file);
+            generator.writeStations(stations);
+            generator.writeNetwork(network);
+        }
+
+        Graph g;
+        bool loaded = g.readData(stations_file.string(), network_file.string());
+        fs::remove(stations_file);
+        fs::remove(network_file);
+        if (!loaded) {
+            std::cerr << "Could not read the generated network of " << size << " stations\n";
+            return;
+        }
+
+        long long value = 0;
+        double ms = millis([&]() {
+            value = GlobalMinCut(g).minCut().value;
+        });
+        row(size, "GlobalMinCut::minCut", ms, value);
+
+        FlowNetwork network(g);
+        Adjacency adj = undirected(network);
+        ms = millis([&]() {
+            value = stoerWagner<IndexedHeap<long long, 2>>(adj);
+        });
+        row(size, "Stoer-Wagner, binary IndexedHeap", ms, value);
+        ms = millis([&]() {
+            value = stoerWagner<IndexedHeap<long long, 4>>(adj);
+        });
+        row(size, "Stoer-Wagner, 4-ary IndexedHeap", ms, value);
+        ms = millis([&]() {
+            value = stoerWagner<IndexedHeap<long long, 8>>(adj);
+        });
+        row(size, "Stoer-Wagner, 8-ary IndexedHeap", ms, value);
+        ms = millis([&]() {
+            value = stoerWagner<LazyHeap>(adj);
+        });
+        row(size, "Stoer-Wagner, lazy priority_queue", ms, value);
+
+        if (size <= treeLimit) {
+            ms = millis([&]() {
+                GomoryHuTree tree(network);
+                value = std::numeric_limits<long long>::max();
+                for (int v = 1; v < network.getNumVertex(); v++) {
+                    value = std::min(value, tree.getWeight(v));
+                }
+            });
+            row(size, "lightest Gomory-Hu tree edge", ms, value);
+        } else {
+            skipped(size, "lightest Gomory-Hu tree edge");
+        }
+
+        if (size <= allPairsLimit) {
+            ms = millis([&]() {
+                std::vector<std::pair<int, int>> pairs;
+                for (int s = 0; s < network.getNumVertex(); s++) {
+                    for (int t = s + 1; t < network.getNumVertex(); t++) {
+                        pairs.emplace_back(s, t);
+                    }
+                }
+                value = std::numeric_limits<long long>::max();
+                for (int flow: network.maxFlowBatch(pairs)) {
+                    value = std::min(value, (long long) std::max(0, flow));
+                }
+            });
+            row(size, "minimum of all pairs max flows", ms, value);
+        } else {
+            skipped(size, "minimum of all pairs max flows");
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t seed = 1;
+    int tree_limit = 2000;
+    int all_pairs_limit = 200;
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tree-limit") == 0 && i + 1 < argc) {
+            tree_limit = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--all-pairs-limit") == 0 && i + 1 < argc) {
+            all_pairs_limit = std::stoi(argv[++i]);
+        } else {
+            sizes.push_back(std::stoi(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {100, 500, 2000, 5000};
+    }
+
+    std::cout << std::right << std::setw(10) << "stations" << "  " << std::left << std::setw(40) << "operation"
+              << std::right << std::setw(14) << "ms" << std::setw(16) << "cut" << '\n';
+    for (int size: sizes) {
+        run(size, seed, tree_limit, all_pairs_limit);
+    }
+    return 0;
+}
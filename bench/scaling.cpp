@@ -0,0 +1,275 @@
+#include "NetworkGenerator.h"
+
+#include "FailureSimulation.h"
+#include "FlowNetwork.h"
+#include "GlobalMinCut.h"
+#include "GomoryHuTree.h"
+#include "Graph.h"
+#include "KShortestPaths.h"
+#include "MaxFlowSolver.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Times loading, single pair flow, all pairs flow, global min cut, cost queries and scenario analysis on
+ * synthetic networks (see NetworkGenerator.h) of growing size. Networks are written to the temporary directory and
+ * loaded with Graph::readData like the real data. The all pairs analyses grow quadratically and only run up to a
+ * size limit.
+ *
+ * Usage: bench_scaling [--seed S] [--all-pairs-limit N] [--tree-limit N] [sizes...]
+ */
+
+namespace {
+    /**
+     * @brief Random pairs of distinct stations and random stations used by the queries
+     */
+    const int NUM_QUERIES = 20;
+
+    /**
+     * @brief Stations out of service in the scenario analysis
+     */
+    const int NUM_REMOVED = 10;
+
+    /**
+     * @brief Scenarios of the random failures simulation, each link failing with FAILURE_PROBABILITY
+     */
+    const int NUM_SCENARIOS = 1000;
+    const double FAILURE_PROBABILITY = 0.01;
+
+    double millis(const std::function<void()>& f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void row(int size, const std::string& operation, double ms, const std::string& note = "") {
+        std::cout << std::right << std::setw(10) << size << "  "
+                  << std::left << std::setw(40) << operation
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(3) << ms
+                  << "  " << note << '\n';
+    }
+
+    void skipped(int size, const std::string& operation) {
+        std::cout << std::right << std::setw(10) << size << "  "
+                  << std::left << std::setw(40) << operation
+                  << std::right << std::setw(14) << "-" << "  skipped (size limit)\n";
+    }
+
+    void run(int size, uint64_t seed, int allPairsLimit, int treeLimit) {
+        namespace fs = std::filesystem;
+        fs::path stations_file = fs::temp_directory_path() / ("feup_da1_" + std::to_string(size) + "_stations.csv");
+        fs::path network_file = fs::temp_directory_path() / ("feup_da1_" + std::to_string(size) + "_network.csv");
+
+        int num_links = 0;
+        double ms = millis([&]() {
+            NetworkGenerator generator(size, seed);
+            std::ofstream stations(stations_file);
+            std::ofstream network(network_file);
+            generator.writeStations(stations);
+            generator.writeNetwork(network);
+            num_links = generator.getNumLinks();
+        });
+        row(size, "generate", ms, std::to_string(num_links) + " links");
+
+        Graph g;
+        ms = millis([&]() {
+            g.readData(stations_file.string(), network_file.string());
+        });
+        row(size, "load (readData)", ms);
+
+        std::mt19937_64 rng(seed);
+        std::vector<Vertex *> vertexes = g.getVertexSet();
+        std::uniform_int_distribution<int> vertex(0, (int) vertexes.size() - 1);
+        std::vector<std::pair<int, int>> pairs;
+        while (size > 1 && (int) pairs.size() < NUM_QUERIES) {
+            int s = vertex(rng), t = vertex(rng);
+            if (s != t) {
+                pairs.emplace_back(s, t);
+            }
+        }
+
+        long long checksum = 0;
+        ms = millis([&]() {
+            for (const auto &pair: pairs) {
+                checksum += g.edmondsKarp(vertexes[pair.first]->getStation().getName(),
+                                          vertexes[pair.second]->getStation().getName());
+            }
+        });
+        row(size, "single pair, Graph::edmondsKarp (avg)", ms / std::max<size_t>(1, pairs.size()),
+            "checksum " + std::to_string(checksum));
+
+        std::unique_ptr<FlowNetwork> network;
+        ms = millis([&]() {
+            network = std::make_unique<FlowNetwork>(g);
+        });
+        row(size, "build flow network", ms);
+
+        checksum = 0;
+        MaxFlowSolver solver(*network);
+        ms = millis([&]() {
+            for (const auto &pair: pairs) {
+                checksum += solver.maxFlow(network->findIndex(vertexes[pair.first]->getStation().getName()),
+                                           network->findIndex(vertexes[pair.second]->getStation().getName()));
+            }
+        });
+        row(size, "single pair, MaxFlowSolver (avg)", ms / std::max<size_t>(1, pairs.size()),
+            "checksum " + std::to_string(checksum));
+
+        checksum = 0;
+        ms = millis([&]() {
+            for (const auto &pair: pairs) {
+                g.dijkstra(vertexes[pair.first]);
+                int distance = g.getDistance(vertexes[pair.second]);
+                checksum += distance != std::numeric_limits<int>::max() ? distance : 0;
+            }
+        });
+        row(size, "cost, Graph::dijkstra (avg)", ms / std::max<size_t>(1, pairs.size()),
+            "checksum " + std::to_string(checksum));
+
+        if (size <= allPairsLimit) {
+            size_t num_pairs = 0;
+            ms = millis([&]() {
+                num_pairs = g.getMaxTrainCapacityPairs().size();
+            });
+            row(size, "all pairs, getMaxTrainCapacityPairs", ms, std::to_string(num_pairs) + " pairs with the max");
+        } else {
+            skipped(size, "all pairs, getMaxTrainCapacityPairs");
+        }
+
+        if (size <= treeLimit) {
+            long long total = 0;
+            ms = millis([&]() {
+                GomoryHuTree tree(*network);
+                for (long long sum: tree.sumOfMaxFlows()) {
+                    total += sum;
+                }
+            });
+            row(size, "all pairs, Gomory-Hu tree", ms, "checksum " + std::to_string(total));
+        } else {
+            skipped(size, "all pairs, Gomory-Hu tree");
+        }
+
+        checksum = 0;
+        ms = millis([&]() {
+            KShortestPaths k_paths(g);
+            for (const auto &pair: pairs) {
+                for (const auto &path: k_paths.find(vertexes[pair.first]->getStation().getName(),
+                                                    vertexes[pair.second]->getStation().getName(), 10)) {
+                    checksum += path.cost;
+                }
+            }
+        });
+        row(size, "k shortest paths, k=10 (avg)", ms / std::max<size_t>(1, pairs.size()),
+            "checksum " + std::to_string(checksum));
+
+        long long cut = 0;
+        ms = millis([&]() {
+            cut = GlobalMinCut(g).minCut().value;
+        });
+        row(size, "global min cut, Stoer-Wagner", ms, "value " + std::to_string(cut));
+
+        // Scenario analysis: take some stations out of service and compare the arrivals at others
+        checksum = 0;
+        std::mt19937_64 scenario_rng = rng; // the same stations for the copy and the rollback
+        ms = millis([&]() {
+            Graph scenario = g;
+            for (int i = 0; i < NUM_REMOVED; i++) {
+                scenario.removeVertex(vertexes[vertex(rng)]->getStation().getName());
+            }
+
+            for (const auto &pair: pairs) {
+                const std::string& name = vertexes[pair.second]->getStation().getName();
+                int original_max = std::max(0, g.maxTrainsArriving(name));
+                int new_max = std::max(0, scenario.maxTrainsArriving(name));
+                checksum += original_max - new_max;
+            }
+        });
+        row(size, "scenario, copy + 10 removed + arrivals", ms, "checksum " + std::to_string(checksum));
+
+        // The same scenario on the graph itself, undone after
+        checksum = 0;
+        ms = millis([&]() {
+            std::vector<int> original_max;
+            for (const auto &pair: pairs) {
+                original_max.push_back(std::max(0, g.maxTrainsArriving(vertexes[pair.second]->getStation().getName())));
+            }
+
+            std::vector<std::string> removed;
+            for (int i = 0; i < NUM_REMOVED; i++) {
+                removed.push_back(vertexes[vertex(scenario_rng)]->getStation().getName());
+            }
+            size_t checkpoint = g.checkpoint();
+            for (const std::string& name: removed) {
+                g.removeVertex(name);
+            }
+
+            for (size_t i = 0; i < pairs.size(); i++) {
+                const std::string& name = vertexes[pairs[i].second]->getStation().getName();
+                checksum += original_max[i] - std::max(0, g.maxTrainsArriving(name));
+            }
+            g.rollback(checkpoint);
+            g.commitChanges();
+        });
+        row(size, "scenario, rollback + 10 removed + arrivals", ms, "checksum " + std::to_string(checksum));
+
+        // Random failures of the links, measuring the arrivals at the stations of the queries
+        double mean_loss = 0;
+        ms = millis([&]() {
+            FailureSimulation simulation(g, FAILURE_PROBABILITY);
+            for (const auto &pair: pairs) {
+                simulation.addArrivals(vertexes[pair.second]->getStation().getName());
+            }
+            for (const auto &distribution: simulation.run(NUM_SCENARIOS, seed)) {
+                mean_loss += distribution.mean;
+            }
+        });
+        row(size, "scenario, 1000 random failures x 20 arrivals", ms,
+            std::to_string((long long) (NUM_SCENARIOS / (ms / 1000))) + " scenarios/s, mean loss " + std::to_string(mean_loss));
+
+        fs::remove(stations_file);
+        fs::remove(network_file);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t seed = 1;
+    int all_pairs_limit = 1000;
+    int tree_limit = 10000;
+    std::vector<int> sizes;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--all-pairs-limit") == 0 && i + 1 < argc) {
+            all_pairs_limit = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tree-limit") == 0 && i + 1 < argc) {
+            tree_limit = std::stoi(argv[++i]);
+        } else {
+            sizes.push_back(std::stoi(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 10000, 100000, 1000000};
+    }
+
+    std::cout << std::right << std::setw(10) << "stations" << "  "
+              << std::left << std::setw(40) << "operation"
+              << std::right << std::setw(14) << "ms" << '\n';
+
+    for (int size: sizes) {
+        run(size, seed, all_pairs_limit, tree_limit);
+    }
+
+    return 0;
+}
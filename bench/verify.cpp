@@ -0,0 +1,904 @@
+#include "NetworkGenerator.h"
+
+#include "CostPolicy.h"
+#include "FlowNetwork.h"
+#include "GlobalMinCut.h"
+#include "GomoryHuTree.h"
+#include "Graph.h"
+#include "GraphKernels.h"
+#include "GraphStorage.h"
+#include "KShortestPaths.h"
+#include "LinkCriticality.h"
+#include "MaxFlowSolver.h"
+#include "UpgradePlanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Differential check of the max flow and cost engines: every engine answers the same queries on data/network.csv
+ * and on generated networks (see NetworkGenerator.h), the answers are compared with Graph::edmondsKarp and
+ * Graph::dijkstra, and each answer of the solvers is checked on its own:
+ * - a max flow must respect the capacities, be conserved at every other station and equal the capacity of the cut
+ *   left by the solver (so it is maximum);
+ * - the distances must be 0 at the source, not improvable by any link, and reached through a link that gives them.
+ * The loss of each link failure found by LinkCriticality is compared with solving again without the link.
+ * The flow after each step of an UpgradePlanner plan is compared with solving again on a copy of the network with
+ * the upgrades of that step and the ones before.
+ * The global min cut of each component must weigh what its links weigh and, when the Gomory-Hu tree is built,
+ * be its lightest edge in the component.
+ * The k shortest paths must be loopless, distinct, follow links of the network and cost the same as the ones of
+ * plain Yen (a search from every station of the previous path, without the tree or the A* bound).
+ *
+ * The time of each engine on each network (the fastest of a few runs) can be recorded as a baseline (--record) and later runs fail when an
+ * engine becomes slower than the baseline by more than the threshold (a ratio, times under the noise floor in ms
+ * are not compared). The times depend on the machine, so no baseline is shipped with the repository: record one
+ * locally (bench_verify --baseline file --record) before comparing against it.
+ * The exit code is 0 if everything passed, 1 if a check failed and 2 on usage or I/O errors.
+ *
+ * Usage: bench_verify [--pairs N] [--seed S] [--baseline file [--record]] [--threshold R] [--repeat N]
+ *                     [--noise-ms MS] [--sizes N,N,...] [stations.csv network.csv]
+ */
+
+namespace {
+    /**
+     * @brief Destinations queried from each source, so the warm starts are exercised
+     */
+    const int PAIRS_PER_SOURCE = 10;
+
+    /**
+     * @brief Largest network where the Gomory-Hu tree is built, it needs a max flow per station
+     */
+    const int TREE_LIMIT = 2000;
+
+    /**
+     * @brief Pairs whose link losses are checked, each needs a max flow per link
+     */
+    const int LINK_LOSS_PAIRS = 3;
+
+    /**
+     * @brief Pairs with flow whose upgrade plans are checked, and the budget and increment of each plan (each step
+     * needs a max flow on a copy of the network)
+     */
+    const int UPGRADE_PAIRS = 3;
+    const int UPGRADE_BUDGET = 20;
+    const int UPGRADE_INCREMENT = 1;
+
+    /**
+     * @brief Pairs whose k shortest paths are compared with plain Yen, and the k asked for
+     */
+    const int K_PATHS_PAIRS = 5;
+    const int K_PATHS = 10;
+
+    struct Options {
+        int numPairs = 200;
+        uint64_t seed = 1;
+        std::string baseline;
+        bool record = false;
+        double threshold = 1.5;
+        double noiseMs = 2.0;
+        std::vector<int> sizes = {100, 500, 2000};
+        std::string stations = "../data/stations.csv";
+        std::string network = "../data/network.csv";
+    };
+
+    struct Timing {
+        std::string dataset;
+        std::string engine;
+        double ms;
+    };
+
+    int failures = 0;
+    std::vector<Timing> timings;
+
+    /**
+     * @brief Runs of each engine, the fastest is kept to reduce the noise
+     */
+    int repeats = 3;
+
+    void fail(const std::string& dataset, const std::string& engine, const std::string& message) {
+        if (failures++ < 50) {
+            std::cout << "FAIL  " << dataset << "  " << engine << ": " << message << '\n';
+        }
+    }
+
+    /**
+     * @brief Time an engine, the fastest of the runs is kept for the baseline
+     */
+    void timed(const std::string& dataset, const std::string& engine, const std::function<void()>& f) {
+        double ms = std::numeric_limits<double>::max();
+        for (int i = 0; i < repeats; i++) {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            ms = std::min(ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        timings.push_back({dataset, engine, ms});
+        std::cout << "      " << std::left << std::setw(16) << dataset << std::setw(42) << engine
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << ms << " ms\n";
+    }
+
+    /**
+     * @brief Engines report no flow as 0 or -1, both are taken as 0
+     */
+    long long flowValue(long long flow) {
+        return std::max(0LL, flow);
+    }
+
+    /**
+     * @brief Compare the answers of an engine with the reference ones
+     */
+    void compare(const std::string& dataset, const std::string& engine,
+                 const std::vector<long long>& reference, const std::vector<long long>& results,
+                 const std::vector<std::pair<int, int>>& pairs, const FlowNetwork& network) {
+        for (size_t i = 0; i < pairs.size(); i++) {
+            if (reference[i] != results[i]) {
+                fail(dataset, engine, network.getName(pairs[i].first) + " -> " + network.getName(pairs[i].second)
+                    + " gave " + std::to_string(results[i]) + ", expected " + std::to_string(reference[i]));
+            }
+        }
+    }
+
+    /**
+     * @brief Check the flow left by the last query of a solver: capacities, conservation and a cut of the same value
+     *
+     * @return std::string Empty if the flow is a max flow, the problem otherwise
+     */
+    template <typename Capacity>
+    std::string checkMaxFlow(const BasicFlowNetwork<Capacity>& network, const BasicMaxFlowSolver<Capacity>& solver,
+                             int source, int dest, long long flow) {
+        long long cut = 0;
+        for (int v = 0; v < network.getNumVertex(); v++) {
+            long long net = 0;
+            for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+                if (solver.getFlow(a) > network.getCapacity(a)) {
+                    return "arc " + network.getName(v) + " -> " + network.getName(network.getHead(a))
+                        + " over capacity";
+                }
+                net += solver.getFlow(a);
+                if (solver.isOnSourceSide(v) && !solver.isOnSourceSide(network.getHead(a))) {
+                    cut += network.getCapacity(a);
+                }
+            }
+
+            long long expected = v == source ? flow : v == dest ? -flow : 0;
+            if (net != expected) {
+                return "flow not conserved at " + network.getName(v);
+            }
+        }
+
+        if (!solver.isOnSourceSide(source) || solver.isOnSourceSide(dest)) {
+            return "cut does not separate the stations";
+        }
+        if (cut != flow) {
+            return "cut of " + std::to_string(cut) + " for a flow of " + std::to_string(flow);
+        }
+        return "";
+    }
+
+    /**
+     * @brief Check that distances are shortest path distances from the source, with the costs of ServiceCost
+     *
+     * @return std::string Empty if they are, the problem otherwise
+     */
+    std::string checkDistances(const FlowNetwork& network, const std::vector<int>& distance, int source) {
+        const int INF = std::numeric_limits<int>::max();
+        if (distance[source] != 0) {
+            return "source at distance " + std::to_string(distance[source]);
+        }
+
+        std::vector<bool> tight(network.getNumVertex(), false);
+        tight[source] = true;
+        for (int v = 0; v < network.getNumVertex(); v++) {
+            if (distance[v] == INF) {
+                continue;
+            }
+            for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+                if (!network.isEdge(a)) {
+                    continue;
+                }
+                int w = network.getHead(a);
+                int through = distance[v] + ServiceCost::cost(network.getService(a));
+                if (through < distance[w]) {
+                    return network.getName(w) + " is closer through " + network.getName(v);
+                }
+                if (through == distance[w]) {
+                    tight[w] = true;
+                }
+            }
+        }
+
+        for (int v = 0; v < network.getNumVertex(); v++) {
+            if (distance[v] != INF && !tight[v]) {
+                return network.getName(v) + " has a distance no link gives";
+            }
+        }
+        return "";
+    }
+
+    /**
+     * @brief Random pairs of distinct stations, in groups sharing the source
+     */
+    std::vector<std::pair<int, int>> randomPairs(int n, int numPairs, std::mt19937_64& rng) {
+        std::vector<std::pair<int, int>> pairs;
+        if (n < 2) {
+            return pairs;
+        }
+
+        std::uniform_int_distribution<int> vertex(0, n - 1);
+        while ((int) pairs.size() < numPairs) {
+            int s = vertex(rng);
+            for (int i = 0; i < PAIRS_PER_SOURCE && (int) pairs.size() < numPairs; i++) {
+                int t = vertex(rng);
+                if (t != s) {
+                    pairs.emplace_back(s, t);
+                }
+            }
+        }
+        return pairs;
+    }
+
+    void verifyFlows(const std::string& dataset, const Graph& g, const FlowNetwork& network,
+                     const std::vector<std::pair<int, int>>& pairs) {
+        std::vector<std::pair<std::string, std::string>> names;
+        for (const auto &pair: pairs) {
+            names.emplace_back(network.getName(pair.first), network.getName(pair.second));
+        }
+
+        std::vector<long long> reference(pairs.size());
+        timed(dataset, "Graph::edmondsKarp", [&]() {
+            for (size_t i = 0; i < pairs.size(); i++) {
+                reference[i] = flowValue(g.edmondsKarp(names[i].first, names[i].second));
+            }
+        });
+
+        std::vector<long long> results(pairs.size());
+        auto graphEngine = [&](const std::string& engine, bool capacityScaling, bool warmStart) {
+            timed(dataset, engine, [&]() {
+                for (size_t i = 0; i < pairs.size(); i++) {
+                    results[i] = flowValue(g.edmondsKarp(names[i].first, names[i].second, capacityScaling, warmStart));
+                }
+            });
+            compare(dataset, engine, reference, results, pairs, network);
+        };
+        graphEngine("Graph::edmondsKarp, capacity scaling", true, false);
+        graphEngine("Graph::edmondsKarp, warm start", false, true);
+
+        timed(dataset, "Graph::edmondsKarpBatch", [&]() {
+            results = g.edmondsKarpBatch(names);
+        });
+        std::transform(results.begin(), results.end(), results.begin(), flowValue);
+        compare(dataset, "Graph::edmondsKarpBatch", reference, results, pairs, network);
+
+        auto kernelEngine = [&](const std::string& engine, auto& storage) {
+            timed(dataset, engine, [&]() {
+                for (size_t i = 0; i < pairs.size(); i++) {
+                    results[i] = flowValue(kernels::edmondsKarp<TrainCapacity>(storage, pairs[i].first, pairs[i].second));
+                }
+            });
+            compare(dataset, engine, reference, results, pairs, network);
+        };
+        CsrStorage<int> csr(network);
+        kernelEngine("edmondsKarp<TrainCapacity>, CSR", csr);
+        OverlayStorage<int> overlay(network);
+        kernelEngine("edmondsKarp<TrainCapacity>, overlay", overlay);
+
+        // The solvers are also checked on their own, with the cut they leave, in a second untimed pass
+        auto solverEngine = [&](const std::string& engine, const auto& solverNetwork, bool capacityScaling, bool warmStart) {
+            using Capacity = std::decay_t<decltype(solverNetwork.getCapacity(0))>;
+            BasicMaxFlowSolver<Capacity> solver(solverNetwork);
+            solver.setWarmStart(warmStart);
+            timed(dataset, engine, [&]() {
+                for (size_t i = 0; i < pairs.size(); i++) {
+                    results[i] = flowValue(solver.maxFlow(pairs[i].first, pairs[i].second, capacityScaling));
+                }
+            });
+            compare(dataset, engine, reference, results, pairs, network);
+
+            BasicMaxFlowSolver<Capacity> checked(solverNetwork);
+            checked.setWarmStart(warmStart);
+            for (size_t i = 0; i < pairs.size(); i++) {
+                long long flow = flowValue(checked.maxFlow(pairs[i].first, pairs[i].second, capacityScaling));
+                std::string problem = checkMaxFlow(solverNetwork, checked, pairs[i].first, pairs[i].second, flow);
+                if (!problem.empty()) {
+                    fail(dataset, engine, names[i].first + " -> " + names[i].second + ": " + problem);
+                }
+            }
+        };
+        solverEngine("MaxFlowSolver", network, false, false);
+        solverEngine("MaxFlowSolver, capacity scaling", network, true, false);
+        solverEngine("MaxFlowSolver, warm start", network, false, true);
+        FlowNetwork64 wide_network(g);
+        solverEngine("MaxFlowSolver64", wide_network, false, false);
+
+        std::vector<int> batch_results;
+        timed(dataset, "FlowNetwork::maxFlowBatch", [&]() {
+            batch_results = network.maxFlowBatch(pairs);
+        });
+        std::transform(batch_results.begin(), batch_results.end(), results.begin(), flowValue);
+        compare(dataset, "FlowNetwork::maxFlowBatch", reference, results, pairs, network);
+
+        if (network.getNumVertex() <= TREE_LIMIT) {
+            timed(dataset, "Gomory-Hu tree", [&]() {
+                GomoryHuTree tree(network);
+                for (size_t i = 0; i < pairs.size(); i++) {
+                    results[i] = flowValue(tree.maxFlow(pairs[i].first, pairs[i].second));
+                }
+            });
+            compare(dataset, "Gomory-Hu tree", reference, results, pairs, network);
+        }
+    }
+
+    void verifyCosts(const std::string& dataset, Graph& g, const FlowNetwork& network,
+                     const std::vector<std::pair<int, int>>& pairs) {
+        std::vector<int> sources;
+        for (const auto &pair: pairs) {
+            if (sources.empty() || sources.back() != pair.first) {
+                sources.push_back(pair.first);
+            }
+        }
+
+        int n = network.getNumVertex();
+        std::vector<Vertex *> vertexes(n);
+        for (int v = 0; v < n; v++) {
+            vertexes[v] = g.findVertex(network.getName(v));
+        }
+
+        // Distances of every station from each source, in the order of the network
+        std::vector<std::vector<int>> reference(sources.size(), std::vector<int>(n));
+        timed(dataset, "Graph::dijkstra", [&]() {
+            for (size_t i = 0; i < sources.size(); i++) {
+                g.dijkstra(vertexes[sources[i]]);
+                for (int v = 0; v < n; v++) {
+                    reference[i][v] = g.getDistance(vertexes[v]);
+                }
+            }
+        });
+        for (size_t i = 0; i < sources.size(); i++) {
+            std::string problem = checkDistances(network, reference[i], sources[i]);
+            if (!problem.empty()) {
+                fail(dataset, "Graph::dijkstra", "from " + network.getName(sources[i]) + ": " + problem);
+            }
+        }
+
+        auto kernelEngine = [&](const std::string& engine, auto& storage, const auto& node) {
+            std::vector<std::vector<int>> distances(sources.size(), std::vector<int>(n));
+            timed(dataset, engine, [&]() {
+                for (size_t i = 0; i < sources.size(); i++) {
+                    kernels::dijkstra<ServiceCost>(storage, node(sources[i]));
+                    for (int v = 0; v < n; v++) {
+                        distances[i][v] = storage.getDistance(node(v));
+                    }
+                }
+            });
+            for (size_t i = 0; i < sources.size(); i++) {
+                for (int v = 0; v < n; v++) {
+                    if (distances[i][v] != reference[i][v]) {
+                        fail(dataset, engine, network.getName(sources[i]) + " -> " + network.getName(v) + " gave "
+                            + std::to_string(distances[i][v]) + ", expected " + std::to_string(reference[i][v]));
+                        break;
+                    }
+                }
+            }
+        };
+        auto index = [](int v) { return v; };
+        AdjacencyStorage adjacency(g);
+        kernelEngine("dijkstra<ServiceCost>, adjacency", adjacency, [&vertexes](int v) { return vertexes[v]; });
+        CsrStorage<int> csr(network);
+        kernelEngine("dijkstra<ServiceCost>, CSR", csr, index);
+        OverlayStorage<int> overlay(network);
+        kernelEngine("dijkstra<ServiceCost>, overlay", overlay, index);
+    }
+
+    void verifyLinkLosses(const std::string& dataset, const Graph& g, const FlowNetwork& network,
+                          const std::vector<std::pair<int, int>>& pairs) {
+        // Losses summed by the stations of the link, in any direction
+        using Losses = std::map<std::pair<std::string, std::string>, long long>;
+        auto key = [](const std::string& a, const std::string& b) {
+            return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+        };
+
+        size_t num_pairs = std::min(pairs.size(), (size_t) LINK_LOSS_PAIRS);
+        std::vector<Losses> losses(num_pairs);
+        timed(dataset, "LinkCriticality::pairLinks", [&]() {
+            LinkCriticality criticality(g);
+            for (size_t i = 0; i < num_pairs; i++) {
+                losses[i].clear();
+                for (const auto &link: criticality.pairLinks(network.getName(pairs[i].first), network.getName(pairs[i].second))) {
+                    losses[i][key(link.origin, link.dest)] += link.loss;
+                }
+            }
+        });
+
+        MaxFlowSolver solver(network);
+        std::vector<bool> failed(network.getNumArcs(), false);
+        for (size_t i = 0; i < num_pairs; i++) {
+            int s = pairs[i].first, t = pairs[i].second;
+
+            Losses reference;
+            solver.setFailedArcs(nullptr);
+            long long flow = flowValue(solver.maxFlow(s, t));
+            for (int v = 0; v < network.getNumVertex() && flow > 0; v++) {
+                for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+                    if (a > network.getTwin(a)) {
+                        continue;
+                    }
+                    failed[a] = failed[network.getTwin(a)] = true;
+                    solver.setFailedArcs(&failed);
+                    long long loss = flow - flowValue(solver.maxFlow(s, t));
+                    failed[a] = failed[network.getTwin(a)] = false;
+                    if (loss > 0) {
+                        reference[key(network.getName(v), network.getName(network.getHead(a)))] += loss;
+                    }
+                }
+            }
+
+            if (losses[i] != reference) {
+                fail(dataset, "LinkCriticality::pairLinks", network.getName(s) + " -> " + network.getName(t)
+                    + " gave " + std::to_string(losses[i].size()) + " links with loss, expected "
+                    + std::to_string(reference.size()) + " (or different losses)");
+            }
+        }
+    }
+
+    /**
+     * @brief Copy of a graph with capacity added to some of its edges
+     */
+    Graph upgradedGraph(const Graph& g, const std::map<const Edge*, long long>& added) {
+        Graph upgraded;
+        for (auto v: g.getVertexSet()) {
+            upgraded.addVertex(v->getStation());
+        }
+
+        std::set<const Edge*> copied;
+        for (auto v: g.getVertexSet()) {
+            for (auto e: v->getAdj()) {
+                if (copied.count(e)) {
+                    continue;
+                }
+                auto it = added.find(e);
+                int weight = e->getWeight() + (int) (it == added.end() ? 0 : it->second);
+                std::string origin = v->getStation().getName();
+                std::string dest = e->getDest()->getStation().getName();
+                if (e->getReverse() != nullptr) {
+                    copied.insert(e->getReverse());
+                    upgraded.addBidirectionalEdge(origin, dest, weight, e->getService());
+                } else {
+                    upgraded.addEdge(origin, dest, weight, e->getService());
+                }
+            }
+        }
+        return upgraded;
+    }
+
+    void verifyUpgradePlans(const std::string& dataset, const Graph& g, const FlowNetwork& network,
+                            const std::vector<std::pair<int, int>>& pairs) {
+        // Pairs without flow have nothing to upgrade
+        MaxFlowSolver solver(network);
+        std::vector<std::pair<int, int>> planned;
+        std::vector<long long> flows;
+        for (size_t i = 0; i < pairs.size() && planned.size() < (size_t) UPGRADE_PAIRS; i++) {
+            long long flow = flowValue(solver.maxFlow(pairs[i].first, pairs[i].second));
+            if (flow > 0) {
+                planned.push_back(pairs[i]);
+                flows.push_back(flow);
+            }
+        }
+
+        std::vector<UpgradePlanner::Plan> plans(planned.size());
+        timed(dataset, "UpgradePlanner::planPair", [&]() {
+            UpgradePlanner planner(g);
+            for (size_t i = 0; i < planned.size(); i++) {
+                plans[i] = planner.planPair(network.getName(planned[i].first), network.getName(planned[i].second),
+                                            UPGRADE_BUDGET, UPGRADE_INCREMENT);
+            }
+        });
+
+        for (size_t i = 0; i < planned.size(); i++) {
+            const std::string& source = network.getName(planned[i].first);
+            const std::string& dest = network.getName(planned[i].second);
+            long long flow = flows[i];
+            if (plans[i].initialFlow != flow) {
+                fail(dataset, "UpgradePlanner::planPair", source + " -> " + dest + " started from "
+                    + std::to_string(plans[i].initialFlow) + ", expected " + std::to_string(flow));
+                continue;
+            }
+
+            // Each step adds to the first link between its stations (and to its reverse if it is bidirectional)
+            std::map<const Edge*, long long> added;
+            long long spent = 0;
+            for (const auto &step: plans[i].steps) {
+                const Edge* link = nullptr;
+                for (auto e: g.findVertex(step.origin)->getAdj()) {
+                    if (e->getDest()->getStation().getName() == step.dest) {
+                        link = e;
+                        break;
+                    }
+                }
+                if (link == nullptr) {
+                    fail(dataset, "UpgradePlanner::planPair", "upgraded " + step.origin + " / " + step.dest
+                        + ", which is not a link");
+                    break;
+                }
+                added[link] += step.added;
+                if (link->getReverse() != nullptr) {
+                    added[link->getReverse()] += step.added;
+                }
+                spent += step.added;
+
+                Graph upgraded = upgradedGraph(g, added);
+                FlowNetwork64 upgraded_network(upgraded);
+                MaxFlowSolver64 upgraded_solver(upgraded_network);
+                long long expected = flowValue(upgraded_solver.maxFlow(upgraded_network.findIndex(source),
+                                                                       upgraded_network.findIndex(dest)));
+                if (step.flow != expected) {
+                    fail(dataset, "UpgradePlanner::planPair", source + " -> " + dest + " gave "
+                        + std::to_string(step.flow) + " after +" + std::to_string(step.added) + " on " + step.origin
+                        + " / " + step.dest + ", expected " + std::to_string(expected));
+                    break;
+                }
+            }
+
+            if (spent > UPGRADE_BUDGET) {
+                fail(dataset, "UpgradePlanner::planPair", source + " -> " + dest + " spent " + std::to_string(spent)
+                    + " of a budget of " + std::to_string(UPGRADE_BUDGET));
+            }
+        }
+    }
+
+    void verifyMinCut(const std::string& dataset, const Graph& g, const FlowNetwork& network) {
+        std::vector<GlobalMinCut::Cut> cuts;
+        GlobalMinCut::Cut whole = {-1, {}, {}, {}};
+        timed(dataset, "GlobalMinCut", [&]() {
+            GlobalMinCut min_cut(g);
+            cuts = min_cut.componentCuts();
+            whole = min_cut.minCut();
+        });
+
+        std::unique_ptr<GomoryHuTree> tree;
+        if (network.getNumVertex() <= TREE_LIMIT) {
+            tree = std::make_unique<GomoryHuTree>(network);
+        }
+
+        int n = network.getNumVertex();
+        std::vector<int> side(n, -1); // 1 on the side, 0 on the other side, -1 out of the component
+        for (const auto &cut: cuts) {
+            std::fill(side.begin(), side.end(), -1);
+            for (const auto &name: cut.side) {
+                side[network.findIndex(name)] = 1;
+            }
+            for (const auto &name: cut.otherSide) {
+                side[network.findIndex(name)] = 0;
+            }
+            std::string engine = "GlobalMinCut, " + cut.side.front() + " split";
+
+            long long weight = 0;
+            for (int v = 0; v < n; v++) {
+                for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+                    int w = network.getHead(a), twin = network.getTwin(a);
+                    long long capacity = std::max(network.getCapacity(a), network.getCapacity(twin));
+                    if (a > twin || capacity == 0 || side[v] == -1 || side[w] == -1) {
+                        continue;
+                    }
+                    if (side[v] != side[w]) {
+                        weight += capacity;
+                    }
+                }
+            }
+            if (weight != cut.value || cut.side.size() > cut.otherSide.size()) {
+                fail(dataset, engine, "value " + std::to_string(cut.value) + ", the links weigh " + std::to_string(weight)
+                    + ", sides of " + std::to_string(cut.side.size()) + " and " + std::to_string(cut.otherSide.size()));
+            }
+
+            if (tree) {
+                long long lightest = std::numeric_limits<long long>::max();
+                for (int v = 0; v < n; v++) {
+                    int parent = tree->getParent(v);
+                    if (parent != -1 && side[v] != -1 && side[parent] != -1) {
+                        lightest = std::min(lightest, tree->getWeight(v));
+                    }
+                }
+                if (lightest != cut.value) {
+                    fail(dataset, engine, "value " + std::to_string(cut.value) + ", expected " + std::to_string(lightest));
+                }
+            }
+        }
+
+        long long expected = n < 2 ? -1 : 0;
+        if (!cuts.empty() && (int) (cuts.front().side.size() + cuts.front().otherSide.size()) == n) {
+            expected = cuts.front().value;
+        }
+        if (whole.value != expected) {
+            fail(dataset, "GlobalMinCut::minCut", "gave " + std::to_string(whole.value) + ", expected "
+                + std::to_string(expected));
+        }
+    }
+
+    /**
+     * @brief Costs of the k cheapest loopless paths by plain Yen, every station of the previous path is a spur and
+     * each spur is a Dijkstra search
+     */
+    std::vector<int> yenCosts(const FlowNetwork& network, int s, int t, int k) {
+        OverlayStorage<int> overlay(network);
+        auto tail = [&network](int a) {
+            return network.getHead(network.getTwin(a));
+        };
+        auto route = [&](int from) {
+            std::vector<int> arcs;
+            for (int w = t; w != from; w = tail(overlay.getParent(w))) {
+                arcs.push_back(overlay.getParent(w));
+            }
+            std::reverse(arcs.begin(), arcs.end());
+            return arcs;
+        };
+
+        kernels::dijkstra<ServiceCost>(overlay, s);
+        if (overlay.getDistance(t) == std::numeric_limits<int>::max()) {
+            return {};
+        }
+        std::vector<std::pair<int, std::vector<int>>> paths = {{overlay.getDistance(t), route(s)}};
+        std::set<std::pair<int, std::vector<int>>> candidates;
+        while ((int) paths.size() < k) {
+            const std::vector<int> last = paths.back().second;
+            int root_cost = 0;
+            for (size_t i = 0, v = s; i < last.size(); v = network.getHead(last[i]), i++) {
+                std::vector<int> root(last.begin(), last.begin() + (long) i);
+                for (const auto &path: paths) {
+                    if (path.second.size() > i && std::equal(root.begin(), root.end(), path.second.begin())) {
+                        overlay.removeLink(path.second[i]);
+                    }
+                }
+                for (int a: root) {
+                    overlay.removeVertex(tail(a));
+                }
+
+                kernels::dijkstra<ServiceCost>(overlay, (int) v);
+                if (overlay.getDistance(t) != std::numeric_limits<int>::max()) {
+                    std::vector<int> spur = route((int) v);
+                    root.insert(root.end(), spur.begin(), spur.end());
+                    candidates.emplace(root_cost + overlay.getDistance(t), root);
+                }
+                overlay.clearScenario();
+                root_cost += ServiceCost::cost(network.getService(last[i]));
+            }
+
+            if (candidates.empty()) {
+                break;
+            }
+            paths.push_back(*candidates.begin());
+            candidates.erase(candidates.begin());
+        }
+
+        std::vector<int> costs;
+        for (const auto &path: paths) {
+            costs.push_back(path.first);
+        }
+        return costs;
+    }
+
+    void verifyKShortestPaths(const std::string& dataset, const Graph& g, const FlowNetwork& network,
+                              const std::vector<std::pair<int, int>>& pairs) {
+        size_t num_pairs = std::min(pairs.size(), (size_t) K_PATHS_PAIRS);
+        std::vector<std::vector<KShortestPaths::Path>> found(num_pairs);
+        timed(dataset, "KShortestPaths", [&]() {
+            KShortestPaths k_paths(g);
+            for (size_t i = 0; i < num_pairs; i++) {
+                found[i] = k_paths.find(network.getName(pairs[i].first), network.getName(pairs[i].second), K_PATHS);
+            }
+        });
+
+        for (size_t i = 0; i < num_pairs; i++) {
+            int s = pairs[i].first, t = pairs[i].second;
+            std::string engine = "KShortestPaths, " + network.getName(s) + " -> " + network.getName(t);
+            std::vector<int> expected = yenCosts(network, s, t, K_PATHS);
+
+            std::vector<int> costs;
+            std::set<std::vector<std::string>> distinct;
+            for (const auto &path: found[i]) {
+                costs.push_back(path.cost);
+                distinct.insert(path.stations);
+
+                // Each step must be a link, the cheapest one when there are parallel links
+                int cost = 0, capacity = std::numeric_limits<int>::max();
+                std::set<std::string> stations;
+                for (size_t j = 0; j + 1 < path.stations.size(); j++) {
+                    int v = network.findIndex(path.stations[j]), w = network.findIndex(path.stations[j + 1]);
+                    int step = std::numeric_limits<int>::max();
+                    for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+                        if (network.getHead(a) == w && network.isEdge(a)) {
+                            step = std::min(step, ServiceCost::cost(network.getService(a)));
+                            capacity = std::min(capacity, network.getCapacity(a));
+                        }
+                    }
+                    cost = step == std::numeric_limits<int>::max() ? step : cost + step;
+                    stations.insert(path.stations[j]);
+                }
+                stations.insert(path.stations.back());
+
+                if (path.stations.front() != network.getName(s) || path.stations.back() != network.getName(t)
+                    || stations.size() != path.stations.size() || cost != path.cost || capacity > path.capacity) {
+                    fail(dataset, engine, "invalid path of cost " + std::to_string(path.cost));
+                    break;
+                }
+            }
+
+            if (costs != expected || distinct.size() != found[i].size()) {
+                fail(dataset, engine, "gave " + std::to_string(found[i].size()) + " paths, expected "
+                    + std::to_string(expected.size()) + " (or different costs, or repeated paths)");
+            }
+        }
+    }
+
+    void verify(const std::string& dataset, Graph& g, const Options& options, std::mt19937_64& rng) {
+        FlowNetwork network(g);
+        std::vector<std::pair<int, int>> pairs = randomPairs(network.getNumVertex(), options.numPairs, rng);
+        std::cout << dataset << ": " << network.getNumVertex() << " stations, " << pairs.size() << " pairs\n";
+
+        verifyFlows(dataset, g, network, pairs);
+        verifyLinkLosses(dataset, g, network, pairs);
+        verifyUpgradePlans(dataset, g, network, pairs);
+        verifyMinCut(dataset, g, network);
+        verifyCosts(dataset, g, network, pairs);
+        verifyKShortestPaths(dataset, g, network, pairs);
+    }
+
+    /**
+     * @brief Compare the timings with the baseline, engines missing from the baseline are not compared
+     *
+     * @return int Number of engines slower than allowed
+     */
+    int compareBaseline(const Options& options) {
+        std::ifstream in(options.baseline);
+        std::map<std::pair<std::string, std::string>, double> baseline;
+        std::string line;
+        while (std::getline(in, line)) {
+            // dataset,engine,ms where the engine names may have commas
+            size_t first = line.find(','), last = line.rfind(',');
+            if (first == std::string::npos || first == last) {
+                continue;
+            }
+            baseline[{line.substr(0, first), line.substr(first + 1, last - first - 1)}] = std::atof(line.c_str() + last + 1);
+        }
+
+        int slower = 0;
+        for (const Timing& t: timings) {
+            auto it = baseline.find({t.dataset, t.engine});
+            if (it == baseline.end() || t.ms < options.noiseMs) {
+                continue;
+            }
+            if (t.ms > it->second * options.threshold && t.ms - it->second > options.noiseMs) {
+                std::ostringstream message;
+                message << std::fixed << std::setprecision(3) << t.ms << " ms, baseline " << it->second << " ms";
+                fail(t.dataset, t.engine, "slower, " + message.str());
+                slower++;
+            }
+        }
+        return slower;
+    }
+
+    bool recordBaseline(const Options& options) {
+        std::ofstream out(options.baseline);
+        for (const Timing& t: timings) {
+            out << t.dataset << ',' << t.engine << ',' << std::fixed << std::setprecision(3) << t.ms << '\n';
+        }
+        return out.good();
+    }
+
+    bool parseSizes(const std::string& list, std::vector<int>& sizes) {
+        sizes.clear();
+        std::istringstream in(list);
+        std::string size;
+        while (std::getline(in, size, ',')) {
+            if (size.empty() || !std::all_of(size.begin(), size.end(), ::isdigit)) {
+                return false;
+            }
+            sizes.push_back(std::stoi(size));
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--pairs") == 0 && has_value) {
+            options.numPairs = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && has_value) {
+            options.baseline = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0) {
+            options.record = true;
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && has_value) {
+            options.threshold = std::stod(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && has_value) {
+            repeats = std::max(1, std::stoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--noise-ms") == 0 && has_value) {
+            options.noiseMs = std::stod(argv[++i]);
+        } else if (std::strcmp(argv[i], "--sizes") == 0 && has_value && parseSizes(argv[i + 1], options.sizes)) {
+            i++;
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if ((files.size() != 0 && files.size() != 2) || (options.record && options.baseline.empty())) {
+        std::cerr << "Usage: " << argv[0] << " [--pairs N] [--seed S] [--baseline file [--record]] [--threshold R]"
+                  << " [--repeat N] [--noise-ms MS] [--sizes N,N,...] [stations.csv network.csv]\n"
+                  << "The baseline is machine-specific and none is shipped: create it locally with --record.\n";
+        return 2;
+    }
+    if (files.size() == 2) {
+        options.stations = files[0];
+        options.network = files[1];
+    }
+
+    std::mt19937_64 rng(options.seed);
+
+    Graph data;
+    if (!data.readData(options.stations, options.network)) {
+        std::cerr << "Could not read " << options.stations << " and " << options.network << '\n';
+        return 2;
+    }
+    verify("data", data, options, rng);
+
+    namespace fs = std::filesystem;
+    for (int size: options.sizes) {
+        fs::path stations_file = fs::temp_directory_path() / ("feup_da1_verify_" + std::to_string(size) + "_stations.csv");
+        fs::path network_file = fs::temp_directory_path() / ("feup_da1_verify_" + std::to_string(size) + "_network.csv");
+        {
+            NetworkGenerator generator(size, options.seed);
+            std::ofstream stations(stations_file);
+            std::ofstream network(network_file);
+            generator.writeStations(stations);
+            generator.writeNetwork(network);
+        }
+
+        Graph g;
+        bool loaded = g.readData(stations_file.string(), network_file.string());
+        fs::remove(stations_file);
+        fs::remove(network_file);
+        if (!loaded) {
+            std::cerr << "Could not read the generated network of " << size << " stations\n";
+            return 2;
+        }
+        verify("generated-" + std::to_string(size), g, options, rng);
+    }
+
+    if (!options.baseline.empty()) {
+        if (options.record) {
+            if (!recordBaseline(options)) {
+                std::cerr << "Could not write " << options.baseline << '\n';
+                return 2;
+            }
+            std::cout << "Baseline recorded in " << options.baseline << '\n';
+        } else if (!fs::exists(options.baseline)) {
+            std::cerr << "Could not open " << options.baseline << " (record it first with --record)\n";
+            return 2;
+        } else {
+            compareBaseline(options);
+        }
+    }
+
+    if (failures) {
+        std::cout << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "MaxFlowSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Compares cold and warm started max flows when many queries share the source, with the destinations in index order
+ * and in depth first order from the source (the order used by maxFlowBatch).
+ *
+ * Usage: bench_warm_start [stations.csv network.csv]
+ */
+
+namespace {
+    /**
+     * @brief Square mesh of stations with capacities spread over three orders of magnitude
+     */
+    Graph mesh(int side, std::mt19937& rng) {
+        std::uniform_real_distribution<double> exponent(0, 3);
+        auto name = [side](int i, int j) { return "m" + std::to_string(i * side + j); };
+
+        Graph g;
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                g.addVertex(Station(name(i, j), "", "", "", ""));
+            }
+        }
+
+        for (int i = 0; i < side; i++) {
+            for (int j = 0; j < side; j++) {
+                if (i + 1 < side) {
+                    g.addBidirectionalEdge(name(i, j), name(i + 1, j), (int) std::pow(10, exponent(rng)), "STANDARD");
+                }
+                if (j + 1 < side) {
+                    g.addBidirectionalEdge(name(i, j), name(i, j + 1), (int) std::pow(10, exponent(rng)), "STANDARD");
+                }
+            }
+        }
+
+        return g;
+    }
+
+    /**
+     * @brief Solve every query from each of the sources, the destinations being the vertexes accepted by the filter
+     */
+    template <typename Filter>
+    void run(const std::string& name, const FlowNetwork& network, int sources, bool warm, bool depthFirst, Filter filter,
+             std::vector<int>& reference) {
+        MaxFlowSolver solver(network);
+        solver.setWarmStart(warm);
+
+        long long paths = 0;
+        int mismatches = 0;
+        size_t k = 0;
+        bool record = reference.empty();
+        int n = network.getNumVertex();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < sources; s++) {
+            std::vector<int> dests;
+            for (int t = 0; t < n; t++) {
+                if (t != s && filter(s, t)) {
+                    dests.push_back(t);
+                }
+            }
+            std::vector<int> position(dests.size());
+            for (size_t i = 0; i < dests.size(); i++) {
+                position[i] = (int) i;
+            }
+
+            if (depthFirst) {
+                std::vector<int> rank = network.depthFirstRanks(s);
+                std::sort(position.begin(), position.end(), [&](int a, int b) {
+                    return rank[dests[a]] < rank[dests[b]];
+                });
+            }
+
+            for (int i: position) {
+                int flow = solver.maxFlow(s, dests[i]);
+                paths += solver.getAugmentations();
+
+                if (record) {
+                    reference.push_back(flow);
+                } else {
+                    mismatches += flow != reference[k + i];
+                }
+            }
+            k += dests.size();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::left << std::setw(44) << name
+                  << std::right << std::setw(14) << paths
+                  << std::setw(12) << std::fixed << std::setprecision(3) << ms
+                  << std::setw(12) << mismatches << '\n';
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string stations = argc >= 3 ? argv[1] : "../data/stations.csv";
+    std::string network_file = argc >= 3 ? argv[2] : "../data/network.csv";
+
+    Graph g;
+    if (!g.readData(stations, network_file)) {
+        std::cerr << "Could not read " << stations << " and " << network_file << '\n';
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(44) << "queries"
+              << std::right << std::setw(14) << "paths" << std::setw(12) << "ms" << std::setw(12) << "mismatches" << '\n';
+
+    FlowNetwork network(g);
+    auto upper = [](int s, int t) { return t > s; };
+    std::vector<int> reference;
+    run("network all pairs, cold", network, network.getNumVertex(), false, false, upper, reference);
+    run("network all pairs, warm", network, network.getNumVertex(), true, false, upper, reference);
+    run("network all pairs, warm, depth first", network, network.getNumVertex(), true, true, upper, reference);
+
+    std::mt19937 rng(1);
+    Graph grid = mesh(30, rng);
+    FlowNetwork grid_network(grid);
+    auto any = [](int, int) { return true; };
+    reference.clear();
+    run("30x30 mesh, 10 sources, cold", grid_network, 10, false, false, any, reference);
+    run("30x30 mesh, 10 sources, warm", grid_network, 10, true, false, any, reference);
+    run("30x30 mesh, 10 sources, warm, depth first", grid_network, 10, true, true, any, reference);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#ifndef FEUP_DA1_ALLPAIRSFLOWS_H
+#define FEUP_DA1_ALLPAIRSFLOWS_H
+
+#include "FlowNetwork.h"
+#include "GomoryHuTree.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Maximum flow between every pair of vertexes of a network, as its flow equivalent tree, that can be kept in
+ * a cache file
+ *
+ * @details The tree keeps all the pair flows in O(|V|): the flow of a pair is the lightest edge of its tree path.
+ * The network is identified by a fingerprint of its content (names, arcs and capacities in index order), so a cache
+ * file is only used for the network it was computed for.
+ *
+ * The cache file is a 24 byte header followed by the parent (32 bit) and the weight (64 bit) of each vertex of the
+ * tree, in the byte order of the machine.
+ */
+class AllPairsFlows {
+private:
+    /**
+     * @brief Fingerprint of the network
+     */
+    uint64_t _fingerprint;
+
+    /**
+     * @brief Flow equivalent tree of the network
+     */
+    GomoryHuTree _tree;
+
+public:
+    /**
+     * @brief Get the pair flows from a complete flow equivalent tree
+     *
+     * @param tree Flow equivalent tree of the network
+     * @param fingerprint Fingerprint of the network
+     */
+    AllPairsFlows(GomoryHuTree tree, uint64_t fingerprint);
+
+    /**
+     * @brief Compute the fingerprint of a network, a 64 bit hash (FNV-1a) of its content
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param network Network
+     * @return uint64_t Fingerprint
+     */
+    template <typename Capacity>
+    static uint64_t fingerprint(const BasicFlowNetwork<Capacity>& network);
+
+    /**
+     * @brief Read the pair flows of a network from a cache file
+     *
+     * @details Time Complexity: O(|V|)
+     *
+     * @param path Path of the cache file
+     * @param numVertex Number of vertexes of the network
+     * @param fingerprint Fingerprint of the network
+     * @return std::unique_ptr<AllPairsFlows> Pair flows, or nullptr if the file does not exist, is not of the
+     * network or is not a valid tree
+     */
+    static std::unique_ptr<AllPairsFlows> load(const std::string& path, int numVertex, uint64_t fingerprint);
+
+    /**
+     * @brief Write the pair flows to a cache file, replaced at once so readers never see a partial file
+     *
+     * @details Time Complexity: O(|V|)
+     *
+     * @param path Path of the cache file
+     * @return true File written
+     * @return false File could not be written
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Get the number of vertexes of the network
+     */
+    int getNumVertex() const;
+
+    /**
+     * @brief Get the fingerprint of the network
+     */
+    uint64_t getFingerprint() const;
+
+    /**
+     * @brief Get the flow equivalent tree, see GomoryHuTree::maxFlow, sumOfMaxFlows and maxFlowPairs
+     */
+    const GomoryHuTree& getTree() const;
+};
+
+#endif // FEUP_DA1_ALLPAIRSFLOWS_H
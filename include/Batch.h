@@ -0,0 +1,204 @@
+#ifndef FEUP_DA1_BATCH_H
+#define FEUP_DA1_BATCH_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "GraphStorage.h"
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Non interactive mode, answers a list of queries without any terminal interaction
+ *
+ * @details Queries are read one per line, with comma separated fields like the data files. Empty lines and lines
+ * starting with '#' are ignored:
+ *
+ *   maxflow,<origin>,<destination>     max number of trains between two stations
+ *   arrivals,<station>                 max number of trains arriving at the same time at a station
+ *   mincost,<origin>,<destination>     cost of a train on the cheapest path, trains it can carry and their cost
+ *   kpaths,<origin>,<destination>,<k>  the k cheapest loopless paths, with the same values as mincost (k <= 1000)
+ *   maxpairs                           pairs of stations that need the most trains
+ *   mincut                             smallest capacity whose loss splits the network, and the stations split
+ *   topk,<k>[,regions]                 top k municipalities and districts (flow between regions with "regions")
+ *   remove_station,<station>           take a station out of service (scenario)
+ *   remove_link,<origin>,<destination> take the connection from origin to destination out of service (scenario)
+ *   reset                              put every station and connection back in service
+ *   affected,<k>                       top k stations whose arrivals drop the most in the scenario
+ *
+ * Results are written one per line, starting with the line number of the query and its command:
+ *
+ *   <line>,maxflow,<origin>,<destination>,<trains>
+ *   <line>,arrivals,<station>,<trains>
+ *   <line>,mincost,<origin>,<destination>,<cost>,<trains>,<total cost>
+ *   <line>,kpaths,<rank>,<cost>,<trains>,<total cost>,<station> -> ... -> <station>   (one line per path)
+ *   <line>,maxpairs,<origin>,<destination>,<trains>           (one line per pair)
+ *   <line>,mincut,<trains>,<station>                         (one line per station of the smaller side)
+ *   <line>,topk,<municipality|district>,<rank>,<name>        (one line per region)
+ *   <line>,remove_station|remove_link|reset,ok
+ *   <line>,affected,<rank>,<station>,<difference>            (one line per affected station)
+ *   <line>,error,<message>
+ *
+ * Max flow queries are not solved one at a time: they are collected until the scenario changes (or the input
+ * ends) and solved together by Graph::edmondsKarpBatch, the other results waiting for them to keep the order.
+ *
+ * The graph is only read, the scenario is a copy private to the batch, so many batches can run at the same time
+ * on the same graph.
+ *
+ * With a stats output, the wall time and the counters of Stats.h of each query are reported there, one line per
+ * query: <line>,<command>,<ms>,<counters>. Max flow queries are then solved one at a time by Graph::edmondsKarp,
+ * so each one gets its own counters.
+ */
+class Batch {
+private:
+    /**
+     * @brief Graph of the railway network as it was read
+     */
+    const Graph& _graph;
+
+    /**
+     * @brief Graph with the stations and connections out of service, nullptr if there are none
+     */
+    std::unique_ptr<Graph> _scenario;
+
+    /**
+     * @brief Results of the queries not written yet, in query order
+     */
+    std::vector<std::string> _results;
+
+    /**
+     * @brief Max flow queries waiting to be solved, with the index of their result
+     */
+    std::vector<std::pair<std::string, std::string>> _pendingFlows;
+    std::vector<size_t> _pendingResults;
+
+    /**
+     * @brief Threads used by each group of max flow queries, 0 to use all hardware threads
+     */
+    unsigned int _numThreads;
+
+    /**
+     * @brief Snapshot of the current graph and the state of dijkstra in it, nullptr until a min cost query needs it
+     */
+    std::unique_ptr<FlowNetwork> _costNetwork;
+    std::unique_ptr<CsrStorage<int>> _costs;
+
+    /**
+     * @brief Source of the last dijkstra in the cost snapshot, -1 if there is none
+     */
+    int _costSource = -1;
+
+    /**
+     * @brief Arrivals already computed in the graph as it was read and in the current graph
+     */
+    std::unordered_map<std::string, int> _originalArrivals;
+    std::unordered_map<std::string, int> _arrivals;
+
+    /**
+     * @brief Number of queries that failed
+     */
+    int _errors = 0;
+
+    /**
+     * @brief Where the work of each query is reported, nullptr to not report it
+     */
+    std::ostream* _statsOut = nullptr;
+
+    /**
+     * @brief Graph the queries are answered in, with the scenario if there is one
+     */
+    const Graph& current() const;
+
+    /**
+     * @brief Split a query in its comma separated fields
+     *
+     * @param line Query
+     * @return std::vector<std::string> Fields
+     */
+    static std::vector<std::string> split(const std::string& line);
+
+    /**
+     * @brief Add an error to the results
+     *
+     * @param line Line number of the query
+     * @param message What went wrong
+     */
+    void error(int line, const std::string& message);
+
+    /**
+     * @brief Get the max number of trains arriving at a station, computing it only once per graph
+     *
+     * @details Time Complexity: O(|E|²log(U)) the first time, O(1) after
+     *
+     * @param g Graph
+     * @param cache Arrivals already computed in the graph
+     * @param stationName Name of the station
+     * @return int Number of trains, 0 if the station does not exist or no train can arrive
+     */
+    static int arrivals(const Graph& g, std::unordered_map<std::string, int>& cache, const std::string& stationName);
+
+    /**
+     * @brief Start a new scenario, the snapshots and results of the previous one are not valid anymore
+     */
+    void newScenario();
+
+    /**
+     * @brief Solve the waiting max flow queries and write every result
+     *
+     * @details Time Complexity: O(|V|+|E|+Q|V||E|²/T) where Q is the number of waiting max flow queries
+     *
+     * @param out Output
+     */
+    void flush(std::ostream& out);
+
+    /**
+     * @brief Answer a query (max flow queries are only queued)
+     *
+     * @param line Line number of the query
+     * @param fields Fields of the query, the first is the command
+     * @param out Output, the waiting results are written to it before the scenario changes
+     */
+    void runQuery(int line, const std::vector<std::string>& fields, std::ostream& out);
+
+public:
+    /**
+     * @brief Max flow queries kept waiting before solving them, bounds the memory used for long inputs
+     */
+    static const size_t MAX_PENDING_FLOWS = 4096;
+
+    /**
+     * @brief Largest k of a kpaths query, each route keeps its stations so a huge k would exhaust the memory
+     */
+    static const int MAX_K_PATHS = 1000;
+
+    /**
+     * @brief Construct a new Batch object
+     *
+     * @param g Graph of the railway network
+     * @param numThreads Threads used by each group of max flow queries, 0 to use all hardware threads
+     */
+    explicit Batch(const Graph& g, unsigned int numThreads = 0);
+
+    /**
+     * @brief Report the time and the work of each query
+     *
+     * @param out Where to report, nullptr to stop reporting
+     */
+    void setStatsOutput(std::ostream* out);
+
+    /**
+     * @brief Answer every query of the input
+     *
+     * @param in Queries
+     * @param out Results
+     * @return int Number of queries that failed
+     */
+    int run(std::istream& in, std::ostream& out);
+};
+
+#endif // FEUP_DA1_BATCH_H
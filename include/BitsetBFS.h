@@ -0,0 +1,317 @@
+#ifndef FEUP_DA1_BITSETBFS_H
+#define FEUP_DA1_BITSETBFS_H
+
+#include "FlowNetwork.h"
+#include "Stats.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Breadth first search over the topology of a flow network, direction optimizing on dense networks
+ *
+ * @details Visited and target sets are bitsets, one bit per vertex. On a dense network each level is expanded
+ * top-down (from the frontier to its neighbours) while the frontier is small and bottom-up (each unvisited vertex
+ * looks for a parent in the frontier) while it is large, which skips most of the arcs scanned by a plain BFS on
+ * dense levels. Rail networks are sparse with long paths: the levels are a few stations and a bottom-up level
+ * scans every unvisited station, so there the search is a plain queue BFS (bench_bfs compares both).
+ */
+class BitsetBFS {
+private:
+    /**
+     * @brief Network being searched
+     */
+    const NetworkTopology& _network;
+
+    /**
+     * @brief Vertexes visited by the last search
+     */
+    std::vector<uint64_t> _visited;
+
+    /**
+     * @brief Vertexes of the current level, only filled while expanding bottom-up
+     */
+    std::vector<uint64_t> _frontier;
+
+    /**
+     * @brief Vertexes visited by the last search in the order they were reached, each level after the previous one
+     */
+    std::vector<int> _queue;
+
+    /**
+     * @brief Vertexes where the search stops
+     */
+    std::vector<uint64_t> _targets;
+
+    /**
+     * @brief Target vertexes, to clear them in O(number of targets)
+     */
+    std::vector<int> _targetList;
+
+    /**
+     * @brief Arc used to reach each visited vertex, -2 for the sources
+     */
+    std::vector<int> _parent;
+
+    /**
+     * @brief If search() is direction optimizing, decided from the density of the network
+     */
+    bool _directionOptimizing;
+
+    /**
+     * @brief Arcs per vertex from which the network is dense enough for bottom-up levels to pay off
+     */
+    static constexpr long long DENSE_ARCS_PER_VERTEX = 8;
+
+    /**
+     * @brief Switch to bottom-up when the frontier has more than 1/ALPHA of the unexplored arcs
+     */
+    static constexpr long long ALPHA = 14;
+
+    /**
+     * @brief Switch back to top-down when the frontier has less than 1/BETA of the vertexes
+     */
+    static constexpr long long BETA = 24;
+
+    /**
+     * @brief Mark a vertex as reached through an arc
+     *
+     * @param v Vertex index
+     * @param arc Arc used to reach it
+     * @return true Vertex is a target
+     * @return false Vertex is not a target
+     */
+    bool reach(int v, int arc) {
+        _visited[v >> 6] |= uint64_t(1) << (v & 63);
+        _queue.push_back(v);
+        _parent[v] = arc;
+        return test(_targets, v);
+    }
+
+    /**
+     * @brief Check a bit of a bitset
+     *
+     * @param bits Bitset
+     * @param v Bit index
+     * @return true Bit is set
+     * @return false Bit is not set
+     */
+    static bool test(const std::vector<uint64_t>& bits, int v) {
+        return (bits[v >> 6] >> (v & 63)) & 1;
+    }
+
+    /**
+     * @brief Clear the visited vertexes and the queue
+     *
+     * @details Time Complexity: O(|V|/64)
+     */
+    void clear();
+
+    /**
+     * @brief Set or clear the frontier bits of the vertexes of a level
+     *
+     * @details Time Complexity: O(size of the level)
+     *
+     * @param begin Index of the first vertex of the level in the queue
+     * @param end Index after the last vertex of the level in the queue
+     * @param set Set the bits, clear them otherwise
+     */
+    void markFrontier(size_t begin, size_t end, bool set);
+
+public:
+    /**
+     * @brief Construct a new Bitset BFS object
+     *
+     * @param network Network to search
+     */
+    explicit BitsetBFS(const NetworkTopology& network);
+
+    /**
+     * @brief Set the vertexes where the search stops (replacing the previous ones)
+     *
+     * @details Time Complexity: O(number of targets)
+     *
+     * @param targets Target vertex indexes
+     */
+    void setTargets(const std::vector<int>& targets);
+
+    /**
+     * @brief If a vertex is a target
+     *
+     * @param v Vertex index
+     * @return true Vertex is a target
+     * @return false Vertex is not a target
+     */
+    bool isTarget(int v) const;
+
+    /**
+     * @brief If a vertex was visited by the last search
+     *
+     * @param v Vertex index
+     * @return true Vertex was visited
+     * @return false Vertex was not visited
+     */
+    bool isVisited(int v) const;
+
+    /**
+     * @brief Get the arc used to reach a vertex in the last search
+     *
+     * @param v Visited vertex index
+     * @return int Arc index, -2 for the sources
+     */
+    int getParent(int v) const;
+
+    /**
+     * @brief If search() is direction optimizing on this network, or a plain queue BFS
+     *
+     * @return true The network has at least DENSE_ARCS_PER_VERTEX arcs per vertex
+     * @return false The network is sparse
+     */
+    bool isDirectionOptimizing() const;
+
+    /**
+     * @brief Search from the sources until a target is reached, using only the usable arcs
+     * To search backwards (vertexes that can reach the sources) make an arc usable when its twin is.
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param sources Source vertex indexes
+     * @param usable Function telling if an arc can be used
+     * @return int Target reached or -1 if none is reachable (then every reachable vertex is visited)
+     */
+    template <typename Usable>
+    int search(const std::vector<int>& sources, Usable usable);
+
+    /**
+     * @brief Search like search(), always top-down with a plain queue
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param sources Source vertex indexes
+     * @param usable Function telling if an arc can be used
+     * @return int Target reached or -1 if none is reachable (then every reachable vertex is visited)
+     */
+    template <typename Usable>
+    int searchTopDown(const std::vector<int>& sources, Usable usable);
+
+    /**
+     * @brief Search like search(), a level at a time, switching between top-down and bottom-up levels
+     *
+     * @details Time Complexity: O(|V|+|E|) plus O(|V|/64) for each bottom-up level
+     *
+     * @param sources Source vertex indexes
+     * @param usable Function telling if an arc can be used
+     * @return int Target reached or -1 if none is reachable (then every reachable vertex is visited)
+     */
+    template <typename Usable>
+    int searchDirectionOptimizing(const std::vector<int>& sources, Usable usable);
+};
+
+template <typename Usable>
+int BitsetBFS::search(const std::vector<int>& sources, Usable usable) {
+    return _directionOptimizing ? searchDirectionOptimizing(sources, usable) : searchTopDown(sources, usable);
+}
+
+template <typename Usable>
+int BitsetBFS::searchDirectionOptimizing(const std::vector<int>& sources, Usable usable) {
+    clear();
+
+    long long unexplored_arcs = _network.getNumArcs();
+    long long frontier_arcs = 0;
+    for (int s: sources) {
+        if (reach(s, -2)) {
+            return s;
+        }
+        unexplored_arcs -= _network.arcsEnd(s) - _network.arcsBegin(s);
+        frontier_arcs += _network.arcsEnd(s) - _network.arcsBegin(s);
+    }
+
+    bool bottom_up = false;
+    for (size_t begin = 0, end = _queue.size(); begin < end; begin = end, end = _queue.size()) {
+        if (!bottom_up) {
+            bottom_up = frontier_arcs * ALPHA > unexplored_arcs;
+        } else {
+            bottom_up = (long long) (end - begin) * BETA >= _network.getNumVertex();
+        }
+        frontier_arcs = 0;
+
+        if (bottom_up) {
+            // Every unvisited vertex looks for a parent in the frontier
+            markFrontier(begin, end, true);
+            for (size_t word = 0; word < _visited.size(); word++) {
+                uint64_t unvisited = ~_visited[word];
+                if (word == _visited.size() - 1 && (_network.getNumVertex() & 63)) {
+                    unvisited &= (uint64_t(1) << (_network.getNumVertex() & 63)) - 1;
+                }
+
+                for (; unvisited; unvisited &= unvisited - 1) {
+                    int v = (int) (word << 6) + __builtin_ctzll(unvisited);
+                    STATS_ADD(vertexScans, 1);
+
+                    for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+                        STATS_ADD(edgeScans, 1);
+                        int in = _network.getTwin(a);
+                        if (test(_frontier, _network.getHead(a)) && usable(in)) {
+                            if (reach(v, in)) {
+                                markFrontier(begin, end, false);
+                                return v;
+                            }
+                            unexplored_arcs -= _network.arcsEnd(v) - _network.arcsBegin(v);
+                            frontier_arcs += _network.arcsEnd(v) - _network.arcsBegin(v);
+                            break;
+                        }
+                    }
+                }
+            }
+            markFrontier(begin, end, false);
+        } else {
+            // Every frontier vertex visits its neighbours
+            for (size_t i = begin; i < end; i++) {
+                int v = _queue[i];
+                STATS_ADD(vertexScans, 1);
+
+                for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+                    STATS_ADD(edgeScans, 1);
+                    int w = _network.getHead(a);
+                    if (!test(_visited, w) && usable(a)) {
+                        if (reach(w, a)) {
+                            return w;
+                        }
+                        unexplored_arcs -= _network.arcsEnd(w) - _network.arcsBegin(w);
+                        frontier_arcs += _network.arcsEnd(w) - _network.arcsBegin(w);
+                    }
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+template <typename Usable>
+int BitsetBFS::searchTopDown(const std::vector<int>& sources, Usable usable) {
+    clear();
+
+    for (int s: sources) {
+        if (reach(s, -2)) {
+            return s;
+        }
+    }
+
+    for (size_t head = 0; head < _queue.size(); head++) {
+        int v = _queue[head];
+        STATS_ADD(vertexScans, 1);
+
+        for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+            STATS_ADD(edgeScans, 1);
+            int w = _network.getHead(a);
+            if (!test(_visited, w) && usable(a) && reach(w, a)) {
+                return w;
+            }
+        }
+    }
+
+    return -1;
+}
+
+#endif // FEUP_DA1_BITSETBFS_H
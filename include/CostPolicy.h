@@ -0,0 +1,77 @@
+#ifndef FEUP_DA1_COSTPOLICY_H
+#define FEUP_DA1_COSTPOLICY_H
+
+#include "VertexEdge.h"
+
+/**
+ * @brief Cost of a trip by type of service, the cost charged by the company
+ */
+struct ServiceCost {
+    /**
+     * @brief Cost of a STANDARD trip
+     */
+    static constexpr int STANDARD = 2;
+
+    /**
+     * @brief Cost of an ALFA PENDULAR trip
+     */
+    static constexpr int ALFA_PENDULAR = 4;
+
+    /**
+     * @brief Get the cost of a trip
+     *
+     * @param service Type of service of the trip
+     * @return int Cost
+     */
+    static constexpr int cost(Service service) {
+        return service == Service::STANDARD ? STANDARD : ALFA_PENDULAR;
+    }
+};
+
+/**
+ * @brief Every trip costs the same, the cost of a path is its number of trips
+ */
+struct HopCost {
+    /**
+     * @brief Get the cost of a trip
+     *
+     * @return int Cost (always 1)
+     */
+    static constexpr int cost(Service) {
+        return 1;
+    }
+};
+
+/**
+ * @brief Capacity of an edge is its number of trains
+ */
+struct TrainCapacity {
+    /**
+     * @brief Get the capacity used for an edge
+     *
+     * @param capacity Number of trains of the edge
+     * @return Capacity Capacity
+     */
+    template <typename Capacity>
+    static constexpr Capacity capacity(Capacity capacity) {
+        return capacity;
+    }
+};
+
+/**
+ * @brief Every edge with trains has capacity 1, the max flow is the number of edge disjoint routes
+ */
+struct UnitCapacity {
+    /**
+     * @brief Get the capacity used for an edge
+     *
+     * @param capacity Number of trains of the edge
+     * @return Capacity 1 if the edge has trains, 0 otherwise
+     */
+    template <typename Capacity>
+    static constexpr Capacity capacity(Capacity capacity) {
+        return capacity > 0 ? 1 : 0;
+    }
+};
+
+#endif // FEUP_DA1_COSTPOLICY_H
@@ -0,0 +1,194 @@
+#ifndef FEUP_DA1_FAILURESIMULATION_H
+#define FEUP_DA1_FAILURESIMULATION_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "TaskControl.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Monte-Carlo simulation of random link failures in the railway network
+ *
+ * @details Each scenario takes every link out of service with its failure probability and measures the max flow
+ * between pairs of stations or arriving at stations. Scenarios are masks of failed arcs over one shared flow
+ * network, evaluated in parallel with one solver per thread, so no graph is copied. A scenario where no failed
+ * link carries flow in the max flow of the whole network keeps that flow, and is not solved.
+ */
+class FailureSimulation {
+public:
+    /**
+     * @brief Capacity loss of a measure over the scenarios
+     */
+    struct Distribution {
+        /**
+         * @brief Name of the measure, "A -> B" for a pair or "-> A" for the arrivals at a station
+         */
+        std::string name;
+
+        /**
+         * @brief Max flow without failures
+         */
+        long long baseline;
+
+        /**
+         * @brief Number of scenarios evaluated
+         */
+        int scenarios;
+
+        /**
+         * @brief Mean capacity loss
+         */
+        double mean;
+
+        /**
+         * @brief Percentiles of the capacity loss (the smallest loss of at least that fraction of scenarios)
+         */
+        long long p50, p90, p95, p99;
+
+        /**
+         * @brief Largest capacity loss
+         */
+        long long max;
+
+        /**
+         * @brief Fraction of the scenarios with some loss
+         */
+        double lossProbability;
+    };
+
+private:
+    /**
+     * @brief Flow between a set of sources and a set of sinks
+     */
+    struct Measure {
+        std::string name;
+        std::vector<int> sources;
+        std::vector<int> sinks;
+    };
+
+    /**
+     * @brief Flow network of the graph, if its flows fit in an int
+     */
+    std::unique_ptr<FlowNetwork> _network;
+
+    /**
+     * @brief Flow network of the graph, if its flows need 64 bits
+     */
+    std::unique_ptr<FlowNetwork64> _wideNetwork;
+
+    /**
+     * @brief First arc of each link (the other is its twin)
+     */
+    std::vector<int> _links;
+
+    /**
+     * @brief Failure probability of each link
+     */
+    std::vector<double> _probability;
+
+    /**
+     * @brief Measures of each scenario
+     */
+    std::vector<Measure> _measures;
+
+    /**
+     * @brief Get the network the simulation uses
+     */
+    const NetworkTopology& topology() const;
+
+    /**
+     * @brief Evaluate the scenarios
+     *
+     * @param network Flow network of the graph
+     * @param numScenarios Number of scenarios
+     * @param seed Seed of the random failures
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the scenarios (optional)
+     * @param baseline Filled with the max flow of each measure without failures
+     * @param losses Filled with the loss of each measure (outer) in each scenario (inner), -1 if not evaluated
+     */
+    template <typename Capacity>
+    void simulate(
+        const BasicFlowNetwork<Capacity>& network,
+        int numScenarios,
+        uint64_t seed,
+        unsigned int numThreads,
+        TaskControl* control,
+        std::vector<long long>& baseline,
+        std::vector<std::vector<long long>>& losses
+    ) const;
+
+public:
+    /**
+     * @brief Construct a new Failure Simulation object, every link with the same failure probability
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     * The 64 bit flow network is only used if the flows of the graph may not fit in an int.
+     *
+     * @param g Graph of the railway network
+     * @param failureProbability Probability of each link failing in a scenario, between 0 and 1
+     */
+    FailureSimulation(const Graph& g, double failureProbability);
+
+    /**
+     * @brief Set the failure probability of the link between two stations
+     *
+     * @details Time Complexity: O(deg(origin))
+     *
+     * @param origin Station at one end of the link
+     * @param dest Station at the other end of the link
+     * @param probability Probability of the link failing in a scenario
+     * @return true Probability was set
+     * @return false The stations or the link do not exist, or the probability is not between 0 and 1
+     */
+    bool setFailureProbability(const std::string& origin, const std::string& dest, double probability);
+
+    /**
+     * @brief Measure the max flow between two stations
+     *
+     * @param source Source station
+     * @param dest Destination station
+     * @return true Measure was added
+     * @return false A station does not exist or they are the same
+     */
+    bool addPair(const std::string& source, const std::string& dest);
+
+    /**
+     * @brief Measure the max number of trains arriving at a station, from the terminal stations that reach it
+     * without failures (Graph::maxTrainsArriving)
+     *
+     * @param station Station
+     * @return true Measure was added
+     * @return false The station does not exist
+     */
+    bool addArrivals(const std::string& station);
+
+    /**
+     * @brief Get the number of measures added
+     */
+    size_t getNumMeasures() const;
+
+    /**
+     * @brief Evaluate random failure scenarios and get the distribution of the capacity loss of each measure
+     * The failures of each scenario only depend on the seed and the scenario number, so the result is the same for
+     * any number of threads.
+     *
+     * @details Time Complexity: O(S(|L| + F·M|V||E|²)/T) where S is the number of scenarios, L the links, F the
+     * fraction of scenarios where a failed link carries flow, M the number of measures and T the number of threads
+     *
+     * @param numScenarios Number of scenarios
+     * @param seed Seed of the random failures
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the scenarios, if cancelled the distributions are of the scenarios evaluated so far
+     * (optional)
+     * @return std::vector<Distribution> Distribution of each measure, in the order they were added
+     */
+    std::vector<Distribution> run(int numScenarios, uint64_t seed = 1, unsigned int numThreads = 0,
+                                  TaskControl* control = nullptr) const;
+};
+
+#endif // FEUP_DA1_FAILURESIMULATION_H
@@ -0,0 +1,274 @@
+#ifndef FEUP_DA1_FLOWNETWORK_H
+#define FEUP_DA1_FLOWNETWORK_H
+
+#include "Graph.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Compact index based structure of the railway network used by the flow engines
+ *
+ * @details Vertexes are numbered from 0 to n-1 and the arcs leaving each vertex are stored contiguously.
+ * Each link of the graph is stored as a pair of arcs, one the twin of the other, so the network is also its own
+ * residual graph. After construction the network is read-only and can be shared between threads.
+ */
+class NetworkTopology {
+private:
+    /**
+     * @brief Station name of each vertex
+     */
+    std::vector<std::string> _names;
+
+    /**
+     * @brief Index of each station name
+     */
+    std::unordered_map<std::string, int> _index;
+
+    /**
+     * @brief Arcs of vertex v are in [_first[v], _first[v+1])
+     */
+    std::vector<int> _first;
+
+    /**
+     * @brief Destination vertex of each arc
+     */
+    std::vector<int> _head;
+
+    /**
+     * @brief Twin (reverse) arc of each arc
+     */
+    std::vector<int> _twin;
+
+    /**
+     * @brief Service of each arc
+     */
+    std::vector<Service> _service;
+
+    /**
+     * @brief If each arc is an edge of the graph (and not only the twin of a one way edge)
+     */
+    std::vector<bool> _isEdge;
+
+protected:
+    /**
+     * @brief Construct a new Network Topology object from a graph
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param g Graph to take the structure of
+     * @param weights Filled with the weight of the graph edge of each arc (0 for the twin of a one way edge)
+     */
+    NetworkTopology(const Graph& g, std::vector<int>& weights);
+
+public:
+    /**
+     * @brief If the flows of a graph may not fit in an int, that is, if the sum of its capacities does not
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param g Graph
+     * @return true A 64 bit network is needed
+     * @return false A 32 bit network is enough
+     */
+    static bool needsWideCapacity(const Graph& g);
+
+    /**
+     * @brief Find the index of a station, if it does not exist return -1
+     *
+     * @details Time Complexity: O(1) on average
+     *
+     * @param stationName Name of the station
+     * @return int Vertex index
+     */
+    int findIndex(const std::string& stationName) const;
+
+    /**
+     * @brief Get the station name of a vertex
+     *
+     * @param v Vertex index
+     * @return const std::string& stationName
+     */
+    const std::string& getName(int v) const;
+
+    /**
+     * @brief Get the number of vertexes
+     *
+     * @return int Number of vertexes
+     */
+    int getNumVertex() const;
+
+    /**
+     * @brief Get the number of arcs (twins included)
+     *
+     * @return int Number of arcs
+     */
+    int getNumArcs() const;
+
+    /**
+     * @brief Get the first arc leaving a vertex
+     *
+     * @param v Vertex index
+     * @return int First arc of v
+     */
+    int arcsBegin(int v) const;
+
+    /**
+     * @brief Get the arc after the last arc leaving a vertex
+     *
+     * @param v Vertex index
+     * @return int One past the last arc of v
+     */
+    int arcsEnd(int v) const;
+
+    /**
+     * @brief Get the destination vertex of an arc
+     *
+     * @param arc Arc index
+     * @return int Destination vertex
+     */
+    int getHead(int arc) const;
+
+    /**
+     * @brief Get the twin (reverse) arc of an arc
+     *
+     * @param arc Arc index
+     * @return int Twin arc
+     */
+    int getTwin(int arc) const;
+
+    /**
+     * @brief Get the service of an arc
+     *
+     * @param arc Arc index
+     * @return Service Service of the edge of the arc
+     */
+    Service getService(int arc) const;
+
+    /**
+     * @brief If an arc is an edge of the graph, the twin of a one way edge is not
+     *
+     * @param arc Arc index
+     * @return true Arc is an edge
+     * @return false Arc only exists in the residual network
+     */
+    bool isEdge(int arc) const;
+
+    /**
+     * @brief Rank each vertex by the order a depth first search from a vertex reaches it
+     * Consecutive vertexes in this order are close to each other, so queries with the same source taken in this
+     * order can reuse most of the previous flow.
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param source Vertex where the search starts
+     * @return std::vector<int> Rank of each vertex, the vertexes not reached come last in index order
+     */
+    std::vector<int> depthFirstRanks(int source) const;
+};
+
+/**
+ * @brief Snapshot of the railway network with the capacity of each arc, used by the max flow engines
+ *
+ * @details Instantiated with int capacities (FlowNetwork), the fast path used by default, and with long long
+ * capacities (FlowNetwork64) for networks where the flows may not fit in an int.
+ */
+template <typename Capacity>
+class BasicFlowNetwork : public NetworkTopology {
+private:
+    /**
+     * @brief Capacity of each arc
+     */
+    std::vector<Capacity> _capacity;
+
+    /**
+     * @brief Construct a new Flow Network object from a graph, using a buffer for the arc weights
+     */
+    BasicFlowNetwork(const Graph& g, std::vector<int>&& weights);
+
+public:
+    /**
+     * @brief Ratio of the largest to the smallest capacity from which capacity scaling pays off
+     */
+    static constexpr long long SCALING_SPREAD = 1000;
+
+    /**
+     * @brief Construct a new Flow Network object from a graph
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param g Graph to take the snapshot of
+     */
+    explicit BasicFlowNetwork(const Graph& g);
+
+    /**
+     * @brief Get the capacity of an arc
+     *
+     * @param arc Arc index
+     * @return Capacity Capacity
+     */
+    Capacity getCapacity(int arc) const;
+
+    /**
+     * @brief If every arc has the same capacity as its twin, every link the same capacity both ways, as the flow
+     * equivalent tree (GomoryHuTree) needs
+     *
+     * @details Time Complexity: O(|E|)
+     *
+     * @return true Network is symmetric
+     * @return false Some link has a different capacity each way, or only one way
+     */
+    bool isSymmetric() const;
+
+    /**
+     * @brief If capacity scaling should take fewer augmentations than plain Edmonds-Karp, that is, if the largest
+     * capacity is at least SCALING_SPREAD times the smallest one. With a narrower spread the Δ phases find the same
+     * paths as plain Edmonds-Karp and each one still ends with a full search (bench_capacity_scaling).
+     *
+     * @details Time Complexity: O(|E|)
+     *
+     * @return true Use capacity scaling
+     * @return false Use plain Edmonds-Karp
+     */
+    bool prefersCapacityScaling() const;
+
+    /**
+     * @brief Get the terminal stations (with a single connection) that can reach a station, the sources of the
+     * trains arriving at it
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param target Vertex index of the station
+     * @return std::vector<int> Vertex indexes of the terminal stations, in index order
+     */
+    std::vector<int> arrivalSources(int target) const;
+
+    /**
+     * @brief Find the maximum flow of many pairs of stations
+     * Queries are grouped by source and the groups are solved in parallel, each thread reusing its own solver.
+     *
+     * @details Time Complexity: O(Q|V||E|²/T) where Q is the number of queries and T the number of threads
+     *
+     * @param queries Pairs of (source, destination) vertex indexes
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @return std::vector<Capacity> max_flow of each query in request order, -1 if error (input or flow network is not valid)
+     */
+    std::vector<Capacity> maxFlowBatch(const std::vector<std::pair<int, int>>& queries, unsigned int numThreads = 0) const;
+};
+
+/**
+ * @brief Flow network with 32 bit capacities and flows
+ */
+using FlowNetwork = BasicFlowNetwork<int>;
+
+/**
+ * @brief Flow network with 64 bit capacities and flows
+ */
+using FlowNetwork64 = BasicFlowNetwork<long long>;
+
+extern template class BasicFlowNetwork<int>;
+extern template class BasicFlowNetwork<long long>;
+
+#endif // FEUP_DA1_FLOWNETWORK_H
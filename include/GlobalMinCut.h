@@ -0,0 +1,119 @@
+#ifndef FEUP_DA1_GLOBALMINCUT_H
+#define FEUP_DA1_GLOBALMINCUT_H
+
+#include "Graph.h"
+#include "TaskControl.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Global minimum cut of the railway network: the connections with the least capacity whose loss splits it
+ *
+ * @details Stoer-Wagner algorithm over the undirected view of the graph, where a link weighs its capacity (both
+ * one-way links between two stations add up) and links without capacity don't join stations. Each phase orders the
+ * stations by maximum adjacency with an IndexedHeap, the last two give a cut and are merged, so |V|-1 phases find
+ * the minimum without any max flow. Before the phases, the links at least as heavy as the lightest station are
+ * contracted, as no lighter cut can cross them. Each connected component is cut on its own.
+ */
+class GlobalMinCut {
+public:
+    /**
+     * @brief Cut of the network in two sides
+     */
+    struct Cut {
+        /**
+         * @brief Capacity of the links between the sides, -1 if there is no cut
+         */
+        long long value;
+
+        /**
+         * @brief Stations of the smaller side, then of the other side
+         */
+        std::vector<std::string> side, otherSide;
+
+        /**
+         * @brief Links between the sides, from side to otherSide
+         */
+        std::vector<std::pair<std::string, std::string>> links;
+    };
+
+private:
+    /**
+     * @brief Name of each station
+     */
+    std::vector<std::string> _names;
+
+    /**
+     * @brief Neighbours of each station and the weight of the links to them (parallel links are merged)
+     */
+    std::vector<std::vector<std::pair<int, long long>>> _adj;
+
+    /**
+     * @brief Stations of each connected component, from the largest
+     */
+    std::vector<std::vector<int>> _components;
+
+    /**
+     * @brief Position of each station in its component
+     */
+    std::vector<int> _localIndex;
+
+    /**
+     * @brief Minimum cut of a connected component
+     *
+     * @param component Stations of the component, at least 2
+     * @param control Progress of the phases, if cancelled the cut is not valid (optional)
+     * @return Cut Minimum cut
+     */
+    Cut cutComponent(const std::vector<int>& component, TaskControl* control) const;
+
+    /**
+     * @brief Fill the links of a cut and order its sides
+     *
+     * @param inSide If each station of the component is on the side, by its position in the component
+     * @param component Stations of the component
+     * @param cut Cut with the value set
+     */
+    void describe(const std::vector<bool>& inSide, const std::vector<int>& component, Cut& cut) const;
+
+public:
+    /**
+     * @brief Construct a new Global Min Cut object
+     *
+     * @details Time Complexity: O(|V|+|E|log(|E|))
+     *
+     * @param g Graph of the railway network
+     */
+    explicit GlobalMinCut(const Graph& g);
+
+    /**
+     * @brief Get the number of connected components (a station without links is a component)
+     */
+    int getNumComponents() const;
+
+    /**
+     * @brief Find the minimum cut of the whole network
+     *
+     * @details Time Complexity: O(|V||E|log(|V|)), or O(|V|+|E|) if the network is already split
+     *
+     * @param control Progress of the phases, if cancelled the value is -1 (optional)
+     * @return Cut Minimum cut, with value 0 and the smallest component as side if the network is already split,
+     * value -1 if there are less than 2 stations
+     */
+    Cut minCut(TaskControl* control = nullptr) const;
+
+    /**
+     * @brief Find the minimum cut of each connected component with more than one station
+     *
+     * @details Time Complexity: O(Σ|Vc||Ec|log(|Vc|)/T) over the components c, T the number of threads
+     *
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the phases, if cancelled only the components cut so far are returned (optional)
+     * @return std::vector<Cut> Minimum cut of each component, from the largest component
+     */
+    std::vector<Cut> componentCuts(unsigned int numThreads = 0, TaskControl* control = nullptr) const;
+};
+
+#endif // FEUP_DA1_GLOBALMINCUT_H
@@ -0,0 +1,122 @@
+#ifndef FEUP_DA1_GOMORYHUTREE_H
+#define FEUP_DA1_GOMORYHUTREE_H
+
+#include "FlowNetwork.h"
+#include "TaskControl.h"
+
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Flow equivalent tree of a symmetric network (Gusfield's variant of the Gomory-Hu tree)
+ *
+ * @details The maximum flow between any two vertexes is the minimum weight in the tree path between them,
+ * so all the |V|² pair flows are represented by only |V|-1 max flow computations.
+ * The network must be symmetric (every link has the same capacity both ways), like the railway network.
+ * The tree can be built from a 32 or 64 bit network, its weights are always 64 bit.
+ */
+class GomoryHuTree {
+private:
+    /**
+     * @brief Parent of each vertex in the tree, -1 for the root
+     */
+    std::vector<int> _parent;
+
+    /**
+     * @brief Weight of the tree edge between each vertex and its parent
+     */
+    std::vector<long long> _weight;
+
+    /**
+     * @brief Number of vertexes whose tree edge is final, all but the root when the tree is complete
+     */
+    int _numFinal = 0;
+
+public:
+    /**
+     * @brief Build the tree of a network
+     *
+     * @details Time Complexity: O(|V|²|E|²)
+     *
+     * @param network Symmetric flow network
+     * @param control Progress of the |V|-1 max flows, if cancelled the tree is left incomplete (optional)
+     */
+    template <typename Capacity>
+    explicit GomoryHuTree(const BasicFlowNetwork<Capacity>& network, TaskControl* control = nullptr);
+
+    /**
+     * @brief Rebuild a complete tree from its parents and weights, as kept in a cache file
+     *
+     * @param parent Parent of each vertex, -1 for the root (vertex 0), every other parent is a smaller vertex
+     * @param weight Weight of the tree edge of each vertex
+     */
+    GomoryHuTree(std::vector<int> parent, std::vector<long long> weight);
+
+    /**
+     * @brief Get the number of vertexes of the tree
+     */
+    int getNumVertex() const;
+
+    /**
+     * @brief If every tree edge was computed, a cancelled construction leaves only the edges of the vertexes
+     * 1..getNumFinal() final (each weight is the max flow between the vertex and its parent)
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Get the number of vertexes whose tree edge is final, they are the vertexes 1..getNumFinal()
+     */
+    int getNumFinal() const;
+
+    /**
+     * @brief Get the parent of a vertex in the tree
+     *
+     * @param v Vertex index
+     * @return int Parent vertex or -1 for the root
+     */
+    int getParent(int v) const;
+
+    /**
+     * @brief Get the weight of the tree edge between a vertex and its parent
+     *
+     * @param v Vertex index
+     * @return long long Weight (0 for the root)
+     */
+    long long getWeight(int v) const;
+
+    /**
+     * @brief Get the maximum flow between two vertexes
+     *
+     * @details Time Complexity: O(|V|)
+     *
+     * @param source Source vertex index
+     * @param dest Destination vertex index
+     * @return long long max_flow (0 if there is no flow)
+     */
+    long long maxFlow(int source, int dest) const;
+
+    /**
+     * @brief Get, for each vertex, the sum of the maximum flow between it and every other vertex
+     *
+     * @details Time Complexity: O(|V|log(|V|))
+     *
+     * @return std::vector<long long> Sum of the max flows of each vertex, the largest long long if it does not fit
+     */
+    std::vector<long long> sumOfMaxFlows() const;
+
+    /**
+     * @brief Get the ordered pairs of vertexes with the largest max flow, the pairs joined only by tree edges of the
+     * largest weight
+     *
+     * @details Time Complexity: O(|V|+P) where P is the number of pairs
+     *
+     * @return std::vector<std::pair<int, int>> Pairs (source, destination) by source and then destination, empty if
+     * no pair has flow
+     */
+    std::vector<std::pair<int, int>> maxFlowPairs() const;
+};
+
+extern template GomoryHuTree::GomoryHuTree(const BasicFlowNetwork<int>& network, TaskControl* control);
+extern template GomoryHuTree::GomoryHuTree(const BasicFlowNetwork<long long>& network, TaskControl* control);
+
+#endif // FEUP_DA1_GOMORYHUTREE_H
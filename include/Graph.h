@@ -1,20 +1,172 @@
 #ifndef FEUP_DA1_GRAPH_H
 #define FEUP_DA1_GRAPH_H
 
+#include "TaskControl.h"
 #include "VertexEdge.h"
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+class AllPairsFlows;
+
 /**
  * @brief Railway network
  */
 class Graph {
 private:
+    friend class AdjacencyStorage;
+
     /**
      * @brief Vector of graph vertexes
      */
     std::vector<Vertex *> vertexSet;
 
+    /**
+     * @brief Vertex of each station name
+     */
+    std::unordered_map<std::string, Vertex *> _vertexIndex;
+
+    /**
+     * @brief Epoch of the current traversal, vertexes visited in it are marked with it
+     */
+    mutable unsigned int _visitEpoch = 0;
+
+    /**
+     * @brief Epoch of the last dijkstra, distances set by it are marked with it
+     */
+    mutable unsigned int _distanceEpoch = 0;
+
+    /**
+     * @brief Epoch of the current flow, edge flows set in it are marked with it (others count as 0)
+     */
+    mutable unsigned int _flowEpoch = 0;
+
+    /**
+     * @brief Source of the flow left in the edges by the last edmondsKarp, nullptr if there is no valid flow
+     */
+    mutable Vertex* _flowSource = nullptr;
+
+    /**
+     * @brief Destination of the flow left in the edges by the last edmondsKarp
+     */
+    mutable Vertex* _flowDest = nullptr;
+
+    /**
+     * @brief Max flow of every pair of stations (as a flow equivalent tree), shared by the analyses (and the copies)
+     * until the graph changes
+     */
+    mutable std::shared_ptr<const AllPairsFlows> _allPairsFlows;
+
+    /**
+     * @brief Protects _allPairsFlows, the analyses may run from many threads
+     */
+    mutable std::mutex _allPairsMutex;
+
+    /**
+     * @brief Directory of the cache files of the pair flows, empty to not use files
+     */
+    std::string _cacheDirectory;
+
+    /**
+     * @brief Change to the stations or links, kept in the journal to be undone
+     */
+    struct Change {
+        enum class Type {
+            ADD_VERTEX,
+            REMOVE_VERTEX,
+            ADD_EDGE,
+            REMOVE_EDGE,
+            SET_WEIGHT
+        };
+
+        Type type;
+
+        /**
+         * @brief Added or removed vertex
+         */
+        Vertex* vertex;
+
+        /**
+         * @brief Added, removed or changed edge
+         */
+        Edge* edge;
+
+        /**
+         * @brief Positions the removed vertex had in the vertex set, or the removed edge in the adjacency list of
+         * its origin and in the incomming edges of its destination
+         */
+        std::pair<size_t, size_t> positions;
+
+        /**
+         * @brief Weight of the changed edge before the change
+         */
+        int weight;
+    };
+
+    /**
+     * @brief Changes made since the first checkpoint, removed vertexes and edges are kept in it until committed
+     */
+    std::vector<Change> _journal;
+
+    /**
+     * @brief If changes are being kept in the journal (there is a checkpoint)
+     */
+    bool _journaling = false;
+
+    /**
+     * @brief Forget the results that depend on the stations and links, called when they change
+     */
+    void invalidateResults();
+
+    /**
+     * @brief Keep a change in the journal if there is a checkpoint
+     *
+     * @param change Change
+     * @return true Change was kept
+     * @return false There is no checkpoint, removed vertexes and edges can be deleted
+     */
+    bool journal(const Change& change);
+
+    /**
+     * @brief Remove an edge, its reverse edge loses the link to it
+     *
+     * @details Time Complexity: O(deg)
+     *
+     * @param edge Edge
+     */
+    void removeEdge(Edge* edge);
+
+    /**
+     * @brief Undo a change of the journal, the changes after it must have been undone
+     *
+     * @details Time Complexity: O(1), O(deg) for added edges
+     *
+     * @param change Change
+     */
+    void undo(const Change& change);
+
+    /**
+     * @brief Start a new traversal, all vertexes become unvisited
+     * 
+     * @details Time Complexity: O(1) (O(|V|) once every 2³² traversals)
+     * 
+     * @return unsigned int Epoch of the new traversal
+     */
+    unsigned int newVisitEpoch() const;
+
+    /**
+     * @brief Start a new dijkstra, all distances become infinite
+     * 
+     * @details Time Complexity: O(1) (O(|V|) once every 2³² searches)
+     * 
+     * @return unsigned int Epoch of the new search
+     */
+    unsigned int newDistanceEpoch() const;
+
 public:
     /**
      * @brief Construct a new Graph object
@@ -23,15 +175,30 @@ public:
 
     /**
      * @brief Copy constructor for graph
+     *
+     * @details Time Complexity: O(V+E). The copy has the same vertex, adjacency and incomming edge order and reverse
+     * edges, and shares the stations of g (a station is only copied when it is set in one of the graphs).
      * 
      * @param g Graph to copy
      */
     Graph(const Graph& g);
 
+    /**
+     * @brief Read the stations and the network from csv files, adding them to the graph
+     * 
+     * @details Time Complexity: O(n+m) where n is the number of lines in the stations file and m is the number of lines in the network file.
+     * 
+     * @param stationsFile Path of the stations csv file
+     * @param networkFile Path of the network csv file
+     * @return true Files were read
+     * @return false A file could not be opened
+     */
+    bool readData(const std::string& stationsFile, const std::string& networkFile);
+
     /**
      * @brief Find a vertex in the graph with the given id, if it does not exists return nullptr
      * 
-     * @details Time Complexity: O(|V|)
+     * @details Time Complexity: O(1) on average
      * 
      * @param stationName Vertex stationName
      * @return Vertex* vertex
@@ -48,8 +215,10 @@ public:
     bool addVertex(const Station& station);
 
     /**
-     * @brief Remove a vertex from the graph
+     * @brief Remove a vertex and its edges from the graph, the last vertex of the vertex set takes its place
      * 
+     * @details Time Complexity: O(sum of the degrees of the vertex and its neighbours)
+     *
      * @param station_name Name of the station to remove
      * @return true Vertex was removed
      * @return false Vertex was not found
@@ -80,6 +249,62 @@ public:
      */
     bool addBidirectionalEdge(const std::string& source, const std::string& dest, int weight, const std::string& service);
 
+    /**
+     * @brief Remove the edges from source to destination vertex, the edges the other way stay (without reverse)
+     *
+     * @details Time Complexity: O(deg(source)+deg(dest))
+     *
+     * @param source Source vertex
+     * @param dest Destination Vertex
+     * @return true Edges were removed
+     * @return false Source or destination vertex or the edge does not exist
+     */
+    bool removeEdge(const std::string& source, const std::string& dest);
+
+    /**
+     * @brief Set the weight of the edges from source to destination vertex
+     *
+     * @details Time Complexity: O(deg(source))
+     *
+     * @param source Source vertex
+     * @param dest Destination Vertex
+     * @param weight New weight
+     * @return true Weight was set
+     * @return false Source or destination vertex or the edge does not exist, or the weight is negative
+     */
+    bool setEdgeWeight(const std::string& source, const std::string& dest, int weight);
+
+    /**
+     * @brief Mark the current stations and links, the changes made after it can be rolled back
+     *
+     * @details Changes are kept in a journal from the first checkpoint until they are committed, checkpoints can be
+     * nested (rolling back to one also discards the ones after it).
+     *
+     * Time Complexity: O(1)
+     *
+     * @return size_t Checkpoint
+     */
+    size_t checkpoint();
+
+    /**
+     * @brief Undo the changes made after a checkpoint
+     *
+     * @details Time Complexity: O(number of changes undone), removals are put back at their old positions so the
+     * vertex and edge order is the same as in the checkpoint
+     *
+     * @param checkpoint Checkpoint returned by checkpoint()
+     * @return true Changes were undone
+     * @return false Checkpoint is not in the journal (it was committed or rolled back past)
+     */
+    bool rollback(size_t checkpoint);
+
+    /**
+     * @brief Keep the changes, deleting the removed vertexes and edges and forgetting every checkpoint
+     *
+     * @details Time Complexity: O(number of changes)
+     */
+    void commitChanges();
+
     /**
      * @brief Find an augmenting path in the graph using BFS
      * 
@@ -87,52 +312,182 @@ public:
      * 
      * @param source Source vertex
      * @param dest Destination Vertex
+     * @param delta Minimum residual capacity of the edges in the path
      * @return true Found augmenting path
      * @return false No augmenting path
      */
-    bool findAugmentingPath(Vertex *source, Vertex *dest) const;
+    bool findAugmentingPath(Vertex *source, Vertex *dest, int delta = 1) const;
+
+    /**
+     * @brief Set the flow of every edge to 0
+     * 
+     * @details Time Complexity: O(1) (O(|E|) once every 2³² resets)
+     */
+    void resetFlow() const;
+
+    /**
+     * @brief Get the flow of an edge in the current flow
+     * 
+     * @param e Edge
+     * @return int Edge flow
+     */
+    int getFlow(const Edge* e) const;
 
     /**
      * @brief Find the maximum flow between source and destination vertex using Edmonds-Karp algorithm
      * Used to calculate the maximum number of trains that can simultaneously travel between two stations
      * 
-     * @details Time Complexity: O(|V||E|²)
+     * With capacity scaling, only paths with residual capacity of at least Δ are used, halving Δ each phase until
+     * it is 1, which avoids many tiny augmentations when capacities are very different (e.g. unlimited super edges).
+     * 
+     * With warm start, if the last call had the same source (and the flow was not consumed by decomposeFlow or
+     * changed by removing vertexes), its flow is kept: the flow that reached the previous destination is sent back
+     * and only the missing paths are searched.
+     * 
+     * @details Time Complexity: O(|V||E|²), or O(|E|²log(U)) with capacity scaling where U is the largest capacity
      * 
      * @param source Source vertex
      * @param dest Destination Vertex
+     * @param capacityScaling Use capacity scaling
+     * @param warmStart Start from the flow of the last call if it had the same source
      * @return int max_flow or -1 if error (input or flow network is not valid)
      */
-    int edmondsKarp(const std::string& source, const std::string& dest) const;
+    int edmondsKarp(
+        const std::string& source,
+        const std::string& dest,
+        bool capacityScaling = false,
+        bool warmStart = false
+    ) const;
+
+    /**
+     * @brief Find the maximum flow of many pairs of stations
+     * Station names are resolved once and every query runs on a shared index based snapshot of the graph,
+     * queries with the same source are solved together and the sources are distributed between threads.
+     * The snapshot uses 32 bit flows unless the flows of the graph may not fit in an int.
+     * 
+     * @details Time Complexity: O(|V|+|E|+Q|V||E|²/T) where Q is the number of queries and T the number of threads
+     * 
+     * @param queries Pairs of (source, destination) station names
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @return std::vector<long long> max_flow of each query in request order, -1 if error (input or flow network is not valid)
+     */
+    std::vector<long long> edmondsKarpBatch(
+        const std::vector<std::pair<std::string, std::string>>& queries,
+        unsigned int numThreads = 0
+    ) const;
+
+    /**
+     * @brief Decompose the flow left in the edges by edmondsKarp into paths from source to destination
+     * Each path is a route of trains between the two stations, circulations found along the way are cancelled.
+     * The path vector given to the callback is reused between calls, so no intermediate list of paths is built.
+     * Should be called right after edmondsKarp with the same stations, the flow in the edges is consumed.
+     * 
+     * @details Time Complexity: O(|E|·P) where P is the number of paths
+     * 
+     * @param source Source vertex
+     * @param dest Destination Vertex
+     * @param callback Function called for each path with its stations (from source to destination) and number of trains
+     * @return int Number of paths found or -1 if error (input is not valid)
+     */
+    int decomposeFlow(
+        const std::string& source,
+        const std::string& dest,
+        const std::function<void(const std::vector<Vertex *>&, int)>& callback
+    ) const;
 
     /**
      * @brief Get the pair of stations that require the maximum number of trains to travel between them
+     * The pair flows are shared with the other analyses, see getAllPairsFlows. When some link does not have the same
+     * capacity both ways (a scenario removed one direction), the tree does not apply and every ordered pair is solved.
      * 
-     * @details Time Complexity: O(|V|³|E|²)
+     * @details Time Complexity: O(|V|²|E|²), O(|V|+P) when the pair flows are cached where P is the number of pairs,
+     * O(|V|³|E|²) when not symmetric
      * 
-     * @return std::vector<std::pair<std::pair<std::string, std::string>, int>> Vector of pairs of stations and the maximum number
+     * @param control Progress of the computation, if cancelled the best pairs among the ones computed are returned
+     * (optional)
+     * @return std::vector<std::pair<std::pair<std::string, std::string>, long long>> Vector of pairs of stations and the maximum number
      * of trains that can simultaneously travel between them
      */
-    std::vector<std::pair<std::pair<std::string, std::string>, int>> getMaxTrainCapacityPairs() const;
+    std::vector<std::pair<std::pair<std::string, std::string>, long long>> getMaxTrainCapacityPairs(
+        TaskControl* control = nullptr
+    ) const;
+
+    /**
+     * @brief Set the directory where the pair flows are cached between runs, created when needed
+     *
+     * @param directory Directory, empty to not use cache files
+     */
+    void setCacheDirectory(const std::string& directory);
+
+    /**
+     * @brief Get the max flow of every pair of stations, indexed by the position of the stations in the vertex set
+     * The flows are a flow equivalent (Gomory-Hu) tree, computed once and kept until the graph changes. With a cache
+     * directory, the tree is read from the cache file of the network (identified by a fingerprint of its content)
+     * when there is one, or written to it. The tree needs every link to have the same capacity both ways, otherwise
+     * nothing is computed or kept.
+     *
+     * @details Time Complexity: O(|V|+|E|) when cached, O(|V|²|E|²) otherwise
+     *
+     * @param control Progress of the computation, if cancelled nothing is kept (optional)
+     * @param computed If cancelled, filled with the pairs of stations (positions in the vertex set) whose max flow
+     * was computed and their flow (optional)
+     * @return std::shared_ptr<const AllPairsFlows> Pair flows, nullptr if cancelled or the network is not symmetric
+     */
+    std::shared_ptr<const AllPairsFlows> getAllPairsFlows(
+        TaskControl* control = nullptr,
+        std::vector<std::pair<std::pair<int, int>, long long>>* computed = nullptr
+    ) const;
 
     /**
      * @brief Find the top k municipalities and districts with the most inportance in the network
      * Using the flow centrality criteria, find the most important municipalities and districts in the network
      * by calculating the sum of the maximum flow between all pairs of stations in the municipality/district.
+     * The pair flows are taken from a flow equivalent (Gomory-Hu) tree, so only |V|-1 max flows are computed,
+     * and shared with the other analyses (see getAllPairsFlows). When some link does not have the same capacity both
+     * ways, the flows from each station to every other one are solved instead.
+     * Alternatively, the importance can be the sum of the max flow between the region and every other region,
+     * each computed at once from all the stations of one region to all the stations of the other.
+     * 
+     * Ties are ordered by name.
      * 
-     * @details Time Complexity: O(|V|³|E|²)
+     * @details Time Complexity: O(|V|²|E|²), or O(R²|V||E|²) for region pairs where R is the number of regions
      * 
      * @param k Number of municipalities/districts to find
      * @param municipalities Vector of pairs of municipality name and importance
      * @param districts Vector of pairs of district name and importance
+     * @param regionPairs Use the flow between pairs of regions instead of pairs of stations
+     * @param onProgress Called while the region pairs are solved with the provisional top k, if they are districts
+     * and the fraction done
+     * @param control Progress of the computation, if cancelled the region pairs give the top k of the pairs solved
+     * so far and the station pairs give nothing (optional)
      */
     void findTopMunicipalitiesAndDistricts(
         int k,
         std::vector<std::string> &municipalities,
-        std::vector<std::string> &districts
+        std::vector<std::string> &districts,
+        bool regionPairs = false,
+        const std::function<void(const std::vector<std::string>&, bool, double)>& onProgress = nullptr,
+        TaskControl* control = nullptr
     ) const;
 
+    /**
+     * @brief Find the maximum number of trains that can arrive simultaneously at a station
+     * Every terminal station (with a single connection) that can reach the station is a source of a multi source
+     * max flow, with capacity scaling only if the capacities are spread widely (FlowNetwork::prefersCapacityScaling),
+     * and with 64 bit flows if they may not fit in an int. The graph is not changed, so it can be called from many
+     * threads.
+     * 
+     * @details Time Complexity: O(|V||E|²), or O(|E|²log(U)) with capacity scaling where U is the largest capacity
+     * 
+     * @param stationName Name of the station
+     * @return int Maximum number of trains (the largest int if it does not fit), or -1 if the station does not exist
+     * or no train can arrive
+     */
+    int maxTrainsArriving(const std::string& stationName) const;
+
     /**
      * @brief Find the minimum cost path from source to all other vertexes using Dijkstra algorithm.
+     * A STANDARD trip costs 2 and an ALFA PENDULAR trip costs 4 (ServiceCost).
      * 
      * @details Time Complexity: O(|V|+|E|log(|V|))
      * 
@@ -140,6 +495,25 @@ public:
      */
     void dijkstra(Vertex *source);
 
+    /**
+     * @brief Get the cost from the source of the last dijkstra to a vertex
+     * 
+     * @param v Vertex
+     * @return int Cost, or the maximum int if the vertex was not reached
+     */
+    int getDistance(const Vertex* v) const;
+
+    /**
+     * @brief Get the number of trains that can travel along the path found by the last dijkstra to a vertex,
+     * the minimum capacity of its edges
+     * 
+     * @details Time Complexity: O(|V|)
+     * 
+     * @param v Vertex
+     * @return int Number of trains, the maximum int if the vertex is the source, or -1 if the vertex was not reached
+     */
+    int getPathCapacity(const Vertex* v) const;
+
     /**
      * @brief Get graph's number of vertexes
      * 
@@ -0,0 +1,409 @@
+#ifndef FEUP_DA1_GRAPHKERNELS_H
+#define FEUP_DA1_GRAPHKERNELS_H
+
+#include "CostPolicy.h"
+#include "GraphStorage.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <vector>
+
+/**
+ * @brief Graph algorithms written once over any storage of GraphStorage.h and specialised at compile time
+ * for each storage and cost or capacity policy
+ */
+namespace kernels {
+    /**
+     * @brief Find the minimum cost path from source to all other vertexes using Dijkstra algorithm.
+     * The distance and the arc used to reach each vertex are left in the storage.
+     *
+     * @details Time Complexity: O(|V|+|E|log(|V|))
+     *
+     * @param g Storage
+     * @param source Source vertex
+     */
+    template <typename CostPolicy, typename Storage>
+    void dijkstra(Storage& g, typename Storage::Node source) {
+        using Node = typename Storage::Node;
+        STATS_PHASE(SEARCH);
+        TRACE_SPAN("dijkstra", "cost");
+
+        // Ties are taken in the order they were queued, so the paths do not depend on the node handles
+        struct Item {
+            int distance;
+            unsigned int order;
+            Node node;
+        };
+        auto cmp = [](const Item& a, const Item& b) {
+            return a.distance != b.distance ? a.distance > b.distance : a.order > b.order;
+        };
+        std::priority_queue<Item, std::vector<Item>, decltype(cmp)> pq(cmp);
+        unsigned int order = 0;
+
+        g.newSearch();
+        g.newDistances();
+
+        g.setDistance(source, 0);
+        pq.push({0, order++, source});
+        STATS_ADD(heapPushes, 1);
+        while (!pq.empty()) {
+            Item item = pq.top(); pq.pop();
+            STATS_ADD(heapPops, 1);
+            Node u = item.node;
+            if (g.isVisited(u)) {
+                continue; // already settled with a smaller distance
+            }
+            g.setVisited(u);
+            STATS_ADD(vertexScans, 1);
+
+            g.forEachArc(u, [&](typename Storage::Arc a) {
+                STATS_ADD(edgeScans, 1);
+                Node v = g.getHead(a);
+                int distance = item.distance + CostPolicy::cost(g.getService(a));
+                if (!g.isVisited(v) && distance < g.getDistance(v)) {
+                    g.setDistance(v, distance);
+                    g.setParent(v, a);
+                    pq.push({distance, order++, v});
+                    STATS_ADD(heapPushes, 1);
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief Find the minimum cost path from source to destination, guided by a lower bound of the cost from each
+     * vertex to the destination (A*). The search stops when the destination is settled, the path is left in the
+     * parents of the storage.
+     *
+     * @details Time Complexity: O(|V|+|E|log(|V|)), usually much less with a tight bound
+     *
+     * @param g Storage
+     * @param source Source vertex
+     * @param dest Destination vertex
+     * @param bound Lower bound of the cost from a vertex to the destination, bound(v) <= cost(v, w) + bound(w)
+     * for every arc (0 for a plain dijkstra)
+     * @return int Cost of the path, the largest int if there is no path
+     */
+    template <typename CostPolicy, typename Storage, typename Bound>
+    int shortestPathTo(Storage& g, typename Storage::Node source, typename Storage::Node dest, Bound bound) {
+        using Node = typename Storage::Node;
+        STATS_PHASE(SEARCH);
+
+        // Ordered by the estimated cost of the whole path, ties in the order they were queued
+        struct Item {
+            int estimate;
+            unsigned int order;
+            Node node;
+        };
+        auto cmp = [](const Item& a, const Item& b) {
+            return a.estimate != b.estimate ? a.estimate > b.estimate : a.order > b.order;
+        };
+        std::priority_queue<Item, std::vector<Item>, decltype(cmp)> pq(cmp);
+        unsigned int order = 0;
+
+        g.newSearch();
+        g.newDistances();
+
+        g.setDistance(source, 0);
+        pq.push({bound(source), order++, source});
+        STATS_ADD(heapPushes, 1);
+        while (!pq.empty()) {
+            Item item = pq.top(); pq.pop();
+            STATS_ADD(heapPops, 1);
+            Node u = item.node;
+            if (g.isVisited(u)) {
+                continue;
+            }
+            g.setVisited(u);
+            STATS_ADD(vertexScans, 1);
+            if (u == dest) {
+                return g.getDistance(u);
+            }
+
+            int u_distance = g.getDistance(u);
+            g.forEachArc(u, [&](typename Storage::Arc a) {
+                STATS_ADD(edgeScans, 1);
+                Node v = g.getHead(a);
+                int distance = u_distance + CostPolicy::cost(g.getService(a));
+                if (!g.isVisited(v) && distance < g.getDistance(v)) {
+                    g.setDistance(v, distance);
+                    g.setParent(v, a);
+                    pq.push({distance + bound(v), order++, v});
+                    STATS_ADD(heapPushes, 1);
+                }
+            });
+        }
+        return std::numeric_limits<int>::max();
+    }
+
+    /**
+     * @brief Find a path from source to destination in the residual network using BFS,
+     * where every arc has at least the given residual capacity
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param g Storage
+     * @param source Source vertex
+     * @param dest Destination vertex
+     * @param delta Minimum residual capacity
+     * @param queue Workspace for the BFS queue
+     * @return true Path was found, it is left in the parents of the storage
+     * @return false There is no such path
+     */
+    template <typename CapacityPolicy, typename Storage>
+    bool findAugmentingPath(
+        Storage& g,
+        typename Storage::Node source,
+        typename Storage::Node dest,
+        typename Storage::Capacity delta,
+        std::vector<typename Storage::Node>& queue
+    ) {
+        g.newSearch();
+        g.setVisited(source);
+        queue.assign(1, source);
+
+        for (size_t head = 0; head < queue.size() && !g.isVisited(dest); head++) {
+            STATS_ADD(vertexScans, 1);
+            g.forEachResidualArc(queue[head], [&](typename Storage::Arc a) {
+                STATS_ADD(edgeScans, 1);
+                auto w = g.getHead(a);
+                if (!g.isVisited(w) && CapacityPolicy::capacity(g.getCapacity(a)) - g.getFlow(a) >= delta) {
+                    g.setVisited(w);
+                    g.setParent(w, a);
+                    queue.push_back(w);
+                }
+            });
+        }
+
+        return g.isVisited(dest);
+    }
+
+    /**
+     * @brief Augment the flow in the storage from source to destination until there is no augmenting path
+     * With capacity scaling, only paths with residual capacity of at least Δ are used, halving Δ each phase.
+     *
+     * @details Time Complexity: O(|V||E|²), or O(|E|²log(U)) with capacity scaling where U is the largest capacity
+     *
+     * @param g Storage
+     * @param source Source vertex
+     * @param dest Destination vertex
+     * @param capacityScaling Only augment along paths with large residual capacity first
+     * @return Capacity Flow added, the largest Capacity if it does not fit
+     */
+    template <typename CapacityPolicy, typename Storage>
+    typename Storage::Capacity augment(
+        Storage& g,
+        typename Storage::Node source,
+        typename Storage::Node dest,
+        bool capacityScaling = false
+    ) {
+        using Capacity = typename Storage::Capacity;
+        using Arc = typename Storage::Arc;
+
+        Capacity total_flow = 0;
+        Capacity delta = 1;
+
+        if (capacityScaling) {
+            // Start with the largest power of 2 that fits in an arc leaving the source and an arc reaching the destination
+            Capacity max_out = 0, max_in = 0;
+            g.forEachResidualArc(source, [&](Arc a) {
+                max_out = std::max(max_out, CapacityPolicy::capacity(g.getCapacity(a)));
+            });
+            g.forEachResidualArc(dest, [&](Arc a) {
+                max_in = std::max(max_in, CapacityPolicy::capacity(g.getCapacity(g.getTwin(a))));
+            });
+            Capacity max_capacity = std::min(max_out, max_in);
+            while (delta <= max_capacity / 2) {
+                delta *= 2;
+            }
+        }
+
+        std::vector<typename Storage::Node> queue;
+
+        for (; delta >= 1; delta /= 2) {
+            while (findAugmentingPath<CapacityPolicy>(g, source, dest, delta, queue)) {
+                STATS_ADD(augmentingPaths, 1);
+                Capacity path_flow = std::numeric_limits<Capacity>::max();
+
+                // Find the minimum residual capacity in the path
+                for (auto v = dest; v != source; v = g.getTail(g.getParent(v))) {
+                    Arc a = g.getParent(v);
+                    path_flow = std::min(path_flow, CapacityPolicy::capacity(g.getCapacity(a)) - g.getFlow(a));
+                }
+
+                // Update the flow in the path
+                for (auto v = dest; v != source; v = g.getTail(g.getParent(v))) {
+                    g.addFlow(g.getParent(v), path_flow);
+                }
+
+                if (!utils::checkedAdd(total_flow, path_flow)) {
+                    return total_flow; // saturated, the flow does not fit in Capacity
+                }
+            }
+        }
+
+        return total_flow;
+    }
+
+    /**
+     * @brief Find the maximum flow between source and destination vertex using Edmonds-Karp algorithm.
+     * The flow of every arc is left in the storage.
+     *
+     * @details Time Complexity: O(|V||E|²), or O(|E|²log(U)) with capacity scaling where U is the largest capacity
+     *
+     * @param g Storage
+     * @param source Source vertex
+     * @param dest Destination vertex
+     * @param capacityScaling Only augment along paths with large residual capacity first
+     * @return Capacity max_flow (0 if there is no flow), the largest Capacity if it does not fit
+     */
+    template <typename CapacityPolicy, typename Storage>
+    typename Storage::Capacity edmondsKarp(
+        Storage& g,
+        typename Storage::Node source,
+        typename Storage::Node dest,
+        bool capacityScaling = false
+    ) {
+        {
+            STATS_PHASE(RESET);
+            g.resetFlow();
+        }
+
+        STATS_PHASE(AUGMENT);
+        return augment<CapacityPolicy>(g, source, dest, capacityScaling);
+    }
+
+    /**
+     * @brief Get the flow leaving a vertex
+     *
+     * @details Time Complexity: O(degree of the vertex)
+     *
+     * @param g Storage
+     * @param source Vertex
+     * @return Capacity Net flow leaving the vertex, the largest Capacity if it does not fit
+     */
+    template <typename Storage>
+    typename Storage::Capacity flowValue(const Storage& g, typename Storage::Node source) {
+        typename Storage::Capacity value = 0;
+        g.forEachResidualArc(source, [&](typename Storage::Arc a) {
+            utils::checkedAdd(value, g.getFlow(a));
+        });
+        return value;
+    }
+
+    /**
+     * @brief Turn a flow from source to a previous destination into a flow from source to a new destination,
+     * sending the flow that reached the previous destination back through the arcs it used until it arrives at
+     * the source or at the new destination
+     *
+     * @details Time Complexity: O(P(|V|+|E|)) where P is the number of paths returned
+     *
+     * @param g Storage with a valid flow from source to previousDest
+     * @param source Source vertex
+     * @param previousDest Destination of the flow in the storage
+     * @param dest New destination
+     * @param queue Workspace for the BFS queue
+     * @return true The flow is now valid for the new destination
+     * @return false Some flow could not be returned (the flow in the storage was not valid)
+     */
+    template <typename Storage>
+    bool returnExcess(
+        Storage& g,
+        typename Storage::Node source,
+        typename Storage::Node previousDest,
+        typename Storage::Node dest,
+        std::vector<typename Storage::Node>& queue
+    ) {
+        using Capacity = typename Storage::Capacity;
+        using Arc = typename Storage::Arc;
+
+        Capacity excess = 0;
+        g.forEachResidualArc(previousDest, [&](Arc a) {
+            excess -= g.getFlow(a);
+        });
+
+        while (excess > 0) {
+            // Follow back the arcs with flow reaching the previous destination
+            g.newSearch();
+            g.setVisited(previousDest);
+            queue.assign(1, previousDest);
+
+            for (size_t head = 0; head < queue.size() && !g.isVisited(source) && !g.isVisited(dest); head++) {
+                STATS_ADD(vertexScans, 1);
+                g.forEachResidualArc(queue[head], [&](Arc a) {
+                    STATS_ADD(edgeScans, 1);
+                    auto w = g.getHead(a);
+                    if (!g.isVisited(w) && g.getFlow(a) < 0) {
+                        g.setVisited(w);
+                        g.setParent(w, a);
+                        queue.push_back(w);
+                    }
+                });
+            }
+
+            auto end = g.isVisited(dest) ? dest : source;
+            if (!g.isVisited(end)) {
+                return false;
+            }
+            STATS_ADD(augmentingPaths, 1);
+
+            Capacity path_flow = excess;
+            for (auto v = end; v != previousDest; v = g.getTail(g.getParent(v))) {
+                path_flow = std::min(path_flow, -g.getFlow(g.getParent(v)));
+            }
+            for (auto v = end; v != previousDest; v = g.getTail(g.getParent(v))) {
+                g.addFlow(g.getParent(v), path_flow);
+            }
+
+            excess -= path_flow;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Find the maximum flow between source and destination vertex using Edmonds-Karp algorithm,
+     * starting from the flow left in the storage by a query with the same source (warm start).
+     * Only the paths the previous flow does not already have are searched.
+     *
+     * @details Time Complexity: O(|V||E|²), usually much less augmentations than from zero flow
+     *
+     * @param g Storage with a valid flow from source to previousDest
+     * @param source Source vertex
+     * @param previousDest Destination of the flow in the storage
+     * @param dest Destination vertex
+     * @param capacityScaling Only augment along paths with large residual capacity first
+     * @return Capacity max_flow (0 if there is no flow), the largest Capacity if it does not fit
+     */
+    template <typename CapacityPolicy, typename Storage>
+    typename Storage::Capacity edmondsKarpWarm(
+        Storage& g,
+        typename Storage::Node source,
+        typename Storage::Node previousDest,
+        typename Storage::Node dest,
+        bool capacityScaling = false
+    ) {
+        std::vector<typename Storage::Node> queue;
+        bool returned;
+        {
+            STATS_PHASE(AUGMENT);
+            returned = previousDest == dest || returnExcess(g, source, previousDest, dest, queue);
+        }
+        if (!returned) {
+            // Outside of the phase above, edmondsKarp times its own reset and augment phases
+            return edmondsKarp<CapacityPolicy>(g, source, dest, capacityScaling);
+        }
+
+        STATS_PHASE(AUGMENT);
+        if (augment<CapacityPolicy>(g, source, dest, capacityScaling) == std::numeric_limits<typename Storage::Capacity>::max()) {
+            return std::numeric_limits<typename Storage::Capacity>::max();
+        }
+        return flowValue(g, source);
+    }
+}
+
+#endif // FEUP_DA1_GRAPHKERNELS_H
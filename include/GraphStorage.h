@@ -0,0 +1,476 @@
+#ifndef FEUP_DA1_GRAPHSTORAGE_H
+#define FEUP_DA1_GRAPHSTORAGE_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "VertexEdge.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+/*
+ * Storages give the algorithms in GraphKernels.h a common view of a graph and of the state they keep in it.
+ * They are not related by inheritance of an interface, the kernels are templates and every call is resolved
+ * (and inlined) at compile time. A storage provides:
+ *
+ *   Node, Arc, Capacity                  vertex and arc handles and the capacity type
+ *   forEachArc(v, f)                     calls f(arc) for every edge leaving v
+ *   forEachResidualArc(v, f)             calls f(arc) for every arc leaving v in the residual network
+ *   getHead(arc), getTail(arc)           vertexes of an arc
+ *   getTwin(arc)                         reverse arc in the residual network
+ *   getService(arc), getCapacity(arc)    service and capacity (0 if the arc only exists in the residual network)
+ *   newSearch(), isVisited(v), setVisited(v), getParent(v), setParent(v, arc)
+ *   newDistances(), getDistance(v), setDistance(v, distance)
+ *   resetFlow(), getFlow(arc), addFlow(arc, flow)   flow is antisymmetric, the twin gets the symmetric flow
+ */
+
+/**
+ * @brief Storage over the adjacency lists of a Graph, the state of the algorithms is kept in its vertexes and edges
+ */
+class AdjacencyStorage {
+public:
+    using Node = Vertex *;
+    using Capacity = int;
+
+    /**
+     * @brief Edge of the graph, or the edge reversed in the residual network
+     */
+    struct Arc {
+        Edge* edge;
+        bool reversed;
+    };
+
+private:
+    /**
+     * @brief Graph being viewed
+     */
+    const Graph& _graph;
+
+    /**
+     * @brief Epoch of the current search
+     */
+    unsigned int _visitEpoch;
+
+    /**
+     * @brief Epoch of the current distances
+     */
+    unsigned int _distanceEpoch;
+
+    /**
+     * @brief Epoch of the current flow
+     */
+    unsigned int _flowEpoch;
+
+public:
+    /**
+     * @brief Construct a new Adjacency Storage object, the current state of the graph is kept
+     *
+     * @param g Graph to view
+     */
+    explicit AdjacencyStorage(const Graph& g)
+        : _graph(g), _visitEpoch(g._visitEpoch), _distanceEpoch(g._distanceEpoch), _flowEpoch(g._flowEpoch) {}
+
+    int getNumVertex() const {
+        return _graph.getNumVertex();
+    }
+
+    template <typename Function>
+    void forEachArc(Node v, Function f) const {
+        for (auto e: v->getAdj()) {
+            f(Arc{e, false});
+        }
+    }
+
+    template <typename Function>
+    void forEachResidualArc(Node v, Function f) const {
+        for (auto e: v->getAdj()) {
+            f(Arc{e, false});
+        }
+        for (auto e: v->getIncomming()) {
+            f(Arc{e, true});
+        }
+    }
+
+    Node getHead(Arc arc) const {
+        return arc.reversed ? arc.edge->getOrigin() : arc.edge->getDest();
+    }
+
+    Node getTail(Arc arc) const {
+        return arc.reversed ? arc.edge->getDest() : arc.edge->getOrigin();
+    }
+
+    Arc getTwin(Arc arc) const {
+        return {arc.edge, !arc.reversed};
+    }
+
+    Service getService(Arc arc) const {
+        return arc.edge->getServiceType();
+    }
+
+    Capacity getCapacity(Arc arc) const {
+        return arc.reversed ? 0 : arc.edge->getWeight();
+    }
+
+    void newSearch() {
+        _visitEpoch = _graph.newVisitEpoch();
+    }
+
+    bool isVisited(Node v) const {
+        return v->isVisited(_visitEpoch);
+    }
+
+    void setVisited(Node v) {
+        v->setVisited(_visitEpoch);
+    }
+
+    Arc getParent(Node v) const {
+        Edge* e = v->getPath();
+        return {e, e->getDest() != v};
+    }
+
+    void setParent(Node v, Arc arc) {
+        v->setPath(arc.edge);
+    }
+
+    void newDistances() {
+        _distanceEpoch = _graph.newDistanceEpoch();
+    }
+
+    int getDistance(Node v) const {
+        return v->getDistance(_distanceEpoch);
+    }
+
+    void setDistance(Node v, int distance) {
+        v->setDistance(distance, _distanceEpoch);
+    }
+
+    void resetFlow() {
+        _graph.resetFlow();
+        _flowEpoch = _graph._flowEpoch;
+    }
+
+    Capacity getFlow(Arc arc) const {
+        int flow = arc.edge->getFlow(_flowEpoch);
+        return arc.reversed ? -flow : flow;
+    }
+
+    void addFlow(Arc arc, Capacity flow) {
+        arc.edge->setFlow(arc.edge->getFlow(_flowEpoch) + (arc.reversed ? -flow : flow), _flowEpoch);
+    }
+};
+
+/**
+ * @brief Storage over a flow network (compressed sparse rows), the state of the algorithms is kept in the storage
+ *
+ * @details The state is reset with epochs, so a storage can be reused by many queries without clearing it.
+ * Each thread needs its own storage, the network can be shared.
+ */
+template <typename CapacityType>
+class CsrStorage {
+public:
+    using Node = int;
+    using Arc = int;
+    using Capacity = CapacityType;
+
+protected:
+    /**
+     * @brief Network being viewed
+     */
+    const BasicFlowNetwork<Capacity>& _network;
+
+    /**
+     * @brief Search epoch that last visited each vertex
+     */
+    std::vector<unsigned int> _visited;
+
+    /**
+     * @brief Arc used to reach each visited vertex
+     */
+    std::vector<int> _parent;
+
+    /**
+     * @brief Distance of each vertex, only valid if marked with the distance epoch
+     */
+    std::vector<int> _distance;
+
+    /**
+     * @brief Distance epoch that last set the distance of each vertex
+     */
+    std::vector<unsigned int> _distanceMark;
+
+    /**
+     * @brief Flow of each arc, only valid if marked with the flow epoch
+     */
+    std::vector<Capacity> _flow;
+
+    /**
+     * @brief Flow epoch that last set the flow of each arc
+     */
+    std::vector<unsigned int> _flowMark;
+
+    unsigned int _visitEpoch = 0;
+    unsigned int _distanceEpoch = 0;
+    unsigned int _flowEpoch = 0;
+
+    /**
+     * @brief Start a new epoch, clearing the marks once when it wraps around
+     */
+    static void nextEpoch(unsigned int& epoch, std::vector<unsigned int>& marks) {
+        if (++epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
+        }
+    }
+
+public:
+    /**
+     * @brief Construct a new Csr Storage object
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param network Network to view
+     */
+    explicit CsrStorage(const BasicFlowNetwork<Capacity>& network)
+        : _network(network),
+          _visited(network.getNumVertex(), 0),
+          _parent(network.getNumVertex(), -1),
+          _distance(network.getNumVertex(), 0),
+          _distanceMark(network.getNumVertex(), 0),
+          _flow(network.getNumArcs(), 0),
+          _flowMark(network.getNumArcs(), 0) {}
+
+    int getNumVertex() const {
+        return _network.getNumVertex();
+    }
+
+    template <typename Function>
+    void forEachArc(Node v, Function f) const {
+        for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+            if (_network.isEdge(a)) {
+                f(a);
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEachResidualArc(Node v, Function f) const {
+        for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+            f(a);
+        }
+    }
+
+    Node getHead(Arc arc) const {
+        return _network.getHead(arc);
+    }
+
+    Node getTail(Arc arc) const {
+        return _network.getHead(_network.getTwin(arc));
+    }
+
+    Arc getTwin(Arc arc) const {
+        return _network.getTwin(arc);
+    }
+
+    Service getService(Arc arc) const {
+        return _network.getService(arc);
+    }
+
+    Capacity getCapacity(Arc arc) const {
+        return _network.getCapacity(arc);
+    }
+
+    void newSearch() {
+        nextEpoch(_visitEpoch, _visited);
+    }
+
+    bool isVisited(Node v) const {
+        return _visited[v] == _visitEpoch;
+    }
+
+    void setVisited(Node v) {
+        _visited[v] = _visitEpoch;
+    }
+
+    Arc getParent(Node v) const {
+        return _parent[v];
+    }
+
+    void setParent(Node v, Arc arc) {
+        _parent[v] = arc;
+    }
+
+    void newDistances() {
+        nextEpoch(_distanceEpoch, _distanceMark);
+    }
+
+    int getDistance(Node v) const {
+        return _distanceMark[v] == _distanceEpoch ? _distance[v] : std::numeric_limits<int>::max();
+    }
+
+    void setDistance(Node v, int distance) {
+        _distance[v] = distance;
+        _distanceMark[v] = _distanceEpoch;
+    }
+
+    void resetFlow() {
+        nextEpoch(_flowEpoch, _flowMark);
+    }
+
+    Capacity getFlow(Arc arc) const {
+        return _flowMark[arc] == _flowEpoch ? _flow[arc] : 0;
+    }
+
+    void addFlow(Arc arc, Capacity flow) {
+        int twin = _network.getTwin(arc);
+        _flow[arc] = getFlow(arc) + flow;
+        _flow[twin] = getFlow(twin) - flow;
+        _flowMark[arc] = _flowEpoch;
+        _flowMark[twin] = _flowEpoch;
+    }
+};
+
+/**
+ * @brief Storage over a flow network with a scenario on top of it: stations and links taken out of service
+ * and links with a different number of trains, without changing or copying the network
+ *
+ * @details Time Complexity: O(|V|+|E|) to build, every change is O(1)
+ */
+template <typename CapacityType>
+class OverlayStorage : public CsrStorage<CapacityType> {
+public:
+    using typename CsrStorage<CapacityType>::Node;
+    using typename CsrStorage<CapacityType>::Arc;
+    using typename CsrStorage<CapacityType>::Capacity;
+
+private:
+    /**
+     * @brief Vertexes out of service
+     */
+    std::vector<bool> _removedVertex;
+
+    /**
+     * @brief Arcs out of service
+     */
+    std::vector<bool> _removedArc;
+
+    /**
+     * @brief Capacity of each arc in the scenario
+     */
+    std::vector<Capacity> _capacity;
+
+public:
+    /**
+     * @brief Construct a new Overlay Storage object, with the network as it is
+     *
+     * @param network Network to view
+     */
+    explicit OverlayStorage(const BasicFlowNetwork<Capacity>& network)
+        : CsrStorage<Capacity>(network),
+          _removedVertex(network.getNumVertex(), false),
+          _removedArc(network.getNumArcs(), false),
+          _capacity(network.getNumArcs()) {
+        for (int a = 0; a < network.getNumArcs(); a++) {
+            _capacity[a] = network.getCapacity(a);
+        }
+    }
+
+    /**
+     * @brief Take a vertex out of service, no arc reaches it
+     *
+     * @param v Vertex index
+     */
+    void removeVertex(Node v) {
+        _removedVertex[v] = true;
+    }
+
+    /**
+     * @brief Take a link (an arc and its twin) out of service
+     *
+     * @param arc Arc index
+     */
+    void removeLink(Arc arc) {
+        _removedArc[arc] = true;
+        _removedArc[this->_network.getTwin(arc)] = true;
+    }
+
+    /**
+     * @brief Put a vertex back in service
+     *
+     * @param v Vertex index
+     */
+    void restoreVertex(Node v) {
+        _removedVertex[v] = false;
+    }
+
+    /**
+     * @brief Put a link (an arc and its twin) back in service
+     *
+     * @param arc Arc index
+     */
+    void restoreLink(Arc arc) {
+        _removedArc[arc] = false;
+        _removedArc[this->_network.getTwin(arc)] = false;
+    }
+
+    /**
+     * @brief If a vertex is out of service
+     */
+    bool isVertexRemoved(Node v) const {
+        return _removedVertex[v];
+    }
+
+    /**
+     * @brief If an arc is out of service
+     */
+    bool isArcRemoved(Arc arc) const {
+        return _removedArc[arc];
+    }
+
+    /**
+     * @brief Change the capacity of an arc
+     *
+     * @param arc Arc index
+     * @param capacity New capacity
+     */
+    void setCapacity(Arc arc, Capacity capacity) {
+        _capacity[arc] = capacity;
+    }
+
+    /**
+     * @brief Put the network back as it is
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     */
+    void clearScenario() {
+        std::fill(_removedVertex.begin(), _removedVertex.end(), false);
+        std::fill(_removedArc.begin(), _removedArc.end(), false);
+        for (int a = 0; a < this->_network.getNumArcs(); a++) {
+            _capacity[a] = this->_network.getCapacity(a);
+        }
+    }
+
+    template <typename Function>
+    void forEachArc(Node v, Function f) const {
+        for (int a = this->_network.arcsBegin(v); a < this->_network.arcsEnd(v); a++) {
+            if (this->_network.isEdge(a) && !_removedArc[a] && !_removedVertex[this->_network.getHead(a)]) {
+                f(a);
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEachResidualArc(Node v, Function f) const {
+        for (int a = this->_network.arcsBegin(v); a < this->_network.arcsEnd(v); a++) {
+            if (!_removedArc[a] && !_removedVertex[this->_network.getHead(a)]) {
+                f(a);
+            }
+        }
+    }
+
+    Capacity getCapacity(Arc arc) const {
+        return _capacity[arc];
+    }
+};
+
+#endif // FEUP_DA1_GRAPHSTORAGE_H
@@ -0,0 +1,209 @@
+#ifndef FEUP_DA1_INDEXEDHEAP_H
+#define FEUP_DA1_INDEXEDHEAP_H
+
+#include "Stats.h"
+
+#include <vector>
+
+/**
+ * @brief Max heap of the items 0..n-1 by key, that knows where each item is so its key can be increased in place
+ *
+ * @details A d-ary heap, 4 children per node by default: it is half as deep as a binary heap, so an increased key
+ * moves up fewer levels, and the children compared when popping are next to each other in memory. Unlike a
+ * std::priority_queue with lazy deletion, an item is never queued twice, so the heap never holds more than n items.
+ */
+template <typename Key, int Arity = 4>
+class IndexedHeap {
+private:
+    /**
+     * @brief Items in heap order
+     */
+    std::vector<int> _heap;
+
+    /**
+     * @brief Position of each item in the heap, -1 if it is not in the heap
+     */
+    std::vector<int> _position;
+
+    /**
+     * @brief Key of each item
+     */
+    std::vector<Key> _key;
+
+    /**
+     * @brief Move the item at a position up until its parent has a key not smaller
+     */
+    void siftUp(int i);
+
+    /**
+     * @brief Move the item at a position down until its children have keys not larger
+     */
+    void siftDown(int i);
+
+public:
+    /**
+     * @brief Construct a new empty Indexed Heap object
+     *
+     * @param numItems Number of items, they are 0..numItems-1
+     */
+    explicit IndexedHeap(int numItems = 0);
+
+    /**
+     * @brief Empty the heap and set the number of items
+     *
+     * @details Time Complexity: O(n)
+     */
+    void reset(int numItems);
+
+    /**
+     * @brief If the heap has no items
+     */
+    bool empty() const;
+
+    /**
+     * @brief Get the number of items in the heap
+     */
+    int size() const;
+
+    /**
+     * @brief If an item is in the heap
+     */
+    bool contains(int item) const;
+
+    /**
+     * @brief Get the key of an item in the heap
+     */
+    const Key& getKey(int item) const;
+
+    /**
+     * @brief Add an item that is not in the heap
+     *
+     * @details Time Complexity: O(log(n))
+     */
+    void push(int item, const Key& key);
+
+    /**
+     * @brief Increase the key of an item in the heap, a smaller key is ignored
+     *
+     * @details Time Complexity: O(log(n))
+     */
+    void increaseKey(int item, const Key& key);
+
+    /**
+     * @brief Remove the item with the largest key
+     *
+     * @details Time Complexity: O(log(n))
+     *
+     * @return int Item removed, the heap must not be empty
+     */
+    int pop();
+};
+
+template <typename Key, int Arity>
+IndexedHeap<Key, Arity>::IndexedHeap(int numItems) {
+    reset(numItems);
+}
+
+template <typename Key, int Arity>
+void IndexedHeap<Key, Arity>::reset(int numItems) {
+    _heap.clear();
+    _heap.reserve(numItems);
+    _position.assign(numItems, -1);
+    _key.assign(numItems, Key());
+}
+
+template <typename Key, int Arity>
+bool IndexedHeap<Key, Arity>::empty() const {
+    return _heap.empty();
+}
+
+template <typename Key, int Arity>
+int IndexedHeap<Key, Arity>::size() const {
+    return (int) _heap.size();
+}
+
+template <typename Key, int Arity>
+bool IndexedHeap<Key, Arity>::contains(int item) const {
+    return _position[item] != -1;
+}
+
+template <typename Key, int Arity>
+const Key& IndexedHeap<Key, Arity>::getKey(int item) const {
+    return _key[item];
+}
+
+template <typename Key, int Arity>
+void IndexedHeap<Key, Arity>::siftUp(int i) {
+    int item = _heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / Arity;
+        if (!(_key[_heap[parent]] < _key[item])) {
+            break;
+        }
+        _heap[i] = _heap[parent];
+        _position[_heap[i]] = i;
+        i = parent;
+    }
+    _heap[i] = item;
+    _position[item] = i;
+}
+
+template <typename Key, int Arity>
+void IndexedHeap<Key, Arity>::siftDown(int i) {
+    int item = _heap[i];
+    int n = (int) _heap.size();
+    while (true) {
+        int first = i * Arity + 1;
+        if (first >= n) {
+            break;
+        }
+
+        int largest = first;
+        for (int c = first + 1; c < first + Arity && c < n; c++) {
+            if (_key[_heap[largest]] < _key[_heap[c]]) {
+                largest = c;
+            }
+        }
+        if (!(_key[item] < _key[_heap[largest]])) {
+            break;
+        }
+        _heap[i] = _heap[largest];
+        _position[_heap[i]] = i;
+        i = largest;
+    }
+    _heap[i] = item;
+    _position[item] = i;
+}
+
+template <typename Key, int Arity>
+void IndexedHeap<Key, Arity>::push(int item, const Key& key) {
+    STATS_ADD(heapPushes, 1);
+    _key[item] = key;
+    _heap.push_back(item);
+    siftUp((int) _heap.size() - 1);
+}
+
+template <typename Key, int Arity>
+void IndexedHeap<Key, Arity>::increaseKey(int item, const Key& key) {
+    if (!(_key[item] < key)) {
+        return;
+    }
+    _key[item] = key;
+    siftUp(_position[item]);
+}
+
+template <typename Key, int Arity>
+int IndexedHeap<Key, Arity>::pop() {
+    STATS_ADD(heapPops, 1);
+    int item = _heap.front();
+    _position[item] = -1;
+    int last = _heap.back();
+    _heap.pop_back();
+    if (!_heap.empty()) {
+        _heap[0] = last;
+        siftDown(0);
+    }
+    return item;
+}
+
+#endif // FEUP_DA1_INDEXEDHEAP_H
@@ -0,0 +1,80 @@
+#ifndef FEUP_DA1_KSHORTESTPATHS_H
+#define FEUP_DA1_KSHORTESTPATHS_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "TaskControl.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The k cheapest loopless routes between two stations (ServiceCost), alternatives when the cheapest one is
+ * saturated
+ *
+ * @details Yen's algorithm: each route after the first leaves a route already found at a spur station, following
+ * it up to there (the root) and then taking the cheapest route that avoids the root stations and the next link of
+ * every route found with the same root. Only the stations from where a route left its parent are spurs (Lawler),
+ * and the spur searches of a route run in parallel.
+ * The searches reuse state instead of starting over: the cost from every station to the destination is found once,
+ * backwards, so a spur route is taken straight from that tree when it avoids the removed stations and links, and
+ * otherwise searched with it as an A* bound. Each thread keeps an OverlayStorage for all its searches, removing
+ * stations and links and putting them back without copying the network.
+ */
+class KShortestPaths {
+public:
+    /**
+     * @brief Route between the stations
+     */
+    struct Path {
+        /**
+         * @brief Stations of the route, from the origin to the destination
+         */
+        std::vector<std::string> stations;
+
+        /**
+         * @brief Cost of a train along the route
+         */
+        int cost;
+
+        /**
+         * @brief Trains that can travel along the route, the least capacity of its links
+         */
+        int capacity;
+    };
+
+private:
+    /**
+     * @brief Flow network of the graph
+     */
+    FlowNetwork _network;
+
+public:
+    /**
+     * @brief Construct a new K Shortest Paths object
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param g Graph of the railway network
+     */
+    explicit KShortestPaths(const Graph& g);
+
+    /**
+     * @brief Find the k cheapest loopless routes between two stations
+     *
+     * @details Time Complexity: O(kL(|V|+|E|log(|V|))/T) where L is the number of stations of a route and T the number
+     * of threads, spur routes taken from the tree cost O(L)
+     *
+     * @param source Origin station
+     * @param dest Destination station
+     * @param k Number of routes
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the routes, if cancelled the routes found so far are returned (optional)
+     * @return std::vector<Path> Routes from the cheapest (ties in the order of their links), fewer than k if there
+     * are no more, empty if a station does not exist, they are the same or there is no route
+     */
+    std::vector<Path> find(const std::string& source, const std::string& dest, int k, unsigned int numThreads = 0,
+                           TaskControl* control = nullptr) const;
+};
+
+#endif // FEUP_DA1_KSHORTESTPATHS_H
@@ -0,0 +1,127 @@
+#ifndef FEUP_DA1_LINKCRITICALITY_H
+#define FEUP_DA1_LINKCRITICALITY_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "TaskControl.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Loss of max flow caused by the failure of each single link, for a pair of stations or the arrivals at a
+ * station
+ *
+ * @details The max flow without failures is computed once. Links without flow in it can fail without loss, and a
+ * link crossing its minimum cut loses exactly its capacity, so neither is solved again. For the other links the
+ * flow is repaired instead of recomputed: the flow of the link is sent around it where possible, the rest is
+ * returned to the sources and the sinks, and then the flow is augmented. The links are evaluated in parallel.
+ */
+class LinkCriticality {
+public:
+    /**
+     * @brief Loss of a link
+     */
+    struct Link {
+        /**
+         * @brief Stations at the ends of the link
+         */
+        std::string origin, dest;
+
+        /**
+         * @brief Capacity from origin to destination
+         */
+        long long capacity;
+
+        /**
+         * @brief Max flow lost when the link fails
+         */
+        long long loss;
+    };
+
+private:
+    /**
+     * @brief Flow network of the graph, if its flows fit in an int
+     */
+    std::unique_ptr<FlowNetwork> _network;
+
+    /**
+     * @brief Flow network of the graph, if its flows need 64 bits
+     */
+    std::unique_ptr<FlowNetwork64> _wideNetwork;
+
+    /**
+     * @brief Get the network used
+     */
+    const NetworkTopology& topology() const;
+
+    /**
+     * @brief Loss of every link that loses flow, from a set of sources to a set of sinks
+     *
+     * @param network Flow network of the graph
+     * @param sources Source vertex indexes
+     * @param sinks Sink vertex indexes
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the links (optional)
+     * @return std::vector<Link> Links with loss, from the largest loss
+     */
+    template <typename Capacity>
+    std::vector<Link> rank(
+        const BasicFlowNetwork<Capacity>& network,
+        const std::vector<int>& sources,
+        const std::vector<int>& sinks,
+        unsigned int numThreads,
+        TaskControl* control
+    ) const;
+
+    /**
+     * @brief Rank the links with the network used
+     */
+    std::vector<Link> rank(const std::vector<int>& sources, const std::vector<int>& sinks, unsigned int numThreads,
+                           TaskControl* control) const;
+
+public:
+    /**
+     * @brief Construct a new Link Criticality object
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     * The 64 bit flow network is only used if the flows of the graph may not fit in an int.
+     *
+     * @param g Graph of the railway network
+     */
+    explicit LinkCriticality(const Graph& g);
+
+    /**
+     * @brief Rank the links by the max flow between two stations lost when each one fails
+     *
+     * @details Time Complexity: O(|V||E|² + C(|V|+|E|)A/T) where C is the number of links with flow that are not
+     * in the minimum cut, A the augmenting paths to repair each one and T the number of threads
+     *
+     * @param source Source station
+     * @param dest Destination station
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the links, if cancelled the links evaluated so far are ranked (optional)
+     * @return std::vector<Link> Links that lose flow, from the largest loss (ties in name order), empty if a station
+     * does not exist, they are the same or there is no flow
+     */
+    std::vector<Link> pairLinks(const std::string& source, const std::string& dest, unsigned int numThreads = 0,
+                                TaskControl* control = nullptr) const;
+
+    /**
+     * @brief Rank the links by the max number of trains arriving at a station lost when each one fails, from the
+     * terminal stations that reach it (Graph::maxTrainsArriving)
+     *
+     * @details Time Complexity: like pairLinks
+     *
+     * @param station Station
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param control Progress of the links, if cancelled the links evaluated so far are ranked (optional)
+     * @return std::vector<Link> Links that lose flow, from the largest loss (ties in name order), empty if the
+     * station does not exist or there is no flow
+     */
+    std::vector<Link> arrivalLinks(const std::string& station, unsigned int numThreads = 0,
+                                   TaskControl* control = nullptr) const;
+};
+
+#endif // FEUP_DA1_LINKCRITICALITY_H
@@ -0,0 +1,281 @@
+#ifndef FEUP_DA1_MAXFLOWSOLVER_H
+#define FEUP_DA1_MAXFLOWSOLVER_H
+
+#include "BitsetBFS.h"
+#include "FlowNetwork.h"
+#include "IndexedHeap.h"
+
+#include <vector>
+
+/**
+ * @brief Edmonds-Karp max flow solver over a flow network
+ *
+ * @details The solver owns the flow of every arc and its BFS workspace, so each thread needs its own solver.
+ * The workspace is allocated once and reused by every query.
+ * Instantiated with int flows (MaxFlowSolver) and long long flows (MaxFlowSolver64), like the networks.
+ * The batch engines use it rather than kernels::edmondsKarp on a CsrStorage: it takes several sources and sinks,
+ * warm starts from the previous flow, ignores failed arcs and reports the cut side, and with the queue search of
+ * BitsetBFS it is as fast as the kernel on the rail networks (bench_kernels, bench_verify).
+ */
+template <typename Capacity>
+class BasicMaxFlowSolver {
+private:
+    /**
+     * @brief Network being solved
+     */
+    const BasicFlowNetwork<Capacity>& _network;
+
+    /**
+     * @brief Flow of each arc (the twin arc has the symmetric flow), only valid if marked with the query epoch
+     */
+    std::vector<Capacity> _flow;
+
+    /**
+     * @brief Query epoch that last set the flow of each arc
+     */
+    std::vector<unsigned int> _flowEpoch;
+
+    /**
+     * @brief Epoch of the current query
+     */
+    unsigned int _queryEpoch = 0;
+
+    /**
+     * @brief Search for the augmenting paths
+     */
+    BitsetBFS _bfs;
+
+    /**
+     * @brief Source vertexes of the current query
+     */
+    std::vector<int> _sources;
+
+    /**
+     * @brief Sink vertexes of the current query
+     */
+    std::vector<int> _sinks;
+
+    /**
+     * @brief Sources of the query being asked, before they become the current ones
+     */
+    std::vector<int> _querySources;
+
+    /**
+     * @brief Sinks of the query being asked, before they become the current ones
+     */
+    std::vector<int> _querySinks;
+
+    /**
+     * @brief Sinks of the previous query, while their flow is returned
+     */
+    std::vector<int> _previousSinks;
+
+    /**
+     * @brief Targets of the paths that return the flow, the sources and the new sinks
+     */
+    std::vector<int> _returnTargets;
+
+    /**
+     * @brief Previous sink whose flow is being returned
+     */
+    std::vector<int> _returnSource;
+
+    /**
+     * @brief Widest residual path found to each vertex while choosing Δ
+     */
+    std::vector<Capacity> _width;
+
+    /**
+     * @brief Vertexes to visit in the widest path search, by width
+     */
+    IndexedHeap<Capacity> _widthHeap;
+
+    /**
+     * @brief Number of augmenting paths used by the last query
+     */
+    int _augmentations = 0;
+
+    /**
+     * @brief If a query with the same sources as the previous one starts from its flow
+     */
+    bool _warmStart = false;
+
+    /**
+     * @brief If the flow left by the previous query is a valid flow from its sources to its sinks
+     */
+    bool _warmValid = false;
+
+    /**
+     * @brief Arcs taken out of the network (capacity 0), nullptr if there are none
+     */
+    const std::vector<bool>* _failed = nullptr;
+
+    /**
+     * @brief Get the capacity of an arc, 0 if it failed
+     *
+     * @param arc Arc index
+     * @return Capacity Capacity
+     */
+    Capacity capacity(int arc) const;
+
+    /**
+     * @brief Start a new query, the flow of every arc becomes 0
+     *
+     * @details Time Complexity: O(1) (O(|E|) once every 2³² queries)
+     */
+    void newQuery();
+
+    /**
+     * @brief Add flow to an arc (and the symmetric flow to its twin)
+     *
+     * @param arc Arc index
+     * @param flow Flow to add
+     */
+    void addFlow(int arc, Capacity flow);
+
+    /**
+     * @brief Find an augmenting path from any source to any sink in the residual network using BitsetBFS::search
+     * (a queue BFS on sparse networks), where every arc has at least the given residual capacity
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param delta Minimum residual capacity
+     * @return int Sink reached or -1 if there is no such path
+     */
+    int findAugmentingPath(Capacity delta);
+
+    /**
+     * @brief Find the largest residual capacity of a path from the current sources to the current sinks
+     * (a Dijkstra that keeps the widest bottleneck instead of the shortest distance)
+     *
+     * @details Time Complexity: O(|E|log(|V|))
+     *
+     * @return Capacity Bottleneck of the widest path, 0 if there is no augmenting path
+     */
+    Capacity widestPath();
+
+    /**
+     * @brief Augment the flow from the current sources to the current sinks until there is no augmenting path
+     * With capacity scaling, only paths with residual capacity of at least Δ are used, halving Δ each phase
+     * until it is 1, so the large capacities are filled first by a few big augmentations. Δ starts at the
+     * largest power of 2 not above the widest path, so even with unlimited source arcs the first phase is not empty.
+     *
+     * @details Time Complexity: O(|V||E|²), or O(|E|²log(U)) with capacity scaling where U is the largest capacity
+     *
+     * @param capacityScaling Use capacity scaling
+     * @return Capacity Flow added, the largest Capacity if it does not fit
+     */
+    Capacity augment(bool capacityScaling);
+
+    /**
+     * @brief Turn the flow of the previous query into a valid flow from the sources to the new sinks,
+     * sending the flow that reached each previous sink (that is not a new sink) back through the arcs it used,
+     * until it arrives at a source or at a new sink
+     *
+     * @details Time Complexity: O(P(|V|+|E|)) where P is the number of paths returned
+     *
+     * @return true The flow is valid for the new sinks
+     * @return false Some flow could not be returned
+     */
+    bool returnExcess();
+
+    /**
+     * @brief Get the flow leaving the sources
+     *
+     * @details Time Complexity: O(sum of the degrees of the sources)
+     *
+     * @return Capacity Flow value, the largest Capacity if it does not fit
+     */
+    Capacity flowValue() const;
+
+public:
+    /**
+     * @brief Construct a new Max Flow Solver object
+     *
+     * @param network Network to solve
+     */
+    explicit BasicMaxFlowSolver(const BasicFlowNetwork<Capacity>& network);
+
+    /**
+     * @brief Start the queries with the same sources as the previous one from its flow instead of from zero flow
+     * Consecutive queries from one station then only search the paths the previous flow does not already have.
+     *
+     * @param warmStart Use warm starts
+     */
+    void setWarmStart(bool warmStart);
+
+    /**
+     * @brief Solve the next queries as if some arcs had capacity 0, without changing the network
+     * Used to evaluate failure scenarios with one shared network, the arcs of a failed link are both marked.
+     *
+     * @param failed If each arc failed, must be kept (and not changed) while used, nullptr to use every arc
+     */
+    void setFailedArcs(const std::vector<bool>* failed);
+
+    /**
+     * @brief Find the maximum flow between source and destination vertex using Edmonds-Karp algorithm
+     *
+     * @details Time Complexity: O(|V||E|²)
+     *
+     * @param source Source vertex index
+     * @param dest Destination vertex index
+     * @param capacityScaling Only augment along paths with large residual capacity first
+     * @return Capacity max_flow or -1 if error (input or flow network is not valid)
+     */
+    Capacity maxFlow(int source, int dest, bool capacityScaling = false);
+
+    /**
+     * @brief Find the maximum flow from a set of sources to a set of sinks
+     * Equivalent to adding a super source and a super sink linked to the sets with unlimited capacity,
+     * without changing the network.
+     *
+     * @details Time Complexity: O(|V||E|²)
+     *
+     * @param sources Source vertex indexes
+     * @param sinks Sink vertex indexes
+     * @param capacityScaling Only augment along paths with large residual capacity first
+     * @return Capacity max_flow or -1 if error (input or flow network is not valid)
+     */
+    Capacity maxFlow(const std::vector<int>& sources, const std::vector<int>& sinks, bool capacityScaling = false);
+
+    /**
+     * @brief If a vertex is on the source side of the minimum cut found by the last query
+     * (reachable from the sources in the residual network)
+     *
+     * @param v Vertex index
+     * @return true Vertex is on the source side
+     * @return false Vertex is on the sink side
+     */
+    bool isOnSourceSide(int v) const;
+
+    /**
+     * @brief Get the flow of an arc after the last query
+     *
+     * @param arc Arc index
+     * @return Capacity Arc flow
+     */
+    Capacity getFlow(int arc) const;
+
+    /**
+     * @brief Get the number of augmenting paths used by the last query, with the paths used to return the flow
+     * of a warm start
+     *
+     * @return int Number of augmentations
+     */
+    int getAugmentations() const;
+};
+
+/**
+ * @brief Max flow solver with 32 bit flows
+ */
+using MaxFlowSolver = BasicMaxFlowSolver<int>;
+
+/**
+ * @brief Max flow solver with 64 bit flows
+ */
+using MaxFlowSolver64 = BasicMaxFlowSolver<long long>;
+
+extern template class BasicMaxFlowSolver<int>;
+extern template class BasicMaxFlowSolver<long long>;
+
+#endif // FEUP_DA1_MAXFLOWSOLVER_H
@@ -2,7 +2,9 @@
 #define FEUP_DA1_MENU_H
 
 #include "Graph.h"
+#include "TaskControl.h"
 
+#include <functional>
 #include <string>
 
 /**
@@ -16,16 +18,6 @@ private:
      */
     Graph _graph;
 
-    /**
-     * @brief File name of station input in csv format
-     */
-    static const std::string STATIONS_INPUT;
-    
-    /**
-     * @brief File name of network input in csv format
-     */
-    static const std::string NETWORK_INPUT;
-
     /**
      * @brief Open and read the files
      * @details Time Complexity: O(n+m) where n is the number of lines in the stations file and m is the number of lines in the network file.
@@ -48,6 +40,17 @@ private:
      */
     void showVertexInfo(const Vertex* vertex) const;
 
+    /**
+     * @brief Run a long analysis in the background, showing its progress and time left on a terminal.
+     * A key press (on a terminal) or Ctrl+C asks the analysis to stop, it then leaves its partial results.
+     * 
+     * @param title Title shown while it runs
+     * @param work Analysis, reporting to the task control
+     * @return true Analysis finished
+     * @return false Analysis was cancelled
+     */
+    bool runTask(const std::string& title, const std::function<void(TaskControl&)>& work);
+
     /* Basic Service Metrics */
     /**
      * @brief Calculate the max number of trains that can travel at the same time between stations
@@ -68,15 +71,6 @@ private:
      */
     void topKMunicipalitiesAndDistricts();
 
-    /**
-     * @brief Calculate the maximum number of trains that can arrive simultaneously ate one station
-     * @details Time Complexity: O(|V|²|E|)
-     * 
-     * @param g Graph that is used to calculate
-     * @param station_name Name of the station
-     */
-    int maxTrainArrivingStationHelper(Graph& g, const std::string& station_name);
-
     /**
      * @brief Show the maximum number of trains that can arrive simultaneously ate one station
      * @details Time Complexity: O(|V|²|E|)
@@ -106,12 +100,68 @@ private:
      */
     void mostAffectedStations(Graph& g);
 
+    /**
+     * @brief Simulate random connection failures and show the distribution of the capacity lost between stations
+     * or arriving at stations
+     * @details Time Complexity: O(S·M|V||E|²/T) where S is the number of scenarios, M the number of measures and
+     * T the number of threads
+     * @param g Graph that is used to calculate
+     */
+    void failureSimulation(const Graph& g);
+
+    /**
+     * @brief Rank the connections by the trains lost between 2 stations, or arriving at a station, when each one fails
+     * @details Time Complexity: O(|V||E|² + L(|V|+|E|)A/T) where L is the number of connections with flow, A the
+     * augmenting paths to repair the flow without each one and T the number of threads
+     * @param g Graph that is used to calculate
+     */
+    void criticalConnections(const Graph& g);
+
+    /**
+     * @brief Show the connections with the least capacity whose loss splits the network, or each connected part of it
+     * @details Time Complexity: O(|V||E|log(|V|))
+     * @param g Graph that is used to calculate
+     */
+    void weakestSplit(const Graph& g);
+
+    /**
+     * @brief Plan the connection upgrades that raise the most the max number of trains between 2 stations,
+     * municipalities or districts, within a number of trains that can be added
+     * @details Time Complexity: O(|V||E|² + R·C·A(|V|+|E|)) where R is the number of upgrades, C the connections tried
+     * in each one and A the augmenting paths of each try
+     */
+    void capacityUpgradePlan();
+
+    /**
+     * @brief Show the k cheapest routes between 2 stations, with their cost and the trains they can carry
+     * @details Time Complexity: O(kL(|V|+|E|log(|V|))/T) where L is the number of stations of a route and T the number
+     * of threads
+     */
+    void alternativeRoutes();
+
 public:
     /**
-     * @brief Construct a new Menu object.
+     * @brief File name of station input in csv format
+     */
+    static const std::string STATIONS_INPUT;
+    
+    /**
+     * @brief File name of network input in csv format
+     */
+    static const std::string NETWORK_INPUT;
+
+    /**
+     * @brief Construct a new Menu object, with the results cached in the default cache directory.
      */
     Menu();
 
+    /**
+     * @brief Construct a new Menu object.
+     *
+     * @param cacheDirectory Directory where the results are cached between runs, empty to not cache them
+     */
+    explicit Menu(const std::string& cacheDirectory);
+
     /**
      * @brief Shows a friendly menu and read the option from the user.
      */
@@ -0,0 +1,142 @@
+#ifndef FEUP_DA1_RANKING_H
+#define FEUP_DA1_RANKING_H
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Order of a ranking: highest score first, ties ordered by key so the result is always the same
+ */
+template <typename Key, typename Score>
+struct RankingOrder {
+    bool operator()(const std::pair<Key, Score>& a, const std::pair<Key, Score>& b) const {
+        if (a.second != b.second) {
+            return a.second > b.second;
+        }
+        return a.first < b.first;
+    }
+};
+
+/**
+ * @brief Select the top k items, highest score first
+ *
+ * @details Time Complexity: O(n+k log(k))
+ *
+ * @param items Pairs of key and score
+ * @param k Number of items to select
+ * @param includeTies Also include the items tied with the k-th item
+ * @return std::vector<std::pair<Key, Score>> Top items in order
+ */
+template <typename Key, typename Score>
+std::vector<std::pair<Key, Score>> topK(std::vector<std::pair<Key, Score>> items, size_t k, bool includeTies = false) {
+    TRACE_SPAN("topK", "ranking");
+    RankingOrder<Key, Score> order;
+
+    if (k < items.size()) {
+        std::nth_element(items.begin(), items.begin() + k, items.end(), order);
+
+        size_t end = k;
+        if (includeTies && k > 0) {
+            Score last = std::max_element(items.begin(), items.begin() + k, order)->second; // k-th item
+            end = std::partition(items.begin() + k, items.end(), [last](const auto& item) {
+                return item.second == last;
+            }) - items.begin();
+        }
+
+        items.resize(end);
+    }
+
+    std::sort(items.begin(), items.end(), order);
+    return items;
+}
+
+/**
+ * @brief Ranking of keys by score that can be updated while it is being read
+ *
+ * @details Keeps the items ordered, so any update costs O(log(n)) and the top k can be read at any time in O(k)
+ */
+template <typename Key, typename Score>
+class Ranking {
+private:
+    /**
+     * @brief Current score of each key
+     */
+    std::unordered_map<Key, Score> _scores;
+
+    /**
+     * @brief Items ordered by score
+     */
+    std::set<std::pair<Key, Score>, RankingOrder<Key, Score>> _order;
+
+public:
+    /**
+     * @brief Set the score of a key, adding it if needed
+     *
+     * @details Time Complexity: O(log(n))
+     *
+     * @param key Key
+     * @param score New score
+     */
+    void set(const Key& key, Score score) {
+        auto it = _scores.find(key);
+        if (it != _scores.end()) {
+            _order.erase(std::make_pair(key, it->second));
+            it->second = score;
+        } else {
+            _scores.emplace(key, score);
+        }
+
+        _order.emplace(key, score);
+    }
+
+    /**
+     * @brief Add to the score of a key, adding it with the given score if needed
+     *
+     * @details Time Complexity: O(log(n))
+     *
+     * @param key Key
+     * @param delta Value to add to the score
+     */
+    void add(const Key& key, Score delta) {
+        auto it = _scores.find(key);
+        set(key, it != _scores.end() ? it->second + delta : delta);
+    }
+
+    /**
+     * @brief Get the top k items, highest score first
+     *
+     * @details Time Complexity: O(k)
+     *
+     * @param k Number of items
+     * @param includeTies Also include the items tied with the k-th item
+     * @return std::vector<std::pair<Key, Score>> Top items in order
+     */
+    std::vector<std::pair<Key, Score>> top(size_t k, bool includeTies = false) const {
+        std::vector<std::pair<Key, Score>> result;
+
+        for (auto it = _order.begin(); it != _order.end(); it++) {
+            if (result.size() >= k && !(includeTies && k > 0 && it->second == result.back().second)) {
+                break;
+            }
+            result.push_back(*it);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Get the number of keys in the ranking
+     *
+     * @return size_t Number of keys
+     */
+    size_t size() const {
+        return _scores.size();
+    }
+};
+
+#endif // FEUP_DA1_RANKING_H
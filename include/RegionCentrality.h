@@ -0,0 +1,137 @@
+#ifndef FEUP_DA1_REGIONCENTRALITY_H
+#define FEUP_DA1_REGIONCENTRALITY_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "Ranking.h"
+#include "TaskControl.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Flow centrality of the municipalities and districts of the railway network
+ */
+class RegionCentrality {
+public:
+    /**
+     * @brief Level of the regions
+     */
+    enum Level {
+        MUNICIPALITY,
+        DISTRICT
+    };
+
+private:
+    /**
+     * @brief Flow network of the graph, if its flows fit in an int
+     */
+    std::unique_ptr<FlowNetwork> _network;
+
+    /**
+     * @brief Flow network of the graph, if its flows need 64 bits
+     */
+    std::unique_ptr<FlowNetwork64> _wideNetwork;
+
+    /**
+     * @brief Region names of each level
+     */
+    std::vector<std::string> _regionNames[2];
+
+    /**
+     * @brief Stations of each region of each level
+     */
+    std::vector<std::vector<int>> _regionStations[2];
+
+    /**
+     * @brief Region of each station in each level
+     */
+    std::vector<int> _regionOf[2];
+
+    /**
+     * @brief Add the max flow between each pair of regions of a level to the score of both regions
+     *
+     * @param network Flow network of the graph
+     * @param level Level of the regions
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param ranking Ranking of the regions
+     * @param onProgress Called with the provisional ranking and the fraction of pairs done
+     */
+    template <typename Capacity>
+    void solveRegionPairs(
+        const BasicFlowNetwork<Capacity>& network,
+        Level level,
+        unsigned int numThreads,
+        Ranking<std::string, long long>& ranking,
+        const std::function<void(const Ranking<std::string, long long>&, double)>& onProgress,
+        TaskControl* control
+    ) const;
+
+public:
+    /**
+     * @brief Construct a new Region Centrality object
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     * The 64 bit flow network is only used if the flows of the graph may not fit in an int.
+     *
+     * @param g Graph of the railway network
+     */
+    explicit RegionCentrality(const Graph& g);
+
+    /**
+     * @brief Get the regions of a level
+     *
+     * @param level Level of the regions
+     * @return const std::vector<std::string>& Region names
+     */
+    const std::vector<std::string>& getRegions(Level level) const;
+
+    /**
+     * @brief Get the number of pairs of regions of a level, the max flows solved by regionPairsScores
+     *
+     * @param level Level of the regions
+     * @return long long Number of pairs
+     */
+    long long getNumRegionPairs(Level level) const;
+
+    /**
+     * @brief Importance of each region as the sum of the max flow between each of its stations and every other station
+     *
+     * @details Time Complexity: O(|V|)
+     *
+     * @param levels Levels of the regions to score
+     * @param sums Sum of the max flows between each station and every other one (GomoryHuTree::sumOfMaxFlows)
+     * @return std::vector<std::vector<std::pair<std::string, long long>>> Pairs of region name and importance,
+     * for each level (saturated at the largest long long)
+     */
+    std::vector<std::vector<std::pair<std::string, long long>>> stationPairsScores(
+        const std::vector<Level>& levels,
+        const std::vector<long long>& sums
+    ) const;
+
+    /**
+     * @brief Importance of each region as the sum of the max flow between it and every other region
+     * The flow between two regions is computed at once, from all the stations of one to all the stations of the other.
+     *
+     * @details Time Complexity: O(R²|V||E|²/T) where R is the number of regions and T the number of threads
+     *
+     * @param level Level of the regions to score
+     * @param numThreads Number of threads to use, 0 to use all hardware threads
+     * @param onProgress Called (from one thread at a time) with the provisional ranking and the fraction of pairs done
+     * @param control Progress of the pairs, one unit per pair, declared by the caller (getNumRegionPairs) so the levels
+     * can share a progress; if cancelled the scores are of the pairs solved so far (optional)
+     * @return std::vector<std::pair<std::string, long long>> Pairs of region name and importance (saturated at the
+     * largest long long)
+     */
+    std::vector<std::pair<std::string, long long>> regionPairsScores(
+        Level level,
+        unsigned int numThreads = 0,
+        const std::function<void(const Ranking<std::string, long long>&, double)>& onProgress = nullptr,
+        TaskControl* control = nullptr
+    ) const;
+};
+
+#endif // FEUP_DA1_REGIONCENTRALITY_H
@@ -0,0 +1,110 @@
+#ifndef FEUP_DA1_SERVER_H
+#define FEUP_DA1_SERVER_H
+
+#include "Graph.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Resident mode, answers queries from many clients over a UNIX domain socket with the network loaded once
+ *
+ * @details Each connection is one request: the client writes queries in the format of Batch, one per line, and
+ * closes its side of the connection (e.g. nc -N -U). The results are written back in the format of Batch and
+ * the connection is closed. Stations and connections removed by a request only exist in that request.
+ *
+ * Connections are answered by a pool of workers sharing the graph, which is only read.
+ */
+class Server {
+private:
+    /**
+     * @brief Graph of the railway network
+     */
+    const Graph& _graph;
+
+    /**
+     * @brief Path of the socket
+     */
+    std::string _socketPath;
+
+    /**
+     * @brief Number of workers
+     */
+    unsigned int _numWorkers;
+
+    /**
+     * @brief Listening socket, -1 if not listening
+     */
+    int _listenFd = -1;
+
+    /**
+     * @brief Connections waiting for a worker
+     */
+    std::queue<int> _clients;
+
+    /**
+     * @brief Protects the connections waiting and the stop flag
+     */
+    std::mutex _mutex;
+
+    /**
+     * @brief Signals workers that there is a connection waiting or the server is stopping
+     */
+    std::condition_variable _ready;
+
+    /**
+     * @brief Workers stop when there are no more connections waiting
+     */
+    bool _stopping = false;
+
+    /**
+     * @brief Take connections and answer them until the server stops
+     */
+    void worker();
+
+    /**
+     * @brief Answer the request of a connection and close it
+     *
+     * @param fd Connection
+     */
+    void serve(int fd) const;
+
+public:
+    /**
+     * @brief Seconds a client can stay silent before it is disconnected, so it can't hold a worker forever
+     */
+    static const int CLIENT_TIMEOUT = 30;
+
+    /**
+     * @brief Construct a new Server object
+     *
+     * @param g Graph of the railway network, must not change while the server runs
+     * @param socketPath Path of the socket
+     * @param numWorkers Number of workers, 0 to use all hardware threads
+     */
+    Server(const Graph& g, std::string socketPath, unsigned int numWorkers = 0);
+
+    /**
+     * @brief Destroy the Server object, removing the socket
+     */
+    ~Server();
+
+    /**
+     * @brief Create the socket and start listening, replacing a stale socket file left at the path
+     *
+     * @return true Listening
+     * @return false The socket could not be created (the reason is in errno)
+     */
+    bool listen();
+
+    /**
+     * @brief Accept connections until SIGINT or SIGTERM, the requests already accepted are still answered
+     */
+    void run();
+};
+
+#endif // FEUP_DA1_SERVER_H
@@ -0,0 +1,108 @@
+#ifndef FEUP_DA1_STATS_H
+#define FEUP_DA1_STATS_H
+
+#include <chrono>
+#include <ostream>
+
+/**
+ * @brief Instrumentation of the algorithms: work counters and wall time per phase, kept per thread
+ *
+ * @details The algorithms count through the STATS_ADD and STATS_PHASE macros, which compile to nothing unless
+ * FEUP_DA1_STATS is defined (cmake -DFEUP_DA1_STATS=ON). Allocations are counted by replacing the global
+ * operator new in those builds. A query is measured by taking the counters before and after it. The threads of
+ * utils::runWorkers add their counters to the calling thread when they finish, so the phase times of parallel work
+ * are summed over the threads.
+ */
+namespace stats {
+    /**
+     * @brief Phases of a query with their own wall time
+     */
+    enum class Phase {
+        LOOKUP,  // finding the stations by name
+        RESET,   // clearing the state of the previous query
+        AUGMENT, // augmenting the flow
+        SEARCH,  // shortest path searches
+        COUNT
+    };
+
+    /**
+     * @brief Work done by a thread since its counters were last taken
+     */
+    struct Counters {
+        long long augmentingPaths = 0;
+        long long vertexScans = 0;
+        long long edgeScans = 0;
+        long long heapPushes = 0;
+        long long heapPops = 0;
+        long long allocations = 0;
+        double phaseMs[(int) Phase::COUNT] = {};
+
+        Counters& operator+=(const Counters& other);
+    };
+
+    /**
+     * @brief If the counters are compiled in, otherwise only the phases timed by the callers are meaningful
+     */
+#ifdef FEUP_DA1_STATS
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    /**
+     * @brief Get the counters of the calling thread
+     */
+    Counters& current();
+
+    /**
+     * @brief Get the counters of the calling thread and reset them
+     *
+     * @return Counters Work done since the last take
+     */
+    Counters take();
+
+    /**
+     * @brief Write the names of the fields written by write, comma separated
+     *
+     * @param out Output
+     */
+    void writeHeader(std::ostream& out);
+
+    /**
+     * @brief Write counters, comma separated
+     *
+     * @param out Output
+     * @param counters Counters
+     */
+    void write(std::ostream& out, const Counters& counters);
+
+    /**
+     * @brief Adds the wall time of its scope to a phase of the calling thread
+     */
+    class ScopedPhase {
+    private:
+        Phase _phase;
+        std::chrono::steady_clock::time_point _start;
+
+    public:
+        explicit ScopedPhase(Phase phase): _phase(phase), _start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedPhase() {
+            current().phaseMs[(int) _phase] +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+        }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+    };
+}
+
+#ifdef FEUP_DA1_STATS
+#define STATS_ADD(counter, n) (stats::current().counter += (n))
+#define STATS_PHASE(phase) stats::ScopedPhase stats_phase_(stats::Phase::phase)
+#else
+#define STATS_ADD(counter, n) ((void) 0)
+#define STATS_PHASE(phase) ((void) 0)
+#endif
+
+#endif // FEUP_DA1_STATS_H
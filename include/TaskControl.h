@@ -0,0 +1,75 @@
+#ifndef FEUP_DA1_TASKCONTROL_H
+#define FEUP_DA1_TASKCONTROL_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Progress and cancellation of a long analysis, shared between the threads running it and the one waiting
+ *
+ * @details The analysis declares its work (addWork), reports what is done (advance) and stops as soon as it can
+ * once cancelled, leaving the results found so far. It may also describe its provisional results (setStatus).
+ */
+class TaskControl {
+private:
+    std::atomic<bool> _cancelled{false};
+    std::atomic<long long> _done{0};
+    std::atomic<long long> _total{0};
+
+    /**
+     * @brief Protects _status
+     */
+    mutable std::mutex _mutex;
+
+    /**
+     * @brief Description of the provisional results
+     */
+    std::string _status;
+
+public:
+    /**
+     * @brief Ask the analysis to stop
+     */
+    void cancel();
+
+    /**
+     * @brief If the analysis was asked to stop
+     */
+    bool isCancelled() const;
+
+    /**
+     * @brief Add units of work to the total of the analysis
+     *
+     * @param amount Units of work
+     */
+    void addWork(long long amount);
+
+    /**
+     * @brief Mark units of work as done
+     *
+     * @param amount Units of work
+     */
+    void advance(long long amount = 1);
+
+    /**
+     * @brief Get the fraction of the work done
+     *
+     * @return double Between 0 and 1, 0 while there is no work
+     */
+    double getProgress() const;
+
+    /**
+     * @brief Set the description of the provisional results
+     *
+     * @param status Description
+     */
+    void setStatus(const std::string& status);
+
+    /**
+     * @brief Get the description of the provisional results
+     */
+    std::string getStatus() const;
+};
+
+#endif // FEUP_DA1_TASKCONTROL_H
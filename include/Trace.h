@@ -0,0 +1,80 @@
+#ifndef FEUP_DA1_TRACE_H
+#define FEUP_DA1_TRACE_H
+
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Tracing of long analyses in the Chrome trace JSON format (chrome://tracing, ui.perfetto.dev)
+ *
+ * @details Code is marked with scoped spans (TRACE_SPAN), each becomes a complete event with its thread.
+ * While tracing is off a span only checks a flag. Events are buffered per thread and appended to the file when a
+ * buffer fills up or a second after it was last written, when the thread exits and when tracing stops, so a long
+ * traced run (--serve --trace) keeps only a few events per thread in memory.
+ */
+namespace trace {
+    /**
+     * @brief Start tracing, the events are written to a file as they are recorded
+     *
+     * @param file Path of the trace file
+     * @return true Tracing
+     * @return false The file can't be written
+     */
+    bool start(const std::string& file);
+
+    /**
+     * @brief Stop tracing, write the events of the calling thread and close the file, must not be called while
+     * other threads are tracing
+     *
+     * @return true Events written
+     * @return false Not tracing or the file could not be written
+     */
+    bool stop();
+
+    /**
+     * @brief If tracing is on
+     */
+    bool isEnabled();
+
+    /**
+     * @brief Record a complete event of the calling thread
+     *
+     * @param name Name of the event, must outlive the trace (a string literal)
+     * @param category Category of the event, must outlive the trace (a string literal)
+     * @param start When it started
+     * @param end When it ended
+     */
+    void record(const char* name, const char* category,
+                std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * @brief Records its scope as an event
+     */
+    class Span {
+    private:
+        const char* _name;
+        const char* _category;
+        bool _active;
+        std::chrono::steady_clock::time_point _start;
+
+    public:
+        Span(const char* name, const char* category): _name(name), _category(category), _active(isEnabled()) {
+            if (_active) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~Span() {
+            if (_active) {
+                record(_name, _category, _start, std::chrono::steady_clock::now());
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+    };
+}
+
+#define TRACE_SPAN(name, category) trace::Span trace_span_(name, category)
+
+#endif // FEUP_DA1_TRACE_H
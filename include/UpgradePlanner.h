@@ -0,0 +1,127 @@
+#ifndef FEUP_DA1_UPGRADEPLANNER_H
+#define FEUP_DA1_UPGRADEPLANNER_H
+
+#include "FlowNetwork.h"
+#include "Graph.h"
+#include "RegionCentrality.h"
+#include "TaskControl.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Plan of link capacity upgrades that raise the max flow between stations or regions the most
+ *
+ * @details Starts from the max flow and its residual network. Only a saturated link from a station the sources
+ * still reach to a station that still reaches the sinks can raise the flow on its own, so each round tries each
+ * of those links with the added capacity, augmenting the current flow and undoing it, and keeps the one with the
+ * largest gain. When no single link raises the flow (the cuts are separated by saturated links), the path with
+ * the fewest links that can't take the increment is upgraded at once. Upgrades are taken greedily until the
+ * budget is spent or no upgrade raises the flow. The progress is the budget spent, and a cancelled plan keeps the
+ * upgrades taken before the cancel (the flow of each one is still exact).
+ */
+class UpgradePlanner {
+public:
+    /**
+     * @brief Upgrade of a link
+     */
+    struct Step {
+        /**
+         * @brief Stations at the ends of the link, in the direction of the flow
+         */
+        std::string origin, dest;
+
+        /**
+         * @brief Capacity added (in both directions if the link is bidirectional)
+         */
+        long long added;
+
+        /**
+         * @brief Max flow after the upgrade
+         */
+        long long flow;
+    };
+
+    /**
+     * @brief Upgrades in the order they are taken
+     */
+    struct Plan {
+        /**
+         * @brief Max flow before any upgrade, -1 if the stations or regions are not valid
+         */
+        long long initialFlow;
+
+        std::vector<Step> steps;
+    };
+
+private:
+    /**
+     * @brief Flow network of the graph, with 64 bit capacities as upgrades can go beyond an int
+     */
+    FlowNetwork64 _network;
+
+    /**
+     * @brief Region of each station in each level
+     */
+    std::vector<std::string> _regionOf[2];
+
+    /**
+     * @brief Plan the upgrades from a set of sources to a set of sinks
+     *
+     * @param sources Source vertex indexes
+     * @param sinks Sink vertex indexes
+     * @param budget Total capacity that can be added
+     * @param increment Capacity added to a link in each upgrade
+     * @param control Progress of the budget spent, if cancelled the upgrades taken so far are returned (optional)
+     * @return Plan Upgrades
+     */
+    Plan plan(const std::vector<int>& sources, const std::vector<int>& sinks, long long budget, long long increment,
+              TaskControl* control) const;
+
+public:
+    /**
+     * @brief Construct a new Upgrade Planner object
+     *
+     * @details Time Complexity: O(|V|+|E|)
+     *
+     * @param g Graph of the railway network
+     */
+    explicit UpgradePlanner(const Graph& g);
+
+    /**
+     * @brief Plan the upgrades that raise the max flow between two stations
+     *
+     * @details Time Complexity: O(|V||E|² + R·C·A(|V|+|E|)) where R is the number of upgrades (budget / increment),
+     * C the links tried in each round and A the augmenting paths of each try
+     *
+     * @param source Source station
+     * @param dest Destination station
+     * @param budget Total capacity that can be added
+     * @param increment Capacity added to a link in each upgrade
+     * @param control Progress of the budget spent, if cancelled the upgrades taken so far are returned (optional)
+     * @return Plan Upgrades, initialFlow is -1 if a station does not exist, they are the same or the budget or the
+     * increment are not positive
+     */
+    Plan planPair(const std::string& source, const std::string& dest, long long budget, long long increment = 1,
+                  TaskControl* control = nullptr) const;
+
+    /**
+     * @brief Plan the upgrades that raise the max flow from all the stations of a region to all the stations of
+     * another (RegionCentrality::regionPairsScores)
+     *
+     * @details Time Complexity: like planPair
+     *
+     * @param level Level of the regions
+     * @param source Source region
+     * @param dest Destination region
+     * @param budget Total capacity that can be added
+     * @param increment Capacity added to a link in each upgrade
+     * @param control Progress of the budget spent, if cancelled the upgrades taken so far are returned (optional)
+     * @return Plan Upgrades, initialFlow is -1 if a region does not exist, they are the same or the budget or the
+     * increment are not positive
+     */
+    Plan planRegions(RegionCentrality::Level level, const std::string& source, const std::string& dest,
+                     long long budget, long long increment = 1, TaskControl* control = nullptr) const;
+};
+
+#endif // FEUP_DA1_UPGRADEPLANNER_H
@@ -1,6 +1,10 @@
 #ifndef FEUP_DA1_UTILS_H
 #define FEUP_DA1_UTILS_H
 
+#include <functional>
+#include <limits>
+#include <string>
+
 namespace utils {
     /**
      * @brief Clears the screen
@@ -11,6 +15,49 @@ namespace utils {
      * @brief Waits for the user to press enter
      */
     void waitEnter();
+
+    /**
+     * @brief Get the directory for the cache files, $XDG_CACHE_HOME/feup_da1 or ~/.cache/feup_da1
+     * 
+     * @return std::string Directory, empty if there is no home directory
+     */
+    std::string cacheDirectory();
+
+    /**
+     * @brief Get the number of threads to use
+     * 
+     * @param requested Number of threads requested, 0 to use all hardware threads
+     * @param tasks Number of tasks to run, there is no point in having more threads
+     * @return unsigned int Number of threads (at least 1)
+     */
+    unsigned int numThreads(unsigned int requested, size_t tasks);
+
+    /**
+     * @brief Run a worker function in the given number of threads (the calling thread included) and wait for all
+     * Workers are expected to share the work between them (e.g. with an atomic counter). The work counters of the
+     * threads are added to the caller's (see Stats.h).
+     * 
+     * @param numThreads Number of threads
+     * @param worker Function run by every thread
+     */
+    void runWorkers(unsigned int numThreads, const std::function<void()>& worker);
+
+    /**
+     * @brief Add a value to a total, saturating at the limits of the type instead of overflowing
+     * 
+     * @param total Total to add to
+     * @param value Value to add
+     * @return true The sum fits in the type
+     * @return false The sum overflowed, total is now the largest (or smallest) value of the type
+     */
+    template <typename T>
+    bool checkedAdd(T& total, T value) {
+        if (__builtin_add_overflow(total, value, &total)) {
+            total = value > 0 ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+            return false;
+        }
+        return true;
+    }
 }
 
 #endif // FEUP_DA1_UTILS_H
@@ -3,19 +3,28 @@
 
 #include "Station.h"
 
+#include <memory>
 #include <vector>
 
 class Edge;
 
+/**
+ * @brief Type of service of a trip
+ */
+enum class Service {
+    STANDARD,
+    ALFA_PENDULAR
+};
+
 /**
  * @brief Represents a station in the railway network 
  */
 class Vertex {
 private:
     /**
-     * @brief Vertex station
+     * @brief Vertex station, shared with the copies of the vertex until one of them sets another station
      */
-    Station _station;
+    std::shared_ptr<const Station> _station;
 
     /**
      * @brief Adjacency list of edges
@@ -23,9 +32,14 @@ private:
     std::vector<Edge *> _adj;
 
     /**
-     * @brief If vertex was visited
+     * @brief Position of the vertex in the vertex set of its graph
+     */
+    size_t _index = 0;
+
+    /**
+     * @brief Epoch of the traversal that last visited the vertex
      */
-    bool _visited = false;
+    unsigned int _visitedEpoch = 0;
     
     /**
      * @brief If vertex is processing (used for DAGs)
@@ -50,11 +64,25 @@ private:
     /**
      * @brief Cost from source to the vertex
      */
-     int _distance = 0;
+    int _distance = 0;
+
+    /**
+     * @brief Epoch of the search that last set the distance
+     */
+    unsigned int _distanceEpoch = 0;
+
+    friend class Graph; // copies of the graph rebuild the incomming edges
 
 public:
     Vertex(const Station& station);
 
+    /**
+     * @brief Construct a vertex that shares the station of another vertex
+     *
+     * @param station Shared station
+     */
+    Vertex(std::shared_ptr<const Station> station);
+
     /**
      * @brief Get the vertex station
      * 
@@ -62,20 +90,35 @@ public:
      */
     const Station& getStation() const;
 
+    /**
+     * @brief Get the shared vertex station, to share it with a copy of the vertex
+     *
+     * @return const std::shared_ptr<const Station>& station
+     */
+    const std::shared_ptr<const Station>& getSharedStation() const;
+
     /**
      * @brief Get the adjacency list of edges
      * 
-     * @return std::vector<Edge*> adjacencyList
+     * @return const std::vector<Edge*>& adjacencyList
      */
-    std::vector<Edge *> getAdj() const;
+    const std::vector<Edge *>& getAdj() const;
 
     /**
-     * @brief If the vertex was visited
+     * @brief Get the position of the vertex in the vertex set of its graph
+     *
+     * @return size_t index
+     */
+    size_t getIndex() const;
+
+    /**
+     * @brief If the vertex was visited in a traversal
      * 
+     * @param epoch Epoch of the traversal
      * @return true Vertex was visited
      * @return false Vertex was not visited
      */
-    bool isVisited() const;
+    bool isVisited(unsigned int epoch) const;
 
     /**
      * @brief If the vertex is processing
@@ -95,9 +138,10 @@ public:
     /**
      * @brief Get cost from source to the vertex
      *
-     * @return Cost from source to the vertex
+     * @param epoch Epoch of the search
+     * @return Cost from source to the vertex, or the maximum int if it was not set in that search
      */
-    int getDistance() const;
+    int getDistance(unsigned int epoch) const;
 
     /**
      * @brief Get vertex path
@@ -109,9 +153,9 @@ public:
     /**
      * @brief Get incomming edges to the vertex
      * 
-     * @return std::vector<Edge*> incommingEdges
+     * @return const std::vector<Edge*>& incommingEdges
      */
-    std::vector<Edge *> getIncomming() const;
+    const std::vector<Edge *>& getIncomming() const;
 
     /**
      * @brief Set vertex station
@@ -121,11 +165,18 @@ public:
     void setStation(const Station& station);
 
     /**
-     * @brief Set vertex to visited/unvisited
+     * @brief Set the position of the vertex in the vertex set of its graph
+     *
+     * @param index
+     */
+    void setIndex(size_t index);
+
+    /**
+     * @brief Set vertex to visited in a traversal (0 to unvisited in every traversal)
      * 
-     * @param visited 
+     * @param epoch Epoch of the traversal
      */
-    void setVisited(bool visited);
+    void setVisited(unsigned int epoch);
 
     /**
      * @brief Set vertex to (not) processing
@@ -145,8 +196,9 @@ public:
      * @brief Set cost from source to the vertex
      *
      * @param distance cost from source to the vertex
+     * @param epoch Epoch of the search
      */
-    void setDistance(int distance);
+    void setDistance(int distance, unsigned int epoch);
 
     /**
      * @brief Set path to vertex
@@ -166,13 +218,26 @@ public:
     Edge* addEdge(Vertex* dest, int weight, const std::string& service);
 
     /**
-     * @brief Remove an edge with the vertex as origin
-     * 
-     * @param destStation Station of the destination vertex
-     * @return true Vertex was removed
-     * @return false Vertex does not exist
+     * @brief Take an edge with the vertex as origin out of the adjacency list and the incomming edges of its
+     * destination, the last edge of each list takes its place (the edge is not deleted)
+     *
+     * @details Time Complexity: O(deg), O(1) for the last edges of the lists
+     *
+     * @param edge Edge to take out
+     * @return std::pair<size_t, size_t> Positions the edge had in the adjacency list and in the incomming edges
+     */
+    std::pair<size_t, size_t> detachEdge(Edge* edge);
+
+    /**
+     * @brief Put back an edge taken out by detachEdge, at the same positions (the edges detached after it must
+     * have been put back first)
+     *
+     * @details Time Complexity: O(1)
+     *
+     * @param edge Edge to put back
+     * @param positions Positions returned by detachEdge
      */
-    bool removeEdge(const Station& destStation);
+    void attachEdge(Edge* edge, std::pair<size_t, size_t> positions);
 };
 
 /**
@@ -203,13 +268,23 @@ private:
     /**
      * @brief Represent number of trains that are simultainiously in the edge
      */
-    int _flow;
+    int _flow = 0;
+
+    /**
+     * @brief Epoch of the flow computation that last set the flow
+     */
+    unsigned int _flowEpoch = 0;
 
     /**
      * @brief Type of service of the edge
      */
     std::string _service;
 
+    /**
+     * @brief Type of service of the edge, anything but "STANDARD" is ALFA_PENDULAR
+     */
+    Service _serviceType;
+
 public:
     Edge(Vertex* origin, Vertex* dest, int weight, const std::string& service);
 
@@ -244,9 +319,10 @@ public:
     /**
      * @brief Get the edge's flow
      * 
-     * @return int Edge flow
+     * @param epoch Epoch of the flow computation
+     * @return int Edge flow, 0 if it was not set in that computation
      */
-    int getFlow() const;
+    int getFlow(unsigned int epoch) const;
 
     /**
      * @brief Get trip's service
@@ -255,6 +331,20 @@ public:
      */
     const std::string& getService() const;
 
+    /**
+     * @brief Get trip's type of service
+     * 
+     * @return Service service type
+     */
+    Service getServiceType() const;
+
+    /**
+     * @brief Set the edge's weight
+     *
+     * @param weight weight
+     */
+    void setWeight(int weight);
+
     /**
      * @brief Set reverse edge
      * 
@@ -266,8 +356,9 @@ public:
      * @brief Set the flow
      * 
      * @param flow Edge flow
+     * @param epoch Epoch of the flow computation
      */
-    void setFlow(int flow);
+    void setFlow(int flow, unsigned int epoch);
 };
 
 #endif // FEUP_DA1_VERTEXEDGE_H
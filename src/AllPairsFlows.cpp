@@ -0,0 +1,146 @@
+#include "AllPairsFlows.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+    /**
+     * @brief Header of a cache file, the parents and the weights of the tree follow it
+     */
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t numVertex;
+        uint64_t fingerprint;
+    };
+
+    const char MAGIC[8] = {'F', 'D', 'A', '1', 'A', 'P', 'F', '\0'};
+    const uint32_t VERSION = 2; // 1 kept the table of every pair
+
+    /**
+     * @brief FNV-1a hash, fed with the bytes of values
+     */
+    class Hash {
+    private:
+        uint64_t _value = 14695981039346656037ULL;
+
+    public:
+        void add(const void* data, size_t size) {
+            auto bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                _value = (_value ^ bytes[i]) * 1099511628211ULL;
+            }
+        }
+
+        template <typename T>
+        void add(T value) {
+            add(&value, sizeof(value));
+        }
+
+        uint64_t value() const {
+            return _value;
+        }
+    };
+}
+
+AllPairsFlows::AllPairsFlows(GomoryHuTree tree, uint64_t fingerprint)
+    : _fingerprint(fingerprint), _tree(std::move(tree)) {}
+
+template <typename Capacity>
+uint64_t AllPairsFlows::fingerprint(const BasicFlowNetwork<Capacity>& network) {
+    Hash hash;
+    hash.add(network.getNumVertex());
+    for (int v = 0; v < network.getNumVertex(); v++) {
+        const std::string& name = network.getName(v);
+        hash.add(name.data(), name.size() + 1);
+        hash.add(network.arcsEnd(v) - network.arcsBegin(v));
+        for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+            hash.add(network.getHead(a));
+            hash.add((long long) network.getCapacity(a)); // the same for 32 and 64 bit networks
+            hash.add(network.isEdge(a));
+            hash.add(network.getService(a));
+        }
+    }
+    return hash.value();
+}
+
+template uint64_t AllPairsFlows::fingerprint(const BasicFlowNetwork<int>& network);
+template uint64_t AllPairsFlows::fingerprint(const BasicFlowNetwork<long long>& network);
+
+std::unique_ptr<AllPairsFlows> AllPairsFlows::load(const std::string& path, int numVertex, uint64_t fingerprint) {
+    std::ifstream in(path, std::ios::binary);
+    FileHeader header = {};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+        || header.numVertex != (uint32_t) numVertex || header.fingerprint != fingerprint) {
+        return nullptr;
+    }
+
+    std::vector<int> parent(numVertex);
+    std::vector<long long> weight(numVertex);
+    in.read(reinterpret_cast<char*>(parent.data()), (std::streamsize) (parent.size() * sizeof(int)));
+    in.read(reinterpret_cast<char*>(weight.data()), (std::streamsize) (weight.size() * sizeof(long long)));
+    if (!in || in.peek() != std::ifstream::traits_type::eof()) {
+        return nullptr;
+    }
+
+    // Parents are smaller vertexes, so a damaged file can't make the tree walks loop
+    for (int v = 0; v < numVertex; v++) {
+        if ((v == 0 ? parent[v] != -1 : parent[v] < 0 || parent[v] >= v) || weight[v] < 0) {
+            return nullptr;
+        }
+    }
+    return std::make_unique<AllPairsFlows>(GomoryHuTree(std::move(parent), std::move(weight)), fingerprint);
+}
+
+bool AllPairsFlows::save(const std::string& path) const {
+    int n = _tree.getNumVertex();
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numVertex = (uint32_t) n;
+    header.fingerprint = _fingerprint;
+
+    std::vector<int> parent(n);
+    std::vector<long long> weight(n);
+    for (int v = 0; v < n; v++) {
+        parent[v] = _tree.getParent(v);
+        weight[v] = _tree.getWeight(v);
+    }
+
+    // Written next to the file and renamed over it
+    std::string temporary = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(parent.data()), (std::streamsize) (parent.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(weight.data()), (std::streamsize) (weight.size() * sizeof(long long)));
+        if (!out.good()) {
+            out.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+int AllPairsFlows::getNumVertex() const {
+    return _tree.getNumVertex();
+}
+
+uint64_t AllPairsFlows::getFingerprint() const {
+    return _fingerprint;
+}
+
+const GomoryHuTree& AllPairsFlows::getTree() const {
+    return _tree;
+}
@@ -0,0 +1,325 @@
+#include "Batch.h"
+#include "CostPolicy.h"
+#include "GlobalMinCut.h"
+#include "GraphKernels.h"
+#include "KShortestPaths.h"
+#include "Ranking.h"
+#include "Stats.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+
+Batch::Batch(const Graph& g, unsigned int numThreads): _graph(g), _numThreads(numThreads) {}
+
+void Batch::setStatsOutput(std::ostream* out) {
+    _statsOut = out;
+}
+
+const Graph& Batch::current() const {
+    return _scenario ? *_scenario : _graph;
+}
+
+std::vector<std::string> Batch::split(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (getline(ss, field, ',')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+void Batch::error(int line, const std::string& message) {
+    _results.push_back(std::to_string(line) + ",error," + message + '\n');
+    _errors++;
+}
+
+int Batch::arrivals(const Graph& g, std::unordered_map<std::string, int>& cache, const std::string& stationName) {
+    auto it = cache.find(stationName);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    int trains = g.maxTrainsArriving(stationName);
+    trains = trains == -1 ? 0 : trains; // the station doesn't exist or doesn't have flow
+    cache.emplace(stationName, trains);
+    return trains;
+}
+
+void Batch::newScenario() {
+    _arrivals.clear();
+    _costs.reset();
+    _costNetwork.reset();
+    _costSource = -1;
+}
+
+void Batch::flush(std::ostream& out) {
+    if (!_pendingFlows.empty()) {
+        std::vector<long long> flows = current().edmondsKarpBatch(_pendingFlows, _numThreads);
+        for (size_t i = 0; i < flows.size(); i++) {
+            // stations were checked when queued, -1 means that no train can travel between them
+            _results[_pendingResults[i]] += std::to_string(flows[i] == -1 ? 0 : flows[i]) + '\n';
+        }
+        _pendingFlows.clear();
+        _pendingResults.clear();
+    }
+
+    for (const auto &result: _results) {
+        out << result;
+    }
+    _results.clear();
+}
+
+void Batch::runQuery(int line, const std::vector<std::string>& fields, std::ostream& out) {
+    TRACE_SPAN("query", "batch");
+    const std::string& command = fields[0];
+    std::string prefix = std::to_string(line) + ',' + command + ',';
+    const Graph& g = current();
+
+    if (command == "maxflow" && fields.size() == 3) {
+        if (g.findVertex(fields[1]) == nullptr || g.findVertex(fields[2]) == nullptr) {
+            error(line, "invalid station");
+            return;
+        }
+        if (fields[1] == fields[2]) {
+            error(line, "origin and destination are the same station");
+            return;
+        }
+
+        if (_statsOut) {
+            // Solved on its own to measure it
+            int trains = g.edmondsKarp(fields[1], fields[2]);
+            _results.push_back(prefix + fields[1] + ',' + fields[2] + ',' + std::to_string(trains == -1 ? 0 : trains) + '\n');
+            return;
+        }
+
+        _pendingFlows.emplace_back(fields[1], fields[2]);
+        _pendingResults.push_back(_results.size());
+        _results.push_back(prefix + fields[1] + ',' + fields[2] + ',');
+    } else if (command == "arrivals" && fields.size() == 2) {
+        if (g.findVertex(fields[1]) == nullptr) {
+            error(line, "invalid station");
+            return;
+        }
+
+        int trains = arrivals(g, _scenario ? _arrivals : _originalArrivals, fields[1]);
+        _results.push_back(prefix + fields[1] + ',' + std::to_string(trains) + '\n');
+    } else if (command == "mincost" && fields.size() == 3) {
+        if (!_costs) {
+            _costNetwork = std::make_unique<FlowNetwork>(g);
+            _costs = std::make_unique<CsrStorage<int>>(*_costNetwork);
+        }
+
+        int source = _costNetwork->findIndex(fields[1]);
+        int dest = _costNetwork->findIndex(fields[2]);
+        if (source == -1 || dest == -1) {
+            error(line, "invalid station");
+            return;
+        }
+
+        // Queries from the same origin share the dijkstra
+        if (_costSource != source) {
+            kernels::dijkstra<ServiceCost>(*_costs, source);
+            _costSource = source;
+        }
+
+        int cost = _costs->getDistance(dest);
+        if (cost == std::numeric_limits<int>::max()) {
+            error(line, "impossible path");
+            return;
+        }
+
+        // Trains that can travel along the path, the minimum capacity of its edges
+        int trains = source == dest ? 0 : std::numeric_limits<int>::max();
+        for (int v = dest; v != source; v = _costs->getTail(_costs->getParent(v))) {
+            trains = std::min(trains, _costs->getCapacity(_costs->getParent(v)));
+        }
+
+        _results.push_back(prefix + fields[1] + ',' + fields[2] + ',' + std::to_string(cost) + ','
+                           + std::to_string(trains) + ',' + std::to_string((long long) cost * trains) + '\n');
+    } else if (command == "kpaths" && fields.size() == 4) {
+        int k;
+        std::stringstream ss(fields[3]);
+        if (!(ss >> k) || !ss.eof() || k <= 0) {
+            error(line, "k is either not a number or not positive");
+            return;
+        }
+        if (k > MAX_K_PATHS) {
+            error(line, "k is over " + std::to_string(MAX_K_PATHS));
+            return;
+        }
+        if (g.findVertex(fields[1]) == nullptr || g.findVertex(fields[2]) == nullptr) {
+            error(line, "invalid station");
+            return;
+        }
+
+        std::vector<KShortestPaths::Path> paths = KShortestPaths(g).find(fields[1], fields[2], k, _numThreads);
+        if (paths.empty()) {
+            error(line, "impossible path");
+            return;
+        }
+
+        std::string result;
+        for (size_t i = 0; i < paths.size(); i++) {
+            result += prefix + std::to_string(i + 1) + ',' + std::to_string(paths[i].cost) + ','
+                      + std::to_string(paths[i].capacity) + ','
+                      + std::to_string((long long) paths[i].cost * paths[i].capacity) + ',';
+            for (size_t j = 0; j < paths[i].stations.size(); j++) {
+                result += (j ? " -> " : "") + paths[i].stations[j];
+            }
+            result += '\n';
+        }
+        _results.push_back(result);
+    } else if (command == "maxpairs" && fields.size() == 1) {
+        std::string result;
+        for (const auto &pair: g.getMaxTrainCapacityPairs()) {
+            result += prefix + pair.first.first + ',' + pair.first.second + ',' + std::to_string(pair.second) + '\n';
+        }
+        _results.push_back(result);
+    } else if (command == "mincut" && fields.size() == 1) {
+        GlobalMinCut::Cut cut = GlobalMinCut(g).minCut();
+        if (cut.value == -1) {
+            error(line, "the network can't be split");
+            return;
+        }
+
+        std::string result;
+        for (const auto &station: cut.side) {
+            result += prefix + std::to_string(cut.value) + ',' + station + '\n';
+        }
+        _results.push_back(result);
+    } else if (command == "topk" && (fields.size() == 2 || (fields.size() == 3 && fields[2] == "regions"))) {
+        int k;
+        std::stringstream ss(fields[1]);
+        if (!(ss >> k) || !ss.eof() || k < 0 || k > g.getNumVertex()) {
+            error(line, "k is either not a number, negative or bigger than the number of stations");
+            return;
+        }
+
+        std::vector<std::string> municipalities;
+        std::vector<std::string> districts;
+        g.findTopMunicipalitiesAndDistricts(k, municipalities, districts, fields.size() == 3);
+
+        std::string result;
+        for (size_t i = 0; i < municipalities.size(); i++) {
+            result += prefix + "municipality," + std::to_string(i + 1) + ',' + municipalities[i] + '\n';
+        }
+        for (size_t i = 0; i < districts.size(); i++) {
+            result += prefix + "district," + std::to_string(i + 1) + ',' + districts[i] + '\n';
+        }
+        _results.push_back(result);
+    } else if (command == "affected" && fields.size() == 2) {
+        int k;
+        std::stringstream ss(fields[1]);
+        if (!(ss >> k) || !ss.eof() || k < 0 || k > _graph.getNumVertex()) {
+            error(line, "k is either not a number, negative or bigger than the number of stations");
+            return;
+        }
+
+        Ranking<std::string, int> ranking;
+        for (const Vertex* v: _graph.getVertexSet()) {
+            const std::string& name = v->getStation().getName();
+            int original_max = arrivals(_graph, _originalArrivals, name);
+            int new_max = _scenario ? arrivals(*_scenario, _arrivals, name) : original_max;
+            ranking.set(name, original_max - new_max);
+        }
+
+        std::string result;
+        int rank = 0;
+        for (const auto &station: ranking.top(k)) {
+            if (station.second == 0) {
+                break;
+            }
+            result += prefix + std::to_string(++rank) + ',' + station.first + ',' + std::to_string(station.second) + '\n';
+        }
+        _results.push_back(result);
+    } else if (command == "remove_station" && fields.size() == 2) {
+        if (current().findVertex(fields[1]) == nullptr) {
+            error(line, "invalid station");
+            return;
+        }
+
+        flush(out); // the waiting queries are answered before the scenario changes
+        if (!_scenario) {
+            _scenario = std::make_unique<Graph>(_graph);
+        }
+        _scenario->removeVertex(fields[1]);
+        newScenario();
+        _results.push_back(prefix + "ok\n");
+    } else if (command == "remove_link" && fields.size() == 3) {
+        Vertex* origin = g.findVertex(fields[1]);
+        Vertex* dest = g.findVertex(fields[2]);
+        bool found = false;
+        if (origin != nullptr && dest != nullptr) {
+            for (const Edge* e: origin->getAdj()) {
+                found = found || e->getDest() == dest;
+            }
+        }
+        if (!found) {
+            error(line, "invalid connection");
+            return;
+        }
+
+        flush(out);
+        if (!_scenario) {
+            _scenario = std::make_unique<Graph>(_graph);
+        }
+        _scenario->removeEdge(fields[1], fields[2]);
+        newScenario();
+        _results.push_back(prefix + "ok\n");
+    } else if (command == "reset" && fields.size() == 1) {
+        flush(out);
+        _scenario.reset();
+        newScenario();
+        _results.push_back(prefix + "ok\n");
+    } else {
+        error(line, "invalid query");
+    }
+}
+
+int Batch::run(std::istream& in, std::ostream& out) {
+    std::string line;
+    int line_number = 0;
+
+    if (_statsOut) {
+        *_statsOut << "line,command,ms,";
+        stats::writeHeader(*_statsOut);
+        *_statsOut << '\n';
+    }
+
+    while (getline(in, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields = split(line);
+        if (_statsOut) {
+            stats::take(); // discard the work done between queries
+            auto start = std::chrono::steady_clock::now();
+            runQuery(line_number, fields, out);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            *_statsOut << line_number << ',' << fields[0] << ',' << ms << ',';
+            stats::write(*_statsOut, stats::take());
+            *_statsOut << '\n';
+        } else {
+            runQuery(line_number, fields, out);
+        }
+
+        // Results only wait for max flow queries, which are solved in groups
+        if (_pendingFlows.empty() || _pendingFlows.size() >= MAX_PENDING_FLOWS) {
+            flush(out);
+        }
+    }
+
+    flush(out);
+    out.flush();
+    return _errors;
+}
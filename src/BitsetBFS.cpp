@@ -0,0 +1,54 @@
+#include "BitsetBFS.h"
+
+#include <algorithm>
+
+BitsetBFS::BitsetBFS(const NetworkTopology& network)
+    : _network(network),
+      _visited((network.getNumVertex() + 63) / 64, 0),
+      _frontier(_visited.size(), 0),
+      _targets(_visited.size(), 0),
+      _parent(network.getNumVertex(), -1),
+      _directionOptimizing(network.getNumArcs() >= DENSE_ARCS_PER_VERTEX * network.getNumVertex()) {}
+
+void BitsetBFS::clear() {
+    std::fill(_visited.begin(), _visited.end(), 0);
+    _queue.clear();
+}
+
+void BitsetBFS::markFrontier(size_t begin, size_t end, bool set) {
+    for (size_t i = begin; i < end; i++) {
+        int v = _queue[i];
+        if (set) {
+            _frontier[v >> 6] |= uint64_t(1) << (v & 63);
+        } else {
+            _frontier[v >> 6] &= ~(uint64_t(1) << (v & 63));
+        }
+    }
+}
+
+void BitsetBFS::setTargets(const std::vector<int>& targets) {
+    for (int v: _targetList) {
+        _targets[v >> 6] = 0;
+    }
+
+    _targetList = targets;
+    for (int v: _targetList) {
+        _targets[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+}
+
+bool BitsetBFS::isTarget(int v) const {
+    return test(_targets, v);
+}
+
+bool BitsetBFS::isVisited(int v) const {
+    return test(_visited, v);
+}
+
+int BitsetBFS::getParent(int v) const {
+    return _parent[v];
+}
+
+bool BitsetBFS::isDirectionOptimizing() const {
+    return _directionOptimizing;
+}
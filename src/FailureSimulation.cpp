@@ -0,0 +1,247 @@
+#include "FailureSimulation.h"
+#include "MaxFlowSolver.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+    /**
+     * @brief SplitMix64 generator, cheap to seed so each scenario has its own
+     */
+    class Random {
+    private:
+        uint64_t _state;
+
+    public:
+        explicit Random(uint64_t seed): _state(seed) {}
+
+        uint64_t next() {
+            uint64_t z = (_state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * @brief Uniform number in [0, 1)
+         */
+        double uniform() {
+            return (double) (next() >> 11) * 0x1.0p-53;
+        }
+    };
+
+    /**
+     * @brief Number of scenarios a thread takes at a time
+     */
+    const int CHUNK = 64;
+}
+
+FailureSimulation::FailureSimulation(const Graph& g, double failureProbability) {
+    if (NetworkTopology::needsWideCapacity(g)) {
+        _wideNetwork = std::make_unique<FlowNetwork64>(g);
+    } else {
+        _network = std::make_unique<FlowNetwork>(g);
+    }
+
+    const NetworkTopology& network = topology();
+    for (int v = 0; v < network.getNumVertex(); v++) {
+        for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+            if (a < network.getTwin(a)) {
+                _links.push_back(a);
+            }
+        }
+    }
+    _probability.assign(_links.size(), std::clamp(failureProbability, 0.0, 1.0));
+}
+
+const NetworkTopology& FailureSimulation::topology() const {
+    if (_wideNetwork) {
+        return *_wideNetwork;
+    }
+    return *_network;
+}
+
+bool FailureSimulation::setFailureProbability(const std::string& origin, const std::string& dest, double probability) {
+    const NetworkTopology& network = topology();
+    int u = network.findIndex(origin);
+    int v = network.findIndex(dest);
+    if (u == -1 || v == -1 || !(probability >= 0 && probability <= 1)) {
+        return false;
+    }
+
+    bool found = false;
+    for (int a = network.arcsBegin(u); a < network.arcsEnd(u); a++) {
+        if (network.getHead(a) == v) {
+            // The links are in arc order
+            int first = std::min(a, network.getTwin(a));
+            size_t link = std::lower_bound(_links.begin(), _links.end(), first) - _links.begin();
+            _probability[link] = probability;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool FailureSimulation::addPair(const std::string& source, const std::string& dest) {
+    int s = topology().findIndex(source);
+    int t = topology().findIndex(dest);
+    if (s == -1 || t == -1 || s == t) {
+        return false;
+    }
+
+    _measures.push_back({source + " -> " + dest, {s}, {t}});
+    return true;
+}
+
+bool FailureSimulation::addArrivals(const std::string& station) {
+    int t = topology().findIndex(station);
+    if (t == -1) {
+        return false;
+    }
+
+    std::vector<int> sources = _wideNetwork ? _wideNetwork->arrivalSources(t) : _network->arrivalSources(t);
+    _measures.push_back({"-> " + station, std::move(sources), {t}});
+    return true;
+}
+
+size_t FailureSimulation::getNumMeasures() const {
+    return _measures.size();
+}
+
+template <typename Capacity>
+void FailureSimulation::simulate(
+    const BasicFlowNetwork<Capacity>& network,
+    int numScenarios,
+    uint64_t seed,
+    unsigned int numThreads,
+    TaskControl* control,
+    std::vector<long long>& baseline,
+    std::vector<std::vector<long long>>& losses
+) const {
+    size_t num_measures = _measures.size();
+    baseline.assign(num_measures, 0);
+    losses.assign(num_measures, std::vector<long long>(numScenarios, -1));
+
+    // Max flow without failures, and the links that carry it: the flow stays if none of them fails
+    std::vector<std::vector<bool>> carries(num_measures, std::vector<bool>(_links.size(), false));
+    {
+        BasicMaxFlowSolver<Capacity> solver(network);
+        for (size_t m = 0; m < num_measures; m++) {
+            baseline[m] = std::max<long long>(0, solver.maxFlow(_measures[m].sources, _measures[m].sinks));
+            for (size_t l = 0; l < _links.size() && baseline[m] > 0; l++) {
+                carries[m][l] = solver.getFlow(_links[l]) != 0;
+            }
+        }
+    }
+
+    int num_chunks = (numScenarios + CHUNK - 1) / CHUNK;
+    std::atomic<int> next_chunk(0);
+    if (control != nullptr) {
+        control->addWork(numScenarios);
+    }
+
+    utils::runWorkers(utils::numThreads(numThreads, num_chunks), [&]() {
+        BasicMaxFlowSolver<Capacity> solver(network);
+        std::vector<bool> failed(network.getNumArcs(), false);
+        std::vector<size_t> failed_links;
+
+        for (int chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++) {
+            if (control != nullptr && control->isCancelled()) {
+                break;
+            }
+
+            int begin = chunk * CHUNK;
+            int end = std::min(numScenarios, begin + CHUNK);
+            for (int scenario = begin; scenario < end; scenario++) {
+                Random random(seed + (uint64_t) scenario * 0xD1B54A32D192ED03ULL);
+                for (size_t l = 0; l < _links.size(); l++) {
+                    if (random.uniform() < _probability[l]) {
+                        failed_links.push_back(l);
+                        failed[_links[l]] = true;
+                        failed[network.getTwin(_links[l])] = true;
+                    }
+                }
+                solver.setFailedArcs(&failed);
+
+                for (size_t m = 0; m < num_measures; m++) {
+                    bool affected = std::any_of(failed_links.begin(), failed_links.end(), [&carries, m](size_t l) {
+                        return carries[m][l];
+                    });
+
+                    long long loss = 0;
+                    if (affected) {
+                        Capacity flow = solver.maxFlow(_measures[m].sources, _measures[m].sinks);
+                        loss = baseline[m] - std::max<long long>(0, flow);
+                    }
+                    losses[m][scenario] = loss;
+                }
+
+                for (size_t l: failed_links) {
+                    failed[_links[l]] = false;
+                    failed[network.getTwin(_links[l])] = false;
+                }
+                failed_links.clear();
+            }
+
+            if (control != nullptr) {
+                control->advance(end - begin);
+            }
+        }
+    });
+}
+
+std::vector<FailureSimulation::Distribution> FailureSimulation::run(
+    int numScenarios,
+    uint64_t seed,
+    unsigned int numThreads,
+    TaskControl* control
+) const {
+    TRACE_SPAN("FailureSimulation::run", "analysis");
+    numScenarios = std::max(0, numScenarios);
+
+    std::vector<long long> baseline;
+    std::vector<std::vector<long long>> losses;
+    if (_wideNetwork) {
+        simulate(*_wideNetwork, numScenarios, seed, numThreads, control, baseline, losses);
+    } else {
+        simulate(*_network, numScenarios, seed, numThreads, control, baseline, losses);
+    }
+
+    std::vector<Distribution> distributions;
+    for (size_t m = 0; m < _measures.size(); m++) {
+        std::vector<long long> evaluated;
+        for (long long loss: losses[m]) {
+            if (loss != -1) {
+                evaluated.push_back(loss);
+            }
+        }
+        std::sort(evaluated.begin(), evaluated.end());
+
+        size_t n = evaluated.size();
+        auto percentile = [&evaluated, n](double p) {
+            return n == 0 ? 0 : evaluated[std::max<size_t>(1, (size_t) std::ceil(p * (double) n)) - 1];
+        };
+
+        double total = 0;
+        size_t with_loss = 0;
+        for (long long loss: evaluated) {
+            total += (double) loss;
+            with_loss += loss > 0;
+        }
+
+        distributions.push_back({
+            _measures[m].name,
+            baseline[m],
+            (int) n,
+            n == 0 ? 0 : total / (double) n,
+            percentile(0.5), percentile(0.9), percentile(0.95), percentile(0.99),
+            n == 0 ? 0 : evaluated.back(),
+            n == 0 ? 0 : (double) with_loss / (double) n
+        });
+    }
+
+    return distributions;
+}
@@ -0,0 +1,284 @@
+#include "FlowNetwork.h"
+#include "BitsetBFS.h"
+#include "MaxFlowSolver.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+/*===== NetworkTopology =====*/
+
+NetworkTopology::NetworkTopology(const Graph& g, std::vector<int>& weights) {
+    TRACE_SPAN("build flow network", "load");
+    std::unordered_map<const Vertex *, int> vertex_index;
+
+    for (auto v: g.getVertexSet()) {
+        vertex_index[v] = (int) _names.size();
+        _index[v->getStation().getName()] = (int) _names.size();
+        _names.push_back(v->getStation().getName());
+    }
+
+    // Each link becomes a pair of arcs, an edge and its reverse edge share the same pair
+    struct Link {
+        int origin, dest, capacity, reverse_capacity;
+        Service service;
+        bool bidirectional;
+    };
+    std::vector<Link> links;
+
+    for (auto v: g.getVertexSet()) {
+        for (auto e: v->getAdj()) {
+            auto r = e->getReverse();
+            if (r != nullptr && std::less<const Edge *>()(r, e)) {
+                continue; // already added with the reverse edge
+            }
+
+            links.push_back({
+                vertex_index[e->getOrigin()],
+                vertex_index[e->getDest()],
+                e->getWeight(),
+                r != nullptr ? r->getWeight() : 0,
+                e->getServiceType(),
+                r != nullptr
+            });
+        }
+    }
+
+    int n = (int) _names.size();
+    _first.assign(n + 1, 0);
+    for (const auto &link: links) {
+        _first[link.origin + 1]++;
+        _first[link.dest + 1]++;
+    }
+    std::partial_sum(_first.begin(), _first.end(), _first.begin());
+
+    _head.resize(2 * links.size());
+    _twin.resize(2 * links.size());
+    weights.resize(2 * links.size());
+    _service.resize(2 * links.size());
+    _isEdge.resize(2 * links.size());
+
+    std::vector<int> next(_first.begin(), _first.end() - 1);
+    for (const auto &link: links) {
+        int a = next[link.origin]++;
+        int b = next[link.dest]++;
+
+        _head[a] = link.dest;
+        _twin[a] = b;
+        weights[a] = link.capacity;
+        _service[a] = link.service;
+        _isEdge[a] = true;
+
+        _head[b] = link.origin;
+        _twin[b] = a;
+        weights[b] = link.reverse_capacity;
+        _service[b] = link.service;
+        _isEdge[b] = link.bidirectional;
+    }
+}
+
+bool NetworkTopology::needsWideCapacity(const Graph& g) {
+    long long total = 0;
+    for (auto v: g.getVertexSet()) {
+        for (auto e: v->getAdj()) {
+            total += e->getWeight();
+        }
+    }
+
+    // No flow is larger than the sum of the capacities
+    return total > std::numeric_limits<int>::max();
+}
+
+int NetworkTopology::findIndex(const std::string& stationName) const {
+    auto it = _index.find(stationName);
+    return it == _index.end() ? -1 : it->second;
+}
+
+const std::string& NetworkTopology::getName(int v) const {
+    return _names[v];
+}
+
+int NetworkTopology::getNumVertex() const {
+    return (int) _names.size();
+}
+
+int NetworkTopology::getNumArcs() const {
+    return (int) _head.size();
+}
+
+int NetworkTopology::arcsBegin(int v) const {
+    return _first[v];
+}
+
+int NetworkTopology::arcsEnd(int v) const {
+    return _first[v + 1];
+}
+
+int NetworkTopology::getHead(int arc) const {
+    return _head[arc];
+}
+
+int NetworkTopology::getTwin(int arc) const {
+    return _twin[arc];
+}
+
+Service NetworkTopology::getService(int arc) const {
+    return _service[arc];
+}
+
+bool NetworkTopology::isEdge(int arc) const {
+    return _isEdge[arc];
+}
+
+std::vector<int> NetworkTopology::depthFirstRanks(int source) const {
+    int n = getNumVertex();
+    std::vector<int> rank(n, -1);
+    int next_rank = 0;
+
+    // Iterative, keeping the next arc to try of each vertex in the stack
+    std::vector<std::pair<int, int>> stack;
+    rank[source] = next_rank++;
+    stack.emplace_back(source, arcsBegin(source));
+
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        if (top.second == arcsEnd(top.first)) {
+            stack.pop_back();
+            continue;
+        }
+
+        int w = getHead(top.second++);
+        if (rank[w] == -1) {
+            rank[w] = next_rank++;
+            stack.emplace_back(w, arcsBegin(w));
+        }
+    }
+
+    for (int v = 0; v < n; v++) {
+        if (rank[v] == -1) {
+            rank[v] = next_rank++;
+        }
+    }
+
+    return rank;
+}
+
+/*===== BasicFlowNetwork =====*/
+
+template <typename Capacity>
+BasicFlowNetwork<Capacity>::BasicFlowNetwork(const Graph& g): BasicFlowNetwork(g, std::vector<int>()) {}
+
+template <typename Capacity>
+BasicFlowNetwork<Capacity>::BasicFlowNetwork(const Graph& g, std::vector<int>&& weights)
+    : NetworkTopology(g, weights), _capacity(weights.begin(), weights.end()) {}
+
+template <typename Capacity>
+Capacity BasicFlowNetwork<Capacity>::getCapacity(int arc) const {
+    return _capacity[arc];
+}
+
+template <typename Capacity>
+bool BasicFlowNetwork<Capacity>::isSymmetric() const {
+    for (int a = 0; a < getNumArcs(); a++) {
+        if (_capacity[a] != _capacity[getTwin(a)]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Capacity>
+bool BasicFlowNetwork<Capacity>::prefersCapacityScaling() const {
+    Capacity min_capacity = std::numeric_limits<Capacity>::max(), max_capacity = 0;
+    for (int a = 0; a < getNumArcs(); a++) {
+        if (_capacity[a] > 0) {
+            min_capacity = std::min(min_capacity, _capacity[a]);
+            max_capacity = std::max(max_capacity, _capacity[a]);
+        }
+    }
+    return max_capacity / SCALING_SPREAD >= min_capacity;
+}
+
+template <typename Capacity>
+std::vector<int> BasicFlowNetwork<Capacity>::arrivalSources(int target) const {
+    // Find every station that can reach the target with a single search backwards from it
+    BitsetBFS bfs(*this);
+    bfs.search({target}, [this](int a) {
+        return getCapacity(getTwin(a)) > 0;
+    });
+
+    std::vector<int> sources;
+    for (int v = 0; v < getNumVertex(); v++) {
+        int edges = 0;
+        for (int a = arcsBegin(v); a < arcsEnd(v); a++) {
+            edges += isEdge(a);
+        }
+        if (v != target && edges == 1 && bfs.isVisited(v)) {
+            sources.push_back(v);
+        }
+    }
+    return sources;
+}
+
+template <typename Capacity>
+std::vector<Capacity> BasicFlowNetwork<Capacity>::maxFlowBatch(
+    const std::vector<std::pair<int, int>>& queries,
+    unsigned int numThreads
+) const {
+    TRACE_SPAN("maxFlowBatch", "flow");
+    std::vector<Capacity> results(queries.size(), -1);
+
+    // Group the queries by source
+    std::vector<size_t> order(queries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&queries](size_t a, size_t b) {
+        return queries[a].first < queries[b].first;
+    });
+
+    std::vector<size_t> group_begin;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i == 0 || queries[order[i]].first != queries[order[i - 1]].first) {
+            group_begin.push_back(i);
+        }
+    }
+    group_begin.push_back(order.size());
+
+    size_t num_groups = group_begin.size() - 1;
+    std::atomic<size_t> next_group(0);
+
+    utils::runWorkers(utils::numThreads(numThreads, num_groups), [&]() {
+        BasicMaxFlowSolver<Capacity> solver(*this);
+        solver.setWarmStart(true); // the queries of a group share the source
+
+        for (size_t group = next_group++; group < num_groups; group = next_group++) {
+            auto begin = order.begin() + group_begin[group];
+            auto end = order.begin() + group_begin[group + 1];
+
+            // Take the destinations in depth first order from the source, so each flow is close to the previous one
+            int source = queries[*begin].first;
+            if (source >= 0 && source < getNumVertex() && end - begin > 1) {
+                std::vector<int> rank = depthFirstRanks(source);
+                auto rank_of = [&rank](int v) {
+                    return v >= 0 && v < (int) rank.size() ? rank[v] : -1;
+                };
+                std::stable_sort(begin, end, [&queries, &rank_of](size_t a, size_t b) {
+                    return rank_of(queries[a].second) < rank_of(queries[b].second);
+                });
+            }
+
+            for (auto it = begin; it != end; it++) {
+                const auto &query = queries[*it];
+                results[*it] = solver.maxFlow(query.first, query.second);
+            }
+        }
+    });
+
+    return results;
+}
+
+template class BasicFlowNetwork<int>;
+template class BasicFlowNetwork<long long>;
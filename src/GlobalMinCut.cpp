@@ -0,0 +1,267 @@
+#include "GlobalMinCut.h"
+#include "FlowNetwork.h"
+#include "IndexedHeap.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+
+GlobalMinCut::GlobalMinCut(const Graph& g) {
+    FlowNetwork64 network(g);
+    int n = network.getNumVertex();
+    _adj.resize(n);
+    for (int v = 0; v < n; v++) {
+        _names.push_back(network.getName(v));
+        for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+            int twin = network.getTwin(a);
+            long long weight = std::max(network.getCapacity(a), network.getCapacity(twin));
+            if (a < twin && weight > 0) {
+                int w = network.getHead(a);
+                _adj[v].emplace_back(w, weight);
+                _adj[w].emplace_back(v, weight);
+            }
+        }
+    }
+
+    // Merge the parallel links
+    for (auto &adj: _adj) {
+        std::sort(adj.begin(), adj.end());
+        size_t merged = 0;
+        for (size_t i = 0; i < adj.size(); i++) {
+            if (merged > 0 && adj[merged - 1].first == adj[i].first) {
+                adj[merged - 1].second += adj[i].second;
+            } else {
+                adj[merged++] = adj[i];
+            }
+        }
+        adj.resize(merged);
+    }
+
+    std::vector<bool> visited(n, false);
+    for (int v = 0; v < n; v++) {
+        if (visited[v]) {
+            continue;
+        }
+
+        std::vector<int> component = {v};
+        visited[v] = true;
+        for (size_t i = 0; i < component.size(); i++) {
+            for (const auto &link: _adj[component[i]]) {
+                if (!visited[link.first]) {
+                    visited[link.first] = true;
+                    component.push_back(link.first);
+                }
+            }
+        }
+        std::sort(component.begin(), component.end());
+        _components.push_back(std::move(component));
+    }
+    std::stable_sort(_components.begin(), _components.end(), [](const auto& a, const auto& b) {
+        return a.size() > b.size();
+    });
+
+    _localIndex.resize(n);
+    for (const auto &component: _components) {
+        for (size_t i = 0; i < component.size(); i++) {
+            _localIndex[component[i]] = (int) i;
+        }
+    }
+}
+
+int GlobalMinCut::getNumComponents() const {
+    return (int) _components.size();
+}
+
+GlobalMinCut::Cut GlobalMinCut::cutComponent(const std::vector<int>& component, TaskControl* control) const {
+    int n = (int) component.size();
+
+    // Each station stands for the stations merged into it, kept in a list
+    std::vector<int> merged_into(n), next(n, -1), last(n);
+    std::iota(merged_into.begin(), merged_into.end(), 0);
+    std::iota(last.begin(), last.end(), 0);
+    auto find = [&merged_into](int v) {
+        while (merged_into[v] != v) {
+            merged_into[v] = merged_into[merged_into[v]];
+            v = merged_into[v];
+        }
+        return v;
+    };
+    auto merge = [&](int s, int t) {
+        merged_into[t] = s;
+        next[last[s]] = t;
+        last[s] = last[t];
+    };
+
+    // The lightest station against the rest is a first cut
+    long long best = std::numeric_limits<long long>::max();
+    std::vector<bool> in_side(n, false);
+    int lightest = 0;
+    for (int i = 0; i < n; i++) {
+        long long degree = 0;
+        for (const auto &link: _adj[component[i]]) {
+            degree += link.second;
+        }
+        if (degree < best) {
+            best = degree;
+            lightest = i;
+        }
+    }
+    in_side[lightest] = true;
+
+    // A link at least as heavy as a cut is not in any lighter cut, its stations are merged before the phases
+    // (Padberg-Rinaldi), in the sparse railway network this leaves few stations
+    for (int i = 0; i < n; i++) {
+        for (const auto &link: _adj[component[i]]) {
+            int u = find(i), w = find(_localIndex[link.first]);
+            if (link.second >= best && u != w) {
+                merge(u, w);
+            }
+        }
+    }
+
+    std::vector<std::vector<std::pair<int, long long>>> adj(n);
+    std::vector<int> active;
+    for (int i = 0; i < n; i++) {
+        int u = find(i);
+        if (u == i) {
+            active.push_back(i);
+        }
+        for (const auto &link: _adj[component[i]]) {
+            int w = find(_localIndex[link.first]);
+            if (w != u) {
+                adj[u].emplace_back(w, link.second);
+            }
+        }
+    }
+
+    IndexedHeap<long long> heap(n);
+    if (control != nullptr) {
+        control->advance((long long) (n - active.size()));
+    }
+
+    while (active.size() > 1) {
+        if (control != nullptr && control->isCancelled()) {
+            return {-1, {}, {}, {}};
+        }
+
+        // Maximum adjacency order: the next station is the one most connected to the ones before it
+        for (int v: active) {
+            heap.push(v, 0);
+        }
+        int s = -1, t = -1;
+        long long cut_of_phase = 0;
+        while (!heap.empty()) {
+            int u = heap.pop();
+            cut_of_phase = heap.getKey(u);
+            s = t;
+            t = u;
+            for (const auto &link: adj[u]) {
+                int w = find(link.first);
+                if (heap.contains(w)) {
+                    heap.increaseKey(w, heap.getKey(w) + link.second);
+                }
+            }
+        }
+
+        // The last station against all the others is the minimum cut between s and t
+        if (cut_of_phase < best) {
+            best = cut_of_phase;
+            std::fill(in_side.begin(), in_side.end(), false);
+            for (int v = t; v != -1; v = next[v]) {
+                in_side[v] = true;
+            }
+        }
+
+        // Merge t into s, dropping the links between them
+        merge(s, t);
+        adj[s].insert(adj[s].end(), adj[t].begin(), adj[t].end());
+        std::vector<std::pair<int, long long>>().swap(adj[t]);
+        adj[s].erase(std::remove_if(adj[s].begin(), adj[s].end(), [&find, s](const std::pair<int, long long>& link) {
+            return find(link.first) == s;
+        }), adj[s].end());
+        active.erase(std::find(active.begin(), active.end(), t));
+
+        if (control != nullptr) {
+            control->advance();
+        }
+    }
+
+    Cut cut = {best, {}, {}, {}};
+    describe(in_side, component, cut);
+    return cut;
+}
+
+void GlobalMinCut::describe(const std::vector<bool>& inSide, const std::vector<int>& component, Cut& cut) const {
+    size_t side_size = std::count(inSide.begin(), inSide.end(), true);
+    bool flip = side_size * 2 > component.size();
+
+    for (size_t i = 0; i < component.size(); i++) {
+        int v = component[i];
+        if (inSide[i] != flip) {
+            cut.side.push_back(_names[v]);
+            for (const auto &link: _adj[v]) {
+                if (inSide[_localIndex[link.first]] == flip) {
+                    cut.links.emplace_back(_names[v], _names[link.first]);
+                }
+            }
+        } else {
+            cut.otherSide.push_back(_names[v]);
+        }
+    }
+}
+
+GlobalMinCut::Cut GlobalMinCut::minCut(TaskControl* control) const {
+    TRACE_SPAN("GlobalMinCut::minCut", "analysis");
+    if (_names.size() < 2) {
+        return {-1, {}, {}, {}};
+    }
+
+    if (_components.size() > 1) {
+        // Already split, the smallest component is the side
+        std::vector<bool> in_side(_names.size(), false);
+        for (int v: _components.back()) {
+            in_side[v] = true;
+        }
+
+        Cut cut = {0, {}, {}, {}};
+        for (size_t v = 0; v < _names.size(); v++) {
+            (in_side[v] ? cut.side : cut.otherSide).push_back(_names[v]);
+        }
+        return cut;
+    }
+
+    if (control != nullptr) {
+        control->addWork((long long) _names.size() - 1);
+    }
+    return cutComponent(_components.front(), control);
+}
+
+std::vector<GlobalMinCut::Cut> GlobalMinCut::componentCuts(unsigned int numThreads, TaskControl* control) const {
+    TRACE_SPAN("GlobalMinCut::componentCuts", "analysis");
+    // The components are from the largest, the ones with a single station are at the end
+    size_t num_cuts = 0;
+    long long phases = 0;
+    while (num_cuts < _components.size() && _components[num_cuts].size() > 1) {
+        phases += (long long) _components[num_cuts++].size() - 1;
+    }
+    if (control != nullptr) {
+        control->addWork(phases);
+    }
+
+    std::vector<Cut> cuts(num_cuts, {-1, {}, {}, {}});
+    std::atomic<size_t> next_component(0);
+    utils::runWorkers(utils::numThreads(numThreads, num_cuts), [&]() {
+        for (size_t c = next_component++; c < num_cuts; c = next_component++) {
+            cuts[c] = cutComponent(_components[c], control);
+        }
+    });
+
+    // Only the components cut before a cancel
+    cuts.erase(std::remove_if(cuts.begin(), cuts.end(), [](const Cut& cut) {
+        return cut.value == -1;
+    }), cuts.end());
+    return cuts;
+}
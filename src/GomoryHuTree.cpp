@@ -0,0 +1,184 @@
+#include "GomoryHuTree.h"
+#include "MaxFlowSolver.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <limits>
+
+template <typename Capacity>
+GomoryHuTree::GomoryHuTree(const BasicFlowNetwork<Capacity>& network, TaskControl* control)
+    : _parent(network.getNumVertex(), 0), _weight(network.getNumVertex(), 0) {
+    TRACE_SPAN("GomoryHuTree", "analysis");
+    int n = network.getNumVertex();
+    if (n == 0) {
+        return;
+    }
+
+    BasicMaxFlowSolver<Capacity> solver(network);
+    _parent[0] = -1;
+    if (control) {
+        control->addWork(n - 1);
+    }
+
+    for (int s = 1; s < n; s++) {
+        if (control && control->isCancelled()) {
+            return;
+        }
+
+        int t = _parent[s];
+        Capacity flow = solver.maxFlow(s, t);
+        _weight[s] = flow == -1 ? 0 : flow;
+
+        // Vertexes on the same side of the cut as s now hang from s
+        for (int v = s + 1; v < n; v++) {
+            if (_parent[v] == t && solver.isOnSourceSide(v)) {
+                _parent[v] = s;
+            }
+        }
+
+        // Later vertexes only change the parents of the vertexes after them
+        _numFinal = s;
+        if (control) {
+            control->advance();
+        }
+    }
+}
+
+GomoryHuTree::GomoryHuTree(std::vector<int> parent, std::vector<long long> weight)
+    : _parent(std::move(parent)), _weight(std::move(weight)), _numFinal(std::max(0, (int) _parent.size() - 1)) {}
+
+int GomoryHuTree::getNumVertex() const {
+    return (int) _parent.size();
+}
+
+bool GomoryHuTree::isComplete() const {
+    return _numFinal == std::max(0, (int) _parent.size() - 1);
+}
+
+int GomoryHuTree::getNumFinal() const {
+    return _numFinal;
+}
+
+int GomoryHuTree::getParent(int v) const {
+    return _parent[v];
+}
+
+template GomoryHuTree::GomoryHuTree(const BasicFlowNetwork<int>& network, TaskControl* control);
+template GomoryHuTree::GomoryHuTree(const BasicFlowNetwork<long long>& network, TaskControl* control);
+
+long long GomoryHuTree::getWeight(int v) const {
+    return _weight[v];
+}
+
+long long GomoryHuTree::maxFlow(int source, int dest) const {
+    if (source == dest) {
+        return 0;
+    }
+
+    // Mark the path from the source to the root with the minimum weight so far
+    std::vector<long long> min_to_source(_parent.size(), -1);
+    long long min_weight = std::numeric_limits<long long>::max();
+    for (int v = source; v != -1; v = _parent[v]) {
+        min_to_source[v] = min_weight;
+        min_weight = std::min(min_weight, _weight[v]);
+    }
+
+    // Climb from the destination until the source path is found
+    min_weight = std::numeric_limits<long long>::max();
+    int v = dest;
+    for (; min_to_source[v] == -1; v = _parent[v]) {
+        min_weight = std::min(min_weight, _weight[v]);
+    }
+
+    return std::min(min_weight, min_to_source[v]);
+}
+
+std::vector<long long> GomoryHuTree::sumOfMaxFlows() const {
+    int n = (int) _parent.size();
+
+    // Join the tree edges from the heaviest to the lightest, when two components are joined by an edge of
+    // weight w that is the max flow between every vertex of one and every vertex of the other
+    std::vector<int> edges;
+    for (int v = 0; v < n; v++) {
+        if (_parent[v] != -1) {
+            edges.push_back(v);
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [this](int a, int b) {
+        return _weight[a] > _weight[b];
+    });
+
+    // Disjoint sets without path compression, the value of a vertex is the sum of the deltas up to its root.
+    // A weight times a component size does not fit in a long long, so the deltas are kept in 128 bits.
+    std::vector<int> up(n, -1);
+    std::vector<int> size(n, 1);
+    std::vector<__int128> delta(n, 0);
+
+    auto find = [&up](int v) {
+        while (up[v] != -1) {
+            v = up[v];
+        }
+        return v;
+    };
+
+    for (int e: edges) {
+        int a = find(e);
+        int b = find(_parent[e]);
+        __int128 w = _weight[e];
+
+        delta[a] += w * size[b];
+        delta[b] += w * size[a];
+
+        if (size[a] < size[b]) {
+            std::swap(a, b);
+        }
+        up[b] = a;
+        delta[b] -= delta[a];
+        size[a] += size[b];
+    }
+
+    std::vector<long long> sums(n, 0);
+    for (int v = 0; v < n; v++) {
+        __int128 sum = 0;
+        for (int u = v; u != -1; u = up[u]) {
+            sum += delta[u];
+        }
+        sums[v] = sum > std::numeric_limits<long long>::max() ? std::numeric_limits<long long>::max() : (long long) sum;
+    }
+
+    return sums;
+}
+
+std::vector<std::pair<int, int>> GomoryHuTree::maxFlowPairs() const {
+    int n = (int) _parent.size();
+    long long max_weight = 0;
+    for (int v = 0; v < n; v++) {
+        if (_parent[v] != -1) {
+            max_weight = std::max(max_weight, _weight[v]);
+        }
+    }
+    if (max_weight == 0) {
+        return {};
+    }
+
+    // The max flow of a pair is the lightest edge of its tree path, so the pairs with the largest one are the pairs
+    // of the components joined by the heaviest edges. Parents are smaller vertexes, so a component is labelled by
+    // its smallest vertex in index order.
+    std::vector<int> component(n);
+    std::vector<std::vector<int>> members(n);
+    for (int v = 0; v < n; v++) {
+        bool joined = _parent[v] != -1 && _weight[v] == max_weight;
+        component[v] = joined ? component[_parent[v]] : v;
+        members[component[v]].push_back(v);
+    }
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int v = 0; v < n; v++) {
+        for (int w: members[component[v]]) {
+            if (w != v) {
+                pairs.emplace_back(v, w);
+            }
+        }
+    }
+    return pairs;
+}
@@ -1,33 +1,189 @@
 #include "Graph.h"
-
+#include "AllPairsFlows.h"
+#include "FlowNetwork.h"
+#include "GomoryHuTree.h"
+#include "GraphKernels.h"
+#include "MaxFlowSolver.h"
+#include "Ranking.h"
+#include "RegionCentrality.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <limits>
+#include <sstream>
 #include <queue>
 #include <unordered_map>
 #include <iostream>
 
+namespace {
+    /**
+     * @brief Sources whose pairs are solved in the same batch when every ordered pair is solved
+     */
+    const int SOURCES_PER_BATCH = 16;
+
+    /**
+     * @brief Solve the max flow of every ordered pair of vertexes, for the networks where the flow equivalent tree
+     * does not apply (see BasicFlowNetwork::isSymmetric)
+     *
+     * @details Time Complexity: O(|V|³|E|²/T) where T is the number of threads
+     *
+     * @param network Network
+     * @param control Progress, one unit per source, if cancelled the sources left are not solved (optional)
+     * @param f Called with each pair (source, destination) and its max flow, by source and then destination
+     * @return true Every pair was solved
+     * @return false Cancelled
+     */
+    template <typename Capacity>
+    bool forEachPairFlow(
+        const BasicFlowNetwork<Capacity>& network,
+        TaskControl* control,
+        const std::function<void(int, int, long long)>& f
+    ) {
+        int n = network.getNumVertex();
+        if (control) {
+            control->addWork(n);
+        }
+
+        for (int first = 0; first < n; first += SOURCES_PER_BATCH) {
+            if (control && control->isCancelled()) {
+                return false;
+            }
+
+            int last = std::min(n, first + SOURCES_PER_BATCH);
+            std::vector<std::pair<int, int>> queries;
+            for (int s = first; s < last; s++) {
+                for (int t = 0; t < n; t++) {
+                    if (s != t) {
+                        queries.emplace_back(s, t);
+                    }
+                }
+            }
+
+            std::vector<Capacity> flows = network.maxFlowBatch(queries);
+            for (size_t i = 0; i < queries.size(); i++) {
+                f(queries[i].first, queries[i].second, std::max<long long>(0, flows[i]));
+            }
+            if (control) {
+                control->advance(last - first);
+            }
+        }
+        return true;
+    }
+}
+
 Graph::Graph(const Graph& g) {
-    for (auto v : g.getVertexSet()) {
-        addVertex(v->getStation());
+    TRACE_SPAN("copy graph", "scenario");
+    // Vertexes and edges are copied by position, mapping the pointers of g to the copies, without looking up names
+    std::unordered_map<const Vertex *, Vertex *> vertex_copy;
+    vertex_copy.reserve(g.vertexSet.size());
+    vertexSet.reserve(g.vertexSet.size());
+    _vertexIndex.reserve(g.vertexSet.size());
+    for (auto v : g.vertexSet) {
+        auto v_copy = new Vertex(v->getSharedStation());
+        v_copy->setIndex(vertexSet.size());
+        vertexSet.push_back(v_copy);
+        _vertexIndex.emplace(v->getStation().getName(), v_copy);
+        vertex_copy.emplace(v, v_copy);
     }
 
-    for (auto v : g.getVertexSet()) {
-        auto v_copy = findVertex(v->getStation().getName());
+    std::unordered_map<const Edge *, Edge *> edge_copy;
+    for (auto v : g.vertexSet) {
+        auto v_copy = vertex_copy[v];
         for (auto e : v->getAdj()) {
-            auto w = e->getDest();
-            auto w_copy = findVertex(w->getStation().getName());
-            addEdge(v_copy->getStation().getName(), w_copy->getStation().getName(), e->getWeight(), e->getService());
+            edge_copy.emplace(e, v_copy->addEdge(vertex_copy[e->getDest()], e->getWeight(), e->getService()));
         }
     }
+
+    // addEdge fills the incomming lists in the order of the origins, they are rebuilt in the order of g
+    for (auto v : g.vertexSet) {
+        auto v_copy = vertex_copy[v];
+        for (size_t i = 0; i < v->getIncomming().size(); i++) {
+            v_copy->_incomming[i] = edge_copy[v->getIncomming()[i]];
+        }
+        for (auto e : v->getAdj()) {
+            if (e->getReverse() != nullptr) {
+                edge_copy[e]->setReverse(edge_copy[e->getReverse()]);
+            }
+        }
+    }
+
+    // Same stations and links, so the same results
+    std::lock_guard<std::mutex> lock(g._allPairsMutex);
+    _allPairsFlows = g._allPairsFlows;
+    _cacheDirectory = g._cacheDirectory;
 }
 
-Vertex* Graph::findVertex(const std::string& stationName) const {
-    for (auto v: vertexSet) {
-        if (v->getStation().getName() == stationName) {
-            return v;
+bool Graph::readData(const std::string& stationsFile, const std::string& networkFile) {
+    TRACE_SPAN("readData", "load");
+    std::ifstream station_input(stationsFile);
+    std::ifstream network_input(networkFile);
+
+    if (!station_input.is_open() || !network_input.is_open()) {
+        return false;
+    }
+
+    std::string line;
+
+    // discard fist line of the files
+    getline(station_input, line);
+    getline(network_input, line);
+
+    while (getline(station_input, line)) {
+        std::stringstream ss(line);
+
+        std::string name, district, municipality, township, line;
+
+        getline(ss, name, ',');
+        getline(ss, district, ',');
+        getline(ss, municipality, ',');
+        getline(ss, township, ',');
+        getline(ss, line);
+
+        if (line.back() == '\r' || line.back() == '\n') {
+            line.pop_back(); // remove '\r' or '\n'
         }
+
+        addVertex(Station(
+            name,
+            district,
+            municipality,
+            township,
+            line
+        ));
     }
 
-    return nullptr;
+    while (getline(network_input, line)) {
+        std::stringstream ss(line);
+
+        std::string station_a, station_b, capacity_string, service;
+
+        getline(ss, station_a, ',');
+        getline(ss, station_b, ',');
+        getline(ss, capacity_string, ',');
+        getline(ss, service);
+
+        if (service.back() == '\r' || service.back() == '\n') {
+            service.pop_back(); // remove '\r' or '\n'
+        }
+
+        addBidirectionalEdge(
+            station_a,
+            station_b,
+            std::stoi(capacity_string) / 2,
+            service
+        );
+    }
+
+    return true;
+}
+
+Vertex* Graph::findVertex(const std::string& stationName) const {
+    auto it = _vertexIndex.find(stationName);
+    return it != _vertexIndex.end() ? it->second : nullptr;
 }
 
 bool Graph::addVertex(const Station& station) {
@@ -35,30 +191,41 @@ bool Graph::addVertex(const Station& station) {
         return false;
     }
 
+    invalidateResults();
     vertexSet.push_back(new Vertex(station));
+    vertexSet.back()->setIndex(vertexSet.size() - 1);
+    _vertexIndex.emplace(station.getName(), vertexSet.back());
+    journal({Change::Type::ADD_VERTEX, vertexSet.back(), nullptr, {}, 0});
     return true;
 }
 
 bool Graph::removeVertex(const std::string& station_name) {
+    TRACE_SPAN("removeVertex", "scenario");
     Vertex* v = findVertex(station_name);
     if (v == nullptr) {
         return false;
     }
     
-    for (auto e : v->getAdj()) {
-        auto w = e->getDest();
-        w->removeEdge(v->getStation());
-        v->removeEdge(w->getStation());
+    _flowSource = nullptr; // the flow may not be valid without the vertex
+    invalidateResults();
+
+    while (!v->getAdj().empty()) {
+        removeEdge(v->getAdj().back());
     }
-    
-    for (auto it = vertexSet.begin(); it != vertexSet.end(); it++) {
-        if ((*it)->getStation().getName() == station_name){
-            vertexSet.erase(it);
-            break;
-        }
+    while (!v->getIncomming().empty()) {
+        removeEdge(v->getIncomming().back());
     }
 
-    delete v;
+    // The last vertex takes its place
+    size_t position = v->getIndex();
+    vertexSet[position] = vertexSet.back();
+    vertexSet[position]->setIndex(position);
+    vertexSet.pop_back();
+    _vertexIndex.erase(station_name);
+
+    if (!journal({Change::Type::REMOVE_VERTEX, v, nullptr, {position, 0}, 0})) {
+        delete v;
+    }
     return true;
 }
 
@@ -69,7 +236,9 @@ bool Graph::addEdge(const std::string& source, const std::string& dest, int weig
         return false;
     }
 
-    v1->addEdge(v2, weight, service);
+    invalidateResults();
+    auto e = v1->addEdge(v2, weight, service);
+    journal({Change::Type::ADD_EDGE, nullptr, e, {}, 0});
     return true;
 }
 
@@ -80,244 +249,632 @@ bool Graph::addBidirectionalEdge(const std::string& source, const std::string& d
         return false;
     }
 
+    invalidateResults();
     auto e1 = v1->addEdge(v2, weight, service);
     auto e2 = v2->addEdge(v1, weight, service);
 
     e1->setReverse(e2);
     e2->setReverse(e1);
 
+    journal({Change::Type::ADD_EDGE, nullptr, e1, {}, 0});
+    journal({Change::Type::ADD_EDGE, nullptr, e2, {}, 0});
+    return true;
+}
+
+bool Graph::removeEdge(const std::string& source, const std::string& dest) {
+    auto v1 = findVertex(source);
+    auto v2 = findVertex(dest);
+    if (v1 == nullptr || v2 == nullptr) {
+        return false;
+    }
+
+    bool removed = false;
+    // From the back, the edge put in the place of a removed one was already checked
+    for (size_t i = v1->getAdj().size(); i-- > 0;) {
+        Edge* e = v1->getAdj()[i];
+        if (e->getDest() == v2) {
+            removeEdge(e);
+            removed = true;
+        }
+    }
+
+    if (removed) {
+        _flowSource = nullptr; // the flow may not be valid without the edges
+        invalidateResults();
+    }
+    return removed;
+}
+
+bool Graph::setEdgeWeight(const std::string& source, const std::string& dest, int weight) {
+    auto v1 = findVertex(source);
+    auto v2 = findVertex(dest);
+    if (v1 == nullptr || v2 == nullptr || weight < 0) {
+        return false;
+    }
+
+    bool changed = false;
+    for (auto e : v1->getAdj()) {
+        if (e->getDest() == v2) {
+            journal({Change::Type::SET_WEIGHT, nullptr, e, {}, e->getWeight()});
+            e->setWeight(weight);
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        _flowSource = nullptr; // the flow may be over the new weight
+        invalidateResults();
+    }
+    return changed;
+}
+
+void Graph::removeEdge(Edge* edge) {
+    auto positions = edge->getOrigin()->detachEdge(edge);
+
+    Edge* reverse = edge->getReverse();
+    if (reverse != nullptr && reverse->getReverse() == edge) {
+        reverse->setReverse(nullptr);
+    }
+
+    if (!journal({Change::Type::REMOVE_EDGE, nullptr, edge, positions, 0})) {
+        delete edge;
+    }
+}
+
+bool Graph::journal(const Change& change) {
+    if (!_journaling) {
+        return false;
+    }
+    _journal.push_back(change);
     return true;
 }
 
-int Graph::edmondsKarp(const std::string& source, const std::string& dest) const {
+void Graph::undo(const Change& change) {
+    switch (change.type) {
+        case Change::Type::ADD_VERTEX:
+            // The last vertex, its edges were undone before
+            vertexSet.pop_back();
+            _vertexIndex.erase(change.vertex->getStation().getName());
+            delete change.vertex;
+            break;
+        case Change::Type::REMOVE_VERTEX: {
+            size_t position = change.positions.first;
+            if (position == vertexSet.size()) {
+                vertexSet.push_back(change.vertex);
+            } else {
+                vertexSet.push_back(vertexSet[position]);
+                vertexSet.back()->setIndex(vertexSet.size() - 1);
+                vertexSet[position] = change.vertex;
+            }
+            change.vertex->setIndex(position);
+            _vertexIndex.emplace(change.vertex->getStation().getName(), change.vertex);
+            break;
+        }
+        case Change::Type::ADD_EDGE: {
+            change.edge->getOrigin()->detachEdge(change.edge);
+            Edge* reverse = change.edge->getReverse();
+            if (reverse != nullptr && reverse->getReverse() == change.edge) {
+                reverse->setReverse(nullptr);
+            }
+            delete change.edge;
+            break;
+        }
+        case Change::Type::REMOVE_EDGE:
+            change.edge->getOrigin()->attachEdge(change.edge, change.positions);
+            if (change.edge->getReverse() != nullptr) {
+                change.edge->getReverse()->setReverse(change.edge);
+            }
+            break;
+        case Change::Type::SET_WEIGHT:
+            change.edge->setWeight(change.weight);
+            break;
+    }
+}
+
+size_t Graph::checkpoint() {
+    _journaling = true;
+    return _journal.size();
+}
+
+bool Graph::rollback(size_t checkpoint) {
+    if (checkpoint > _journal.size()) {
+        return false;
+    }
+
+    if (checkpoint < _journal.size()) {
+        _flowSource = nullptr;
+        invalidateResults();
+    }
+    while (_journal.size() > checkpoint) {
+        undo(_journal.back());
+        _journal.pop_back();
+    }
+    return true;
+}
+
+void Graph::commitChanges() {
+    for (const Change& change: _journal) {
+        if (change.type == Change::Type::REMOVE_VERTEX) {
+            delete change.vertex;
+        } else if (change.type == Change::Type::REMOVE_EDGE) {
+            delete change.edge;
+        }
+    }
+    _journal.clear();
+    _journaling = false;
+}
+
+int Graph::edmondsKarp(const std::string& source, const std::string& dest, bool capacityScaling, bool warmStart) const {
+    TRACE_SPAN("edmondsKarp", "flow");
+    Vertex* s;
+    Vertex* t;
+    {
+        STATS_PHASE(LOOKUP);
+        s = findVertex(source);
+        t = findVertex(dest);
+    }
+
+    // Check if source and destination are valid
+    if (s == nullptr || t == nullptr || s == t) {
+        return -1;
+    }
+
+    AdjacencyStorage storage(*this);
+    int max_flow;
+    if (warmStart && _flowSource == s) {
+        max_flow = kernels::edmondsKarpWarm<TrainCapacity>(storage, s, _flowDest, t, capacityScaling);
+    } else {
+        max_flow = kernels::edmondsKarp<TrainCapacity>(storage, s, t, capacityScaling);
+    }
+
+    _flowSource = s;
+    _flowDest = t;
+
+    return (max_flow ? max_flow : -1);
+}
+
+/**
+ * @brief Solve a batch of station pairs on a flow network
+ */
+template <typename Capacity>
+static std::vector<long long> solveBatch(
+    const BasicFlowNetwork<Capacity>& network,
+    const std::vector<std::pair<std::string, std::string>>& queries,
+    unsigned int numThreads
+) {
+    std::vector<std::pair<int, int>> index_queries;
+    index_queries.reserve(queries.size());
+    for (const auto &query: queries) {
+        index_queries.emplace_back(network.findIndex(query.first), network.findIndex(query.second));
+    }
+
+    std::vector<Capacity> results = network.maxFlowBatch(index_queries, numThreads);
+    return std::vector<long long>(results.begin(), results.end());
+}
+
+std::vector<long long> Graph::edmondsKarpBatch(
+    const std::vector<std::pair<std::string, std::string>>& queries,
+    unsigned int numThreads
+) const {
+    if (NetworkTopology::needsWideCapacity(*this)) {
+        return solveBatch(FlowNetwork64(*this), queries, numThreads);
+    }
+    return solveBatch(FlowNetwork(*this), queries, numThreads);
+}
+
+int Graph::decomposeFlow(
+    const std::string& source,
+    const std::string& dest,
+    const std::function<void(const std::vector<Vertex *>&, int)>& callback
+) const {
     auto s = findVertex(source);
     auto t = findVertex(dest);
 
-    // Check if source and destination are valid
     if (s == nullptr || t == nullptr || s == t) {
         return -1;
     }
 
-    // Reset the flow in the edges
+    _flowSource = nullptr; // the flow is consumed
+
+    // Cancel flow going both ways between the same pair of stations
     for (auto v: vertexSet) {
         for (auto e: v->getAdj()) {
-            e->setFlow(0);
+            auto r = e->getReverse();
+            if (r != nullptr && e->getFlow(_flowEpoch) > 0 && r->getFlow(_flowEpoch) > 0) {
+                int cancelled = std::min(e->getFlow(_flowEpoch), r->getFlow(_flowEpoch));
+                e->setFlow(e->getFlow(_flowEpoch) - cancelled, _flowEpoch);
+                r->setFlow(r->getFlow(_flowEpoch) - cancelled, _flowEpoch);
+            }
         }
     }
 
-    int max_flow = 0;
+    std::vector<Vertex *> path;
+    std::vector<Edge *> path_edges;
+    int num_paths = 0;
 
-    while (findAugmentingPath(s, t)) {
-        int pathFlow = std::numeric_limits<int>::max();
+    path.push_back(s);
+    s->setProcessing(true);
 
-        // Find the minimum flow in the path
-        for (auto v = t; v != s;) {
-            auto e = v->getPath();
-            if (e->getDest() == v) {
-                pathFlow = std::min(pathFlow, e->getWeight() - e->getFlow());
-                v = e->getOrigin();
-            } else {
-                pathFlow = std::min(pathFlow, e->getFlow());
-                v = e->getDest();
+    while (true) {
+        auto u = path.back();
+
+        if (u == t) {
+            int trains = std::numeric_limits<int>::max();
+            for (auto e: path_edges) {
+                trains = std::min(trains, e->getFlow(_flowEpoch));
+            }
+            for (auto e: path_edges) {
+                e->setFlow(e->getFlow(_flowEpoch) - trains, _flowEpoch);
+            }
+
+            callback(path, trains);
+            num_paths++;
+
+            // Restart from the source
+            for (auto v: path) {
+                v->setProcessing(false);
             }
+            path.resize(1);
+            path_edges.clear();
+            s->setProcessing(true);
+            continue;
         }
 
-        // Update the flow in the path
-        for (auto v = t; v != s;) {
-            auto e = v->getPath();
-            if (e->getDest() == v) {
-                e->setFlow(e->getFlow() + pathFlow);
-                v = e->getOrigin();
-            } else {
-                e->setFlow(e->getFlow() - pathFlow);
-                v = e->getDest();
+        Edge* next = nullptr;
+        for (auto e: u->getAdj()) {
+            if (e->getFlow(_flowEpoch) > 0) {
+                next = e;
+                break;
             }
         }
 
-        max_flow += pathFlow;
-    }
+        if (next == nullptr) {
+            // No more flow leaving the source, or flow is not conserved in u
+            break;
+        }
 
-    return (max_flow ? max_flow : -1);
-}
+        auto w = next->getDest();
+        path_edges.push_back(next);
 
-std::vector<std::pair<std::pair<std::string, std::string>, int>> Graph::getMaxTrainCapacityPairs() const {
-    std::vector<std::pair<std::pair<std::string, std::string>, int>> max_pairs;
-    std::unordered_map<std::string, int> memo_max_flow; // Memoization of max flow between two stations
-    int max_num_trains = 0;
+        if (!w->isProcessing()) {
+            w->setProcessing(true);
+            path.push_back(w);
+            continue;
+        }
 
-    for (const auto &source: vertexSet) {
-        for (const auto &dest: vertexSet) {
-            std::string source_name = source->getStation().getName();
-            std::string dest_name = dest->getStation().getName();
-            int num_trains = -1;
+        // w is already in the path, cancel the cycle w -> ... -> u -> w
+        size_t pos = path.size() - 1;
+        while (path[pos] != w) {
+            pos--;
+        }
 
-            if (memo_max_flow.find(source_name + dest_name) != memo_max_flow.end()) {
-                num_trains = memo_max_flow[source_name + dest_name];
-            } else {
-                num_trains = edmondsKarp(source_name, dest_name);
+        int cycle_flow = std::numeric_limits<int>::max();
+        for (size_t i = pos; i < path_edges.size(); i++) {
+            cycle_flow = std::min(cycle_flow, path_edges[i]->getFlow(_flowEpoch));
+        }
+        for (size_t i = pos; i < path_edges.size(); i++) {
+            path_edges[i]->setFlow(path_edges[i]->getFlow(_flowEpoch) - cycle_flow, _flowEpoch);
+        }
 
-                memo_max_flow[source_name + dest_name] = num_trains;
-                memo_max_flow[dest_name + source_name] = num_trains;
-            }
+        for (size_t i = pos + 1; i < path.size(); i++) {
+            path[i]->setProcessing(false);
+        }
+        path.resize(pos + 1);
+        path_edges.resize(pos);
+    }
+
+    for (auto v: path) {
+        v->setProcessing(false);
+    }
+
+    return num_paths;
+}
 
+std::vector<std::pair<std::pair<std::string, std::string>, long long>> Graph::getMaxTrainCapacityPairs(
+    TaskControl* control
+) const {
+    TRACE_SPAN("getMaxTrainCapacityPairs", "analysis");
+    std::vector<std::pair<std::pair<std::string, std::string>, long long>> max_pairs;
+    std::vector<std::pair<std::pair<int, int>, long long>> computed;
+    std::shared_ptr<const AllPairsFlows> flows = getAllPairsFlows(control, &computed);
+    auto add_pair = [this, &max_pairs](int i, int j, long long num_trains) {
+        max_pairs.push_back(std::make_pair(std::make_pair(vertexSet[i]->getStation().getName(), vertexSet[j]->getStation().getName()), num_trains));
+    };
+
+    if (!flows && (control == nullptr || !control->isCancelled())) {
+        // Not the same capacity both ways, every ordered pair is solved and compared
+        long long max_num_trains = 0;
+        std::vector<std::pair<int, int>> best;
+        auto compare = [&max_num_trains, &best](int i, int j, long long num_trains) {
             if (num_trains > max_num_trains) {
-                max_pairs.clear();
-                max_pairs.push_back(std::make_pair(std::make_pair(source_name, dest_name), num_trains));
+                best.clear();
                 max_num_trains = num_trains;
-            } else if (num_trains == max_num_trains) {
-                max_pairs.push_back(std::make_pair(std::make_pair(source_name, dest_name), num_trains));
             }
+            if (num_trains > 0 && num_trains == max_num_trains) {
+                best.emplace_back(i, j);
+            }
+        };
+        if (NetworkTopology::needsWideCapacity(*this)) {
+            forEachPairFlow(FlowNetwork64(*this), control, compare);
+        } else {
+            forEachPairFlow(FlowNetwork(*this), control, compare);
+        }
+
+        // If cancelled, the best pairs of the sources solved so far
+        for (const auto &pair: best) {
+            add_pair(pair.first, pair.second, max_num_trains);
+        }
+        return max_pairs;
+    }
+
+    if (!flows) {
+        // Cancelled, only the pairs computed so far are compared
+        long long max_num_trains = 0;
+        for (const auto &pair: computed) {
+            max_num_trains = std::max(max_num_trains, pair.second);
+        }
+
+        std::vector<std::pair<int, int>> best;
+        for (const auto &pair: computed) {
+            if (max_num_trains > 0 && pair.second == max_num_trains) {
+                best.push_back(pair.first);
+                best.emplace_back(pair.first.second, pair.first.first);
+            }
+        }
+        std::sort(best.begin(), best.end());
+        for (const auto &pair: best) {
+            add_pair(pair.first, pair.second, max_num_trains);
         }
+        return max_pairs;
     }
 
+    const GomoryHuTree& tree = flows->getTree();
+    std::vector<std::pair<int, int>> best = tree.maxFlowPairs();
+    long long max_num_trains = best.empty() ? 0 : tree.maxFlow(best[0].first, best[0].second);
+    for (const auto &pair: best) {
+        add_pair(pair.first, pair.second, max_num_trains);
+    }
     return max_pairs;
 }
 
-void Graph::findTopMunicipalitiesAndDistricts(
-    int k,
-    std::vector<std::string> &municipalities,
-    std::vector<std::string> &districts
+void Graph::invalidateResults() {
+    _allPairsFlows = nullptr;
+}
+
+void Graph::setCacheDirectory(const std::string& directory) {
+    _cacheDirectory = directory;
+}
+
+std::shared_ptr<const AllPairsFlows> Graph::getAllPairsFlows(
+    TaskControl* control,
+    std::vector<std::pair<std::pair<int, int>, long long>>* computed
 ) const {
-    std::unordered_map<std::string, int> municipalitiesFlow;
-    std::unordered_map<std::string, int> districtsFlow;
-    std::unordered_map<std::string, int> memo_max_flow; // Memoization of max flow between two stations
-
-    // Find the highest flow for each municipality and district
-    for (const auto &source: vertexSet) {
-        for (const auto &dest: vertexSet) {
-            std::string source_name = source->getStation().getName();
-            std::string dest_name = dest->getStation().getName();
-            int num_trains = -1;
-
-            if (memo_max_flow.find(source_name + dest_name) != memo_max_flow.end()) {
-                num_trains = memo_max_flow[source_name + dest_name];
-            } else {
-                num_trains = edmondsKarp(source_name, dest_name);
+    std::lock_guard<std::mutex> lock(_allPairsMutex);
+    if (_allPairsFlows) {
+        return _allPairsFlows;
+    }
+
+    TRACE_SPAN("getAllPairsFlows", "analysis");
+    auto compute = [this, control, computed](const auto& network) {
+        if (!network.isSymmetric()) {
+            return; // the flow equivalent tree does not apply, nothing is kept
+        }
 
-                memo_max_flow[source_name + dest_name] = num_trains;
-                memo_max_flow[dest_name + source_name] = num_trains;
+        int n = network.getNumVertex();
+        uint64_t fingerprint = AllPairsFlows::fingerprint(network);
+        std::string path;
+        if (!_cacheDirectory.empty()) {
+            std::ostringstream file_name;
+            file_name << std::hex << fingerprint << ".flows";
+            path = (std::filesystem::path(_cacheDirectory) / file_name.str()).string();
+
+            _allPairsFlows = AllPairsFlows::load(path, n, fingerprint);
+            if (_allPairsFlows) {
+                return;
             }
+        }
 
-            if (num_trains != -1) {
-                auto municipality = source->getStation().getMunicipality();
-                auto district = source->getStation().getDistrict();
+        GomoryHuTree tree(network, control);
+        if (!tree.isComplete()) {
+            // Cancelled, the final tree edges are pairs with their max flow
+            for (int v = 1; computed && v <= tree.getNumFinal(); v++) {
+                computed->push_back({{v, tree.getParent(v)}, tree.getWeight(v)});
+            }
+            return;
+        }
 
-                if (municipalitiesFlow.find(municipality) == municipalitiesFlow.end()) {
-                    municipalitiesFlow[municipality] = 0;
+        auto flows = std::make_shared<AllPairsFlows>(std::move(tree), fingerprint);
+        if (!path.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(_cacheDirectory, error);
+            flows->save(path); // the flows are still used if the cache can't be written
+        }
+        _allPairsFlows = std::move(flows);
+    };
+
+    if (NetworkTopology::needsWideCapacity(*this)) {
+        compute(FlowNetwork64(*this));
+    } else {
+        compute(FlowNetwork(*this));
+    }
+    return _allPairsFlows;
+}
+
+void Graph::findTopMunicipalitiesAndDistricts(
+    int k,
+    std::vector<std::string> &municipalities,
+    std::vector<std::string> &districts,
+    bool regionPairs,
+    const std::function<void(const std::vector<std::string>&, bool, double)>& onProgress,
+    TaskControl* control
+) const {
+    TRACE_SPAN("findTopMunicipalitiesAndDistricts", "analysis");
+    RegionCentrality centrality(*this);
+    std::vector<std::pair<std::string, long long>> municipalitiesFlow;
+    std::vector<std::pair<std::string, long long>> districtsFlow;
+
+    if (regionPairs) {
+        // Report the provisional top k while the region pairs are solved
+        auto report = [k, &onProgress](bool districts) {
+            return [k, districts, &onProgress](const Ranking<std::string, long long> &ranking, double progress) {
+                if (!onProgress) {
+                    return;
                 }
-                if (districtsFlow.find(district) == districtsFlow.end()) {
-                    districtsFlow[district] = 0;
+
+                std::vector<std::string> top;
+                for (const auto &region: ranking.top(k)) {
+                    top.push_back(region.first);
                 }
-                
-                municipalitiesFlow[municipality] += num_trains;
-                districtsFlow[district] += num_trains;
+                onProgress(top, districts, progress);
+            };
+        };
+
+        // The work of both levels is declared at once, so the progress does not go back when the districts start
+        if (control) {
+            control->addWork(centrality.getNumRegionPairs(RegionCentrality::MUNICIPALITY)
+                             + centrality.getNumRegionPairs(RegionCentrality::DISTRICT));
+        }
+        municipalitiesFlow = centrality.regionPairsScores(RegionCentrality::MUNICIPALITY, 0, report(false), control);
+        if (!control || !control->isCancelled()) {
+            districtsFlow = centrality.regionPairsScores(RegionCentrality::DISTRICT, 0, report(true), control);
+        }
+    } else {
+        std::vector<long long> sums;
+        std::shared_ptr<const AllPairsFlows> flows = getAllPairsFlows(control);
+        if (flows) {
+            sums = flows->getTree().sumOfMaxFlows();
+        } else if (control == nullptr || !control->isCancelled()) {
+            // Not the same capacity both ways, the flows from each station to every other one are summed
+            sums.assign(vertexSet.size(), 0);
+            auto add = [&sums](int i, int, long long num_trains) {
+                utils::checkedAdd(sums[i], num_trains);
+            };
+            bool solved = NetworkTopology::needsWideCapacity(*this)
+                ? forEachPairFlow(FlowNetwork64(*this), control, add)
+                : forEachPairFlow(FlowNetwork(*this), control, add);
+            if (!solved) {
+                return; // cancelled, every score needs all the pairs
             }
+        } else {
+            return; // cancelled, every score needs all the pairs
         }
+
+        auto scores = centrality.stationPairsScores(
+            {RegionCentrality::MUNICIPALITY, RegionCentrality::DISTRICT},
+            sums
+        );
+        municipalitiesFlow = std::move(scores[0]);
+        districtsFlow = std::move(scores[1]);
     }
 
     // Find the top k municipalities and districts
-    auto cmp = [](const std::pair<std::string, int> &a, const std::pair<std::string, int> &b) {
-        return a.second > b.second;
-    };
-    std::priority_queue<
-        std::pair<std::string, int>,
-        std::vector<std::pair<std::string, int>>,
-        decltype(cmp)
-    > pq(cmp);
-
-    for (const auto &municipality: municipalitiesFlow) {
-        pq.push(municipality);
-        if (pq.size() > k) {
-            pq.pop();
-        }
+    for (const auto &municipality: topK(std::move(municipalitiesFlow), k)) {
+        municipalities.push_back(municipality.first);
     }
 
-    while (!pq.empty()) {
-        municipalities.insert(municipalities.begin(), pq.top().first);
-        pq.pop();
+    for (const auto &district: topK(std::move(districtsFlow), k)) {
+        districts.push_back(district.first);
     }
+}
 
-    for (const auto &district: districtsFlow) {
-        pq.push(district);
-        if (pq.size() > k) {
-            pq.pop();
-        }
+/**
+ * @brief Solve the trains arriving at a station on a flow network
+ */
+template <typename Capacity>
+static Capacity arrivingFlow(const BasicFlowNetwork<Capacity>& network, const std::string& stationName) {
+    int target = network.findIndex(stationName);
+    if (target == -1) {
+        return -1;
     }
 
-    while (!pq.empty()) {
-        districts.insert(districts.begin(), pq.top().first);
-        pq.pop();
-    }
+    // Terminal stations (with a single connection) are the sources, as if linked to a super source with unlimited capacity
+    std::vector<int> sources = network.arrivalSources(target);
+
+    BasicMaxFlowSolver<Capacity> solver(network);
+    return solver.maxFlow(sources, {target}, network.prefersCapacityScaling());
 }
 
-void Graph::dijkstra (Vertex *source) {
-    auto cmp = [](Vertex *a, Vertex *b) {
-        return a->getDistance() > b->getDistance();
-    };
-    std::priority_queue<Vertex *, std::vector<Vertex *>, decltype(cmp)> pq(cmp);
-
-    for (auto v : vertexSet) {
-        v->setVisited(false);
-        v->setDistance(std::numeric_limits<int>::max());
-    }
-
-    source->setDistance(0);
-    pq.push(source);
-    while (!pq.empty()) {
-        Vertex * u = pq.top(); pq.pop();
-        u->setVisited(true);
-
-        for (auto e : u->getAdj()) {
-            Vertex* v = e->getDest();
-            int w = e->getService() == "STANDARD" ? 2 : 4;
-            if (!v->isVisited() && u->getDistance() != std::numeric_limits<int>::max() && (u->getDistance() + w < v->getDistance())) {
-                v->setDistance(u->getDistance() + w);
-                v->setPath(e);
-                pq.push(v);
-            }
-        }
+int Graph::maxTrainsArriving(const std::string& stationName) const {
+    TRACE_SPAN("maxTrainsArriving", "flow");
+    if (NetworkTopology::needsWideCapacity(*this)) {
+        // The flow may not fit in an int, it saturates like a 32 bit flow that does not fit
+        long long max_flow = arrivingFlow(FlowNetwork64(*this), stationName);
+        return (int) std::min<long long>(max_flow, std::numeric_limits<int>::max());
     }
+    return arrivingFlow(FlowNetwork(*this), stationName);
 }
 
-int Graph::getNumVertex() const {
-    return this->vertexSet.size();
+void Graph::dijkstra(Vertex *source) {
+    AdjacencyStorage storage(*this);
+    kernels::dijkstra<ServiceCost>(storage, source);
 }
 
-std::vector<Vertex *> Graph::getVertexSet() const {
-    return this->vertexSet;
+int Graph::getDistance(const Vertex *v) const {
+    return v->getDistance(_distanceEpoch);
 }
 
-/* Utils */
+int Graph::getPathCapacity(const Vertex *v) const {
+    if (getDistance(v) == std::numeric_limits<int>::max()) {
+        return -1;
+    }
 
-bool Graph::findAugmentingPath(Vertex *source, Vertex *dest) const {
-    for (auto v: vertexSet) {
-        v->setVisited(false);
+    int capacity = std::numeric_limits<int>::max();
+    for (const Vertex* temp = v; getDistance(temp) != 0; temp = temp->getPath()->getOrigin()) {
+        capacity = std::min(capacity, temp->getPath()->getWeight());
     }
-    source->setVisited(true);
-    std::queue<Vertex *> q;
-    q.push(source);
+    return capacity;
+}
 
-    while (!q.empty() && !dest->isVisited()) {
-        auto v = q.front(); q.pop();
+int Graph::getFlow(const Edge* e) const {
+    return e->getFlow(_flowEpoch);
+}
 
-        for (auto e: v->getAdj()) {
-            auto w = e->getDest();
-            if (!w->isVisited() && e->getWeight() - e->getFlow() > 0) {
-                w->setVisited(true);
-                w->setPath(e);
-                q.push(w);
+void Graph::resetFlow() const {
+    if (++_flowEpoch == 0) {
+        // Epoch wrapped around, clear the old marks once
+        for (auto v: vertexSet) {
+            for (auto e: v->getAdj()) {
+                e->setFlow(0, 0);
             }
         }
+        _flowEpoch = 1;
+    }
+}
 
-        for (auto e: v->getIncomming()) {
-            auto w = e->getOrigin();
-            if (!w->isVisited() && e->getFlow() > 0) {
-                w->setVisited(true);
-                w->setPath(e);
-                q.push(w);
-            }
+unsigned int Graph::newVisitEpoch() const {
+    if (++_visitEpoch == 0) {
+        // Epoch wrapped around, clear the old marks once
+        for (auto v: vertexSet) {
+            v->setVisited(0);
         }
+        _visitEpoch = 1;
     }
+    return _visitEpoch;
+}
+
+unsigned int Graph::newDistanceEpoch() const {
+    if (++_distanceEpoch == 0) {
+        // Epoch wrapped around, clear the old marks once
+        for (auto v: vertexSet) {
+            v->setDistance(std::numeric_limits<int>::max(), 0);
+        }
+        _distanceEpoch = 1;
+    }
+    return _distanceEpoch;
+}
+
+int Graph::getNumVertex() const {
+    return this->vertexSet.size();
+}
+
+std::vector<Vertex *> Graph::getVertexSet() const {
+    return this->vertexSet;
+}
+
+/* Utils */
 
-    return dest->isVisited();
+bool Graph::findAugmentingPath(Vertex *source, Vertex *dest, int delta) const {
+    AdjacencyStorage storage(*this);
+    std::vector<Vertex *> queue;
+    return kernels::findAugmentingPath<TrainCapacity>(storage, source, dest, delta, queue);
 }
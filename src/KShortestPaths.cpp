@@ -0,0 +1,207 @@
+#include "KShortestPaths.h"
+#include "CostPolicy.h"
+#include "GraphKernels.h"
+#include "GraphStorage.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <queue>
+
+namespace {
+    /**
+     * @brief Route as arcs of the network
+     */
+    struct Route {
+        std::vector<int> arcs;
+        int cost;
+
+        /**
+         * @brief Index of the station where the route left its parent, the spurs start there
+         */
+        size_t deviation;
+    };
+
+    /**
+     * @brief Bound of the vertexes that can't reach the destination, large but safe to add a cost to
+     */
+    const int UNREACHABLE = std::numeric_limits<int>::max() / 2;
+}
+
+KShortestPaths::KShortestPaths(const Graph& g): _network(g) {}
+
+std::vector<KShortestPaths::Path> KShortestPaths::find(
+    const std::string& source,
+    const std::string& dest,
+    int k,
+    unsigned int numThreads,
+    TaskControl* control
+) const {
+    TRACE_SPAN("KShortestPaths", "cost");
+    int s = _network.findIndex(source);
+    int t = _network.findIndex(dest);
+    if (s == -1 || t == -1 || s == t || k <= 0) {
+        return {};
+    }
+
+    // Cost from each station to the destination and the first arc of that route, searching backwards
+    int n = _network.getNumVertex();
+    std::vector<int> to_dest(n, UNREACHABLE), next_arc(n, -1);
+    {
+        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> pq;
+        to_dest[t] = 0;
+        pq.emplace(0, t);
+        while (!pq.empty()) {
+            auto item = pq.top(); pq.pop();
+            int v = item.second;
+            if (item.first != to_dest[v]) {
+                continue;
+            }
+
+            for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+                int twin = _network.getTwin(a);
+                int w = _network.getHead(a);
+                int cost = to_dest[v] + ServiceCost::cost(_network.getService(twin));
+                if (_network.isEdge(twin) && cost < to_dest[w]) {
+                    to_dest[w] = cost;
+                    next_arc[w] = twin;
+                    pq.emplace(cost, w);
+                }
+            }
+        }
+    }
+    if (to_dest[s] == UNREACHABLE) {
+        return {};
+    }
+
+    auto tail = [this](int a) {
+        return _network.getHead(_network.getTwin(a));
+    };
+
+    std::vector<Route> routes = {{{}, to_dest[s], 0}};
+    for (int v = s; v != t; v = _network.getHead(next_arc[v])) {
+        routes[0].arcs.push_back(next_arc[v]);
+    }
+
+    // Candidates by cost, then by their arcs, with where they left their parent
+    std::map<std::pair<int, std::vector<int>>, size_t> candidates;
+
+    // One storage per thread, kept for every search
+    unsigned int max_threads = utils::numThreads(numThreads, n);
+    std::vector<std::unique_ptr<OverlayStorage<int>>> storages(max_threads);
+
+    if (control != nullptr) {
+        control->addWork(k - 1);
+    }
+    while ((int) routes.size() < k) {
+        if (control != nullptr && control->isCancelled()) {
+            break;
+        }
+
+        const Route& last = routes.back();
+        std::vector<int> stations = {s};
+        std::vector<int> root_cost = {0};
+        for (int a: last.arcs) {
+            stations.push_back(_network.getHead(a));
+            root_cost.push_back(root_cost.back() + ServiceCost::cost(_network.getService(a)));
+        }
+
+        // A spur route from each station of the route from its deviation, the last station is the destination
+        size_t num_spurs = last.arcs.size() - last.deviation;
+        std::vector<Route> spurs(num_spurs, {{}, -1, 0});
+        std::atomic<size_t> next_spur(0);
+        std::atomic<unsigned int> next_storage(0);
+        utils::runWorkers(utils::numThreads(max_threads, num_spurs), [&]() {
+            auto& storage = storages[next_storage++];
+            if (!storage) {
+                storage = std::make_unique<OverlayStorage<int>>(_network);
+            }
+            OverlayStorage<int>& overlay = *storage;
+
+            for (size_t j = next_spur++; j < num_spurs; j = next_spur++) {
+                size_t i = last.deviation + j;
+                int spur = stations[i];
+
+                // The next link of every route with the same root, and the root stations
+                std::vector<int> removed_links;
+                for (const Route& route: routes) {
+                    if (route.arcs.size() > i && std::equal(last.arcs.begin(), last.arcs.begin() + (long) i, route.arcs.begin())) {
+                        removed_links.push_back(route.arcs[i]);
+                        overlay.removeLink(route.arcs[i]);
+                    }
+                }
+                for (size_t r = 0; r < i; r++) {
+                    overlay.removeVertex(stations[r]);
+                }
+
+                // The route of the tree if it is still there, the search otherwise
+                std::vector<int> spur_arcs;
+                int spur_cost = to_dest[spur];
+                for (int v = spur; v != t && spur_cost != UNREACHABLE; v = _network.getHead(next_arc[v])) {
+                    if (overlay.isArcRemoved(next_arc[v]) || overlay.isVertexRemoved(_network.getHead(next_arc[v]))) {
+                        spur_arcs.clear();
+                        spur_cost = kernels::shortestPathTo<ServiceCost>(overlay, spur, t, [&to_dest](int w) {
+                            return to_dest[w];
+                        });
+                        for (int w = t; spur_cost != std::numeric_limits<int>::max() && w != spur;
+                             w = tail(overlay.getParent(w))) {
+                            spur_arcs.push_back(overlay.getParent(w));
+                        }
+                        std::reverse(spur_arcs.begin(), spur_arcs.end());
+                        break;
+                    }
+                    spur_arcs.push_back(next_arc[v]);
+                }
+
+                if (spur_cost != UNREACHABLE && spur_cost != std::numeric_limits<int>::max()) {
+                    Route& route = spurs[j];
+                    route.arcs.assign(last.arcs.begin(), last.arcs.begin() + (long) i);
+                    route.arcs.insert(route.arcs.end(), spur_arcs.begin(), spur_arcs.end());
+                    route.cost = root_cost[i] + spur_cost;
+                    route.deviation = i;
+                }
+
+                for (int a: removed_links) {
+                    overlay.restoreLink(a);
+                }
+                for (size_t r = 0; r < i; r++) {
+                    overlay.restoreVertex(stations[r]);
+                }
+            }
+        });
+
+        for (Route& spur: spurs) {
+            if (spur.cost == -1) {
+                continue;
+            }
+            auto it = candidates.emplace(std::make_pair(spur.cost, std::move(spur.arcs)), spur.deviation).first;
+            it->second = std::min(it->second, spur.deviation);
+        }
+        if (candidates.empty()) {
+            break;
+        }
+
+        auto best = candidates.begin();
+        routes.push_back({best->first.second, best->first.first, best->second});
+        candidates.erase(best);
+
+        if (control != nullptr) {
+            control->advance();
+        }
+    }
+
+    std::vector<Path> paths;
+    for (const Route& route: routes) {
+        Path path = {{source}, route.cost, std::numeric_limits<int>::max()};
+        for (int a: route.arcs) {
+            path.stations.push_back(_network.getName(_network.getHead(a)));
+            path.capacity = std::min(path.capacity, _network.getCapacity(a));
+        }
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
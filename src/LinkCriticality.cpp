@@ -0,0 +1,231 @@
+#include "LinkCriticality.h"
+#include "BitsetBFS.h"
+#include "MaxFlowSolver.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+LinkCriticality::LinkCriticality(const Graph& g) {
+    if (NetworkTopology::needsWideCapacity(g)) {
+        _wideNetwork = std::make_unique<FlowNetwork64>(g);
+    } else {
+        _network = std::make_unique<FlowNetwork>(g);
+    }
+}
+
+const NetworkTopology& LinkCriticality::topology() const {
+    if (_wideNetwork) {
+        return *_wideNetwork;
+    }
+    return *_network;
+}
+
+template <typename Capacity>
+std::vector<LinkCriticality::Link> LinkCriticality::rank(
+    const BasicFlowNetwork<Capacity>& network,
+    const std::vector<int>& sources,
+    const std::vector<int>& sinks,
+    unsigned int numThreads,
+    TaskControl* control
+) const {
+    BasicMaxFlowSolver<Capacity> solver(network);
+    Capacity max_flow = solver.maxFlow(sources, sinks);
+    if (max_flow <= 0 || max_flow == std::numeric_limits<Capacity>::max()) {
+        return {}; // no flow (or it does not fit), no link to lose
+    }
+
+    int n = network.getNumVertex();
+    std::vector<Capacity> base_flow(network.getNumArcs());
+    for (int a = 0; a < network.getNumArcs(); a++) {
+        base_flow[a] = solver.getFlow(a);
+    }
+    std::vector<bool> is_terminal(n, false);
+    for (int v: sources) {
+        is_terminal[v] = true;
+    }
+    for (int v: sinks) {
+        is_terminal[v] = true;
+    }
+
+    auto tail = [&network](int a) {
+        return network.getHead(network.getTwin(a));
+    };
+
+    // Arc of each link in the direction of its flow, with its loss if known without solving
+    std::vector<std::pair<int, long long>> losses;
+    std::vector<int> candidates;
+    for (int v = 0; v < n; v++) {
+        for (int a = network.arcsBegin(v); a < network.arcsEnd(v); a++) {
+            if (a > network.getTwin(a) || base_flow[a] == 0) {
+                continue; // the twin is the link, or the link can fail without loss
+            }
+
+            int f = base_flow[a] > 0 ? a : network.getTwin(a);
+            if (solver.isOnSourceSide(tail(f)) && !solver.isOnSourceSide(network.getHead(f))) {
+                // A saturated arc of the minimum cut, the cut and so the flow lose its capacity
+                losses.emplace_back(f, network.getCapacity(f));
+            } else {
+                candidates.push_back(f);
+            }
+        }
+    }
+
+    std::vector<long long> candidate_loss(candidates.size(), -1);
+    std::atomic<size_t> next_candidate(0);
+    if (control != nullptr) {
+        control->addWork((long long) candidates.size());
+    }
+
+    utils::runWorkers(utils::numThreads(numThreads, candidates.size()), [&]() {
+        std::vector<Capacity> flow = base_flow;
+        std::vector<std::pair<int, Capacity>> changed; // flow of the arcs before they changed, to restore it
+        BitsetBFS bfs(network);
+
+        auto add_flow = [&](int a, Capacity delta) {
+            int twin = network.getTwin(a);
+            changed.emplace_back(a, flow[a]);
+            changed.emplace_back(twin, flow[twin]);
+            flow[a] += delta;
+            flow[twin] -= delta;
+        };
+
+        // Send up to amount along the paths from the starts to the targets, each arc can take its residual and
+        // gets sign * flow sent (no start can be a target)
+        auto send = [&](const std::vector<int>& starts, const std::vector<int>& targets, Capacity amount,
+                        auto residual, int sign) {
+            Capacity sent = 0;
+            bfs.setTargets(targets);
+            while (sent < amount) {
+                int t = bfs.search(starts, [&residual](int a) {
+                    return residual(a) > 0;
+                });
+                if (t == -1) {
+                    break;
+                }
+
+                Capacity delta = amount - sent;
+                for (int v = t; bfs.getParent(v) != -2; v = tail(bfs.getParent(v))) {
+                    delta = std::min(delta, residual(bfs.getParent(v)));
+                }
+                for (int v = t; bfs.getParent(v) != -2; v = tail(bfs.getParent(v))) {
+                    add_flow(bfs.getParent(v), sign * delta);
+                }
+                sent += delta;
+            }
+            return sent;
+        };
+
+        for (size_t i = next_candidate++; i < candidates.size(); i = next_candidate++) {
+            if (control != nullptr && control->isCancelled()) {
+                break;
+            }
+
+            int f = candidates[i];
+            int failed_twin = network.getTwin(f);
+            int x = tail(f), y = network.getHead(f);
+            auto residual = [&](int a) {
+                return a == f || a == failed_twin ? 0 : network.getCapacity(a) - flow[a];
+            };
+
+            // Take the flow out of the link, x is left with it and y without it
+            Capacity lost = flow[f];
+            add_flow(f, -lost);
+
+            // Send it around the link, what can't go back to the sources from x and to the sinks from y
+            lost -= send({x}, {y}, lost, residual, 1);
+            if (lost > 0 && !is_terminal[x]) {
+                send({x}, sources, lost, [&flow](int a) { return -flow[a]; }, 1);
+            }
+            if (lost > 0 && !is_terminal[y]) {
+                send({y}, sinks, lost, [&flow](int a) { return flow[a]; }, -1);
+            }
+
+            // Returning the flow may open paths the link was blocking
+            send(sources, sinks, std::numeric_limits<Capacity>::max(), residual, 1);
+
+            long long value = 0;
+            for (int s: sources) {
+                for (int a = network.arcsBegin(s); a < network.arcsEnd(s); a++) {
+                    utils::checkedAdd(value, (long long) flow[a]);
+                }
+            }
+            candidate_loss[i] = (long long) max_flow - value;
+
+            for (auto it = changed.rbegin(); it != changed.rend(); it++) {
+                flow[it->first] = it->second;
+            }
+            changed.clear();
+
+            if (control != nullptr) {
+                control->advance();
+            }
+        }
+    });
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (candidate_loss[i] > 0) {
+            losses.emplace_back(candidates[i], candidate_loss[i]);
+        }
+    }
+
+    std::vector<Link> links;
+    for (const auto &loss: losses) {
+        int f = loss.first;
+        links.push_back({network.getName(tail(f)), network.getName(network.getHead(f)),
+                         (long long) network.getCapacity(f), loss.second});
+    }
+    std::sort(links.begin(), links.end(), [](const Link& a, const Link& b) {
+        if (a.loss != b.loss) {
+            return a.loss > b.loss;
+        }
+        return a.origin != b.origin ? a.origin < b.origin : a.dest < b.dest;
+    });
+    return links;
+}
+
+std::vector<LinkCriticality::Link> LinkCriticality::rank(
+    const std::vector<int>& sources,
+    const std::vector<int>& sinks,
+    unsigned int numThreads,
+    TaskControl* control
+) const {
+    TRACE_SPAN("LinkCriticality", "analysis");
+    if (_wideNetwork) {
+        return rank(*_wideNetwork, sources, sinks, numThreads, control);
+    }
+    return rank(*_network, sources, sinks, numThreads, control);
+}
+
+std::vector<LinkCriticality::Link> LinkCriticality::pairLinks(
+    const std::string& source,
+    const std::string& dest,
+    unsigned int numThreads,
+    TaskControl* control
+) const {
+    int s = topology().findIndex(source);
+    int t = topology().findIndex(dest);
+    if (s == -1 || t == -1 || s == t) {
+        return {};
+    }
+    return rank({s}, {t}, numThreads, control);
+}
+
+std::vector<LinkCriticality::Link> LinkCriticality::arrivalLinks(
+    const std::string& station,
+    unsigned int numThreads,
+    TaskControl* control
+) const {
+    int t = topology().findIndex(station);
+    if (t == -1) {
+        return {};
+    }
+
+    std::vector<int> sources = _wideNetwork ? _wideNetwork->arrivalSources(t) : _network->arrivalSources(t);
+    if (sources.empty()) {
+        return {};
+    }
+    return rank(sources, {t}, numThreads, control);
+}
@@ -0,0 +1,295 @@
+#include "MaxFlowSolver.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <limits>
+
+template <typename Capacity>
+BasicMaxFlowSolver<Capacity>::BasicMaxFlowSolver(const BasicFlowNetwork<Capacity>& network)
+    : _network(network),
+      _flow(network.getNumArcs(), 0),
+      _flowEpoch(network.getNumArcs(), 0),
+      _bfs(network),
+      _width(network.getNumVertex(), 0) {}
+
+template <typename Capacity>
+void BasicMaxFlowSolver<Capacity>::newQuery() {
+    if (++_queryEpoch == 0) {
+        // Epoch wrapped around, clear the old marks once
+        std::fill(_flowEpoch.begin(), _flowEpoch.end(), 0);
+        _queryEpoch = 1;
+    }
+}
+
+template <typename Capacity>
+void BasicMaxFlowSolver<Capacity>::addFlow(int arc, Capacity flow) {
+    int twin = _network.getTwin(arc);
+    _flow[arc] = getFlow(arc) + flow;
+    _flow[twin] = getFlow(twin) - flow;
+    _flowEpoch[arc] = _queryEpoch;
+    _flowEpoch[twin] = _queryEpoch;
+}
+
+template <typename Capacity>
+void BasicMaxFlowSolver<Capacity>::setWarmStart(bool warmStart) {
+    _warmStart = warmStart;
+}
+
+template <typename Capacity>
+void BasicMaxFlowSolver<Capacity>::setFailedArcs(const std::vector<bool>* failed) {
+    _failed = failed;
+    _warmValid = false; // the previous flow may use the failed arcs
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::capacity(int arc) const {
+    return _failed != nullptr && (*_failed)[arc] ? 0 : _network.getCapacity(arc);
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::maxFlow(int source, int dest, bool capacityScaling) {
+    _querySources.assign(1, source);
+    _querySinks.assign(1, dest);
+
+    return maxFlow(_querySources, _querySinks, capacityScaling);
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::maxFlow(const std::vector<int>& sources, const std::vector<int>& sinks, bool capacityScaling) {
+    TRACE_SPAN("MaxFlowSolver::maxFlow", "flow");
+    int n = _network.getNumVertex();
+
+    // Check if sources and sinks are valid
+    if (sources.empty() || sinks.empty()) {
+        return -1;
+    }
+    for (int v: sources) {
+        if (v < 0 || v >= n) {
+            return -1;
+        }
+    }
+    for (int v: sinks) {
+        if (v < 0 || v >= n) {
+            return -1;
+        }
+    }
+
+    bool warm = _warmStart && _warmValid && sources == _sources;
+    _warmValid = false;
+
+    if (warm) {
+        _previousSinks.swap(_sinks);
+    } else {
+        STATS_PHASE(RESET);
+        _sources = sources;
+        newQuery();
+    }
+    _sinks = sinks;
+
+    _bfs.setTargets(_sinks);
+    for (int v: _sources) {
+        if (_bfs.isTarget(v)) {
+            return -1; // a vertex can't be both source and sink
+        }
+    }
+
+    STATS_PHASE(AUGMENT);
+    _augmentations = 0;
+    if (warm && !returnExcess()) {
+        newQuery(); // should not happen with a valid flow, start from zero flow
+        warm = false;
+    }
+
+    Capacity max_flow = augment(capacityScaling);
+    if (warm && max_flow != std::numeric_limits<Capacity>::max()) {
+        max_flow = flowValue();
+    }
+    _warmValid = max_flow != std::numeric_limits<Capacity>::max();
+
+    return (max_flow ? max_flow : -1);
+}
+
+template <typename Capacity>
+bool BasicMaxFlowSolver<Capacity>::returnExcess() {
+    _returnTargets = _sources;
+    _returnTargets.insert(_returnTargets.end(), _sinks.begin(), _sinks.end());
+    _bfs.setTargets(_returnTargets);
+
+    bool valid = true;
+    for (int x: _previousSinks) {
+        if (_bfs.isTarget(x)) {
+            continue; // still a sink
+        }
+
+        Capacity excess = 0;
+        for (int a = _network.arcsBegin(x); a < _network.arcsEnd(x); a++) {
+            excess -= getFlow(a);
+        }
+
+        _returnSource.assign(1, x);
+
+        // Send what can go on to the new sinks through the residual network
+        _bfs.setTargets(_sinks);
+        while (excess > 0) {
+            int y = _bfs.search(_returnSource, [this](int a) {
+                return capacity(a) - getFlow(a) > 0;
+            });
+            if (y == -1) {
+                break;
+            }
+
+            Capacity path_flow = excess;
+            for (int v = y; _bfs.getParent(v) != -2; v = _network.getHead(_network.getTwin(_bfs.getParent(v)))) {
+                int a = _bfs.getParent(v);
+                path_flow = std::min(path_flow, capacity(a) - getFlow(a));
+            }
+            for (int v = y; _bfs.getParent(v) != -2; v = _network.getHead(_network.getTwin(_bfs.getParent(v)))) {
+                addFlow(_bfs.getParent(v), path_flow);
+            }
+
+            excess -= path_flow;
+            _augmentations++;
+            STATS_ADD(augmentingPaths, 1);
+        }
+        _bfs.setTargets(_returnTargets);
+
+        while (excess > 0) {
+            // Follow back the arcs with flow reaching x
+            int y = _bfs.search(_returnSource, [this](int a) {
+                return getFlow(a) < 0;
+            });
+            if (y == -1) {
+                valid = false;
+                break;
+            }
+
+            Capacity path_flow = excess;
+            for (int v = y; _bfs.getParent(v) != -2; v = _network.getHead(_network.getTwin(_bfs.getParent(v)))) {
+                path_flow = std::min(path_flow, -getFlow(_bfs.getParent(v)));
+            }
+            for (int v = y; _bfs.getParent(v) != -2; v = _network.getHead(_network.getTwin(_bfs.getParent(v)))) {
+                addFlow(_bfs.getParent(v), path_flow);
+            }
+
+            excess -= path_flow;
+            _augmentations++;
+            STATS_ADD(augmentingPaths, 1);
+        }
+
+        if (!valid) {
+            break;
+        }
+    }
+
+    _bfs.setTargets(_sinks);
+    return valid;
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::flowValue() const {
+    Capacity value = 0;
+    for (int s: _sources) {
+        for (int a = _network.arcsBegin(s); a < _network.arcsEnd(s); a++) {
+            utils::checkedAdd(value, getFlow(a));
+        }
+    }
+    return value;
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::augment(bool capacityScaling) {
+    Capacity total_flow = 0;
+    Capacity delta = 1;
+
+    if (capacityScaling) {
+        // Start with the largest power of 2 that fits in the widest path
+        Capacity max_capacity = widestPath();
+        while (delta <= max_capacity / 2) {
+            delta *= 2;
+        }
+    }
+
+    for (; delta >= 1; delta /= 2) {
+        for (int t = findAugmentingPath(delta); t != -1; t = findAugmentingPath(delta)) {
+            Capacity path_flow = std::numeric_limits<Capacity>::max();
+
+            // Find the minimum residual capacity in the path
+            for (int v = t; _bfs.getParent(v) != -2; v = _network.getHead(_network.getTwin(_bfs.getParent(v)))) {
+                int a = _bfs.getParent(v);
+                path_flow = std::min(path_flow, capacity(a) - getFlow(a));
+            }
+
+            // Update the flow in the path
+            for (int v = t; _bfs.getParent(v) != -2; v = _network.getHead(_network.getTwin(_bfs.getParent(v)))) {
+                addFlow(_bfs.getParent(v), path_flow);
+            }
+
+            _augmentations++;
+
+            STATS_ADD(augmentingPaths, 1);
+            if (!utils::checkedAdd(total_flow, path_flow)) {
+                return total_flow; // saturated, the flow does not fit in Capacity
+            }
+        }
+    }
+
+    return total_flow;
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::getFlow(int arc) const {
+    return _flowEpoch[arc] == _queryEpoch ? _flow[arc] : 0;
+}
+
+template <typename Capacity>
+bool BasicMaxFlowSolver<Capacity>::isOnSourceSide(int v) const {
+    return _bfs.isVisited(v);
+}
+
+template <typename Capacity>
+int BasicMaxFlowSolver<Capacity>::getAugmentations() const {
+    return _augmentations;
+}
+
+template <typename Capacity>
+Capacity BasicMaxFlowSolver<Capacity>::widestPath() {
+    std::fill(_width.begin(), _width.end(), 0);
+    _widthHeap.reset(_network.getNumVertex());
+    for (int s: _sources) {
+        _width[s] = std::numeric_limits<Capacity>::max();
+        _widthHeap.push(s, _width[s]);
+    }
+
+    while (!_widthHeap.empty()) {
+        int v = _widthHeap.pop();
+        if (_bfs.isTarget(v)) {
+            return _width[v];
+        }
+        for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+            int w = _network.getHead(a);
+            Capacity width = std::min(_width[v], capacity(a) - getFlow(a));
+            if (width > _width[w]) {
+                // A vertex already popped has a width at least as large, so w is either in the heap or new
+                _width[w] = width;
+                if (_widthHeap.contains(w)) {
+                    _widthHeap.increaseKey(w, width);
+                } else {
+                    _widthHeap.push(w, width);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+template <typename Capacity>
+int BasicMaxFlowSolver<Capacity>::findAugmentingPath(Capacity delta) {
+    return _bfs.search(_sources, [this, delta](int a) {
+        return capacity(a) - getFlow(a) >= delta;
+    });
+}
+
+template class BasicMaxFlowSolver<int>;
+template class BasicMaxFlowSolver<long long>;
@@ -1,77 +1,163 @@
 #include "Menu.h"
+#include "FailureSimulation.h"
+#include "GlobalMinCut.h"
+#include "KShortestPaths.h"
+#include "LinkCriticality.h"
+#include "Ranking.h"
+#include "Trace.h"
+#include "UpgradePlanner.h"
 #include "Utils.h"
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <limits>
-#include <queue>
 
-// input files
-const std::string Menu::STATIONS_INPUT = "../data/stations.csv";
-const std::string Menu::NETWORK_INPUT = "../data/network.csv";
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
 
-void Menu::readData() {
-    std::ifstream station_input(STATIONS_INPUT);
-    std::ifstream network_input(NETWORK_INPUT);
+namespace {
+    volatile std::sig_atomic_t interrupted = 0;
 
-    std::string line;
+    void onInterrupt(int) {
+        interrupted = 1;
+    }
 
-    // discard fist line of the files
-    getline(station_input, line);
-    getline(network_input, line);
+    /**
+     * @brief While alive, Ctrl+C and (on a terminal) key presses are taken as requests to cancel
+     * instead of ending the program
+     */
+    class CancelRequests {
+    private:
+        struct sigaction _previousAction;
+        termios _previousTerminal;
+        bool _terminal;
+
+    public:
+        CancelRequests() {
+            interrupted = 0;
+            struct sigaction action = {};
+            action.sa_handler = onInterrupt;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGINT, &action, &_previousAction);
+
+            // Keys are read as soon as they are pressed and not echoed
+            _terminal = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &_previousTerminal) == 0;
+            if (_terminal) {
+                termios raw = _previousTerminal;
+                raw.c_lflag &= ~(ICANON | ECHO);
+                raw.c_cc[VMIN] = 0;
+                raw.c_cc[VTIME] = 0;
+                tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            }
+        }
 
-    while (getline(station_input, line)) {
-        std::stringstream ss(line);
+        ~CancelRequests() {
+            if (_terminal) {
+                tcsetattr(STDIN_FILENO, TCSANOW, &_previousTerminal);
+            }
+            sigaction(SIGINT, &_previousAction, nullptr);
+        }
 
-        std::string name, district, municipality, township, line;
+        CancelRequests(const CancelRequests&) = delete;
+        CancelRequests& operator=(const CancelRequests&) = delete;
+
+        /**
+         * @brief Wait for a request to cancel
+         *
+         * @param ms Longest wait
+         * @return true Cancel was requested
+         */
+        bool wait(int ms) {
+            if (_terminal) {
+                pollfd fd = {STDIN_FILENO, POLLIN, 0};
+                if (poll(&fd, 1, ms) > 0) {
+                    char c;
+                    while (read(STDIN_FILENO, &c, 1) > 0); // the keys are not left for the menu
+                    return true;
+                }
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            }
+            return interrupted;
+        }
+    };
+}
 
-        getline(ss, name, ',');
-        getline(ss, district, ',');
-        getline(ss, municipality, ',');
-        getline(ss, township, ',');
-        getline(ss, line);
+// input files
+const std::string Menu::STATIONS_INPUT = "../data/stations.csv";
+const std::string Menu::NETWORK_INPUT = "../data/network.csv";
 
-        if (line.back() == '\r' || line.back() == '\n') {
-            line.pop_back(); // remove '\r' or '\n'
-        }
+void Menu::readData() {
+    _graph.readData(STATIONS_INPUT, NETWORK_INPUT);
+}
 
-        _graph.addVertex(Station(
-            name,
-            district,
-            municipality,
-            township,
-            line
-        ));
-    }
+Menu::Menu(): Menu(utils::cacheDirectory()) {}
 
-    while (getline(network_input, line)) {
-        std::stringstream ss(line);
+Menu::Menu(const std::string& cacheDirectory): _graph(Graph()) {
+    readData();
+    _graph.setCacheDirectory(cacheDirectory);
+}
 
-        std::string station_a, station_b, capacity_string, service;
+bool Menu::runTask(const std::string& title, const std::function<void(TaskControl&)>& work) {
+    TaskControl control;
+    std::atomic<bool> done(false);
+    auto start = std::chrono::steady_clock::now();
+
+    CancelRequests requests;
+    std::thread worker([&]() {
+        work(control);
+        done = true;
+    });
+
+    bool show = isatty(STDOUT_FILENO);
+    int shown_percent = -1;
+    std::string shown_status;
+    auto shown_time = start;
+    while (!done) {
+        if (requests.wait(50) && !done) {
+            control.cancel();
+            shown_percent = -1; // show that it is cancelling
+        }
 
-        getline(ss, station_a, ',');
-        getline(ss, station_b, ',');
-        getline(ss, capacity_string, ',');
-        getline(ss, service);
+        auto now = std::chrono::steady_clock::now();
+        double progress = control.getProgress();
+        std::string status = control.getStatus();
+        if (!show || ((int) (progress * 100) == shown_percent && status == shown_status
+                      && now - shown_time < std::chrono::seconds(1))) {
+            continue;
+        }
 
-        if (service.back() == '\r' || service.back() == '\n') {
-            service.pop_back(); // remove '\r' or '\n'
+        utils::clearScreen();
+        std::cout << title << "... " << (int) (progress * 100) << '%';
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        if (progress > 0) {
+            std::cout << ", about " << (int) (elapsed * (1 - progress) / progress + 0.5) << " s left";
+        }
+        std::cout << (control.isCancelled() ? "\n\nCancelling...\n" : "\n\nPress any key or Ctrl+C to cancel\n");
+        if (!status.empty()) {
+            std::cout << '\n' << status;
         }
+        std::cout << std::flush;
 
-        _graph.addBidirectionalEdge(
-            station_a,
-            station_b,
-            std::stoi(capacity_string) / 2,
-            service
-        );
+        shown_percent = (int) (progress * 100);
+        shown_status = status;
+        shown_time = now;
     }
-}
+    worker.join();
 
-Menu::Menu(): _graph(Graph()) {
-    readData();
+    if (show) {
+        utils::clearScreen();
+    }
+    return !control.isCancelled();
 }
 
 void Menu::showEdgeInfo(const Edge* edge) const {
@@ -255,11 +341,28 @@ void Menu::maxTrainBetweenStations(const Graph& g) {
     }
 
     std::cout << "Max number of trains between " << origin_station << " and " << dest_station << ": " << max_trains << "\n";
+
+    std::cout << "\nRoutes:\n\n";
+    g.decomposeFlow(origin_station, dest_station, [](const std::vector<Vertex *>& path, int trains) {
+        std::cout << trains << (trains == 1 ? " train: " : " trains: ");
+        for (size_t i = 0; i < path.size(); i++) {
+            std::cout << (i ? " -> " : "") << path[i]->getStation().getName();
+        }
+        std::cout << '\n';
+    });
+
     utils::waitEnter();
 }
 
 void Menu::maxTrainCapacity() {
-    std::vector<std::pair<std::pair<std::string, std::string>, int>> max_trains = _graph.getMaxTrainCapacityPairs();
+    std::vector<std::pair<std::pair<std::string, std::string>, long long>> max_trains;
+    bool finished = runTask("Computing the max flow of every pair of stations", [this, &max_trains](TaskControl& control) {
+        max_trains = _graph.getMaxTrainCapacityPairs(&control);
+    });
+
+    if (!finished) {
+        std::cout << "Cancelled, best pairs among the ones computed:\n\n";
+    }
 
     for (const auto& pair : max_trains) {
         std::cout << "Max number of trains between " << pair.first.first << " and " << pair.first.second << ": " << pair.second << "\n";
@@ -281,12 +384,38 @@ void Menu::topKMunicipalitiesAndDistricts() {
         return;
     }
 
+    std::string opt = "n";
+    std::cout << "Use the flow between regions instead of between stations? (y/N): ";
+    getline(std::cin, opt);
+    bool region_pairs = opt[0] == 'y' || opt[0] == 'Y';
+
     utils::clearScreen();
 
     std::vector<std::string> top_k_municipalities;
     std::vector<std::string> top_k_districts;
 
-    _graph.findTopMunicipalitiesAndDistricts(k, top_k_municipalities, top_k_districts);
+    bool finished = runTask("Computing the flows", [&](TaskControl& control) {
+        _graph.findTopMunicipalitiesAndDistricts(
+            k,
+            top_k_municipalities,
+            top_k_districts,
+            region_pairs,
+            [k, &control](const std::vector<std::string> &top, bool districts, double) {
+                std::ostringstream status;
+                status << "Provisional top " << k << (districts ? " districts" : " municipalities") << ":\n\n";
+                for (const auto &region: top) {
+                    status << region << '\n';
+                }
+                control.setStatus(status.str());
+            },
+            &control
+        );
+    });
+
+    if (!finished) {
+        std::cout << (region_pairs ? "Cancelled, ranking of the region pairs computed:\n\n"
+                                   : "Cancelled, the ranking needs the flows of every pair of stations.\n\n");
+    }
 
     std::cout << "Top " << k << " municipalities:\n\n";
     for (auto it = top_k_municipalities.begin(); it != top_k_municipalities.end(); it++) {
@@ -301,34 +430,6 @@ void Menu::topKMunicipalitiesAndDistricts() {
     utils::waitEnter();
 }
 
-int Menu::maxTrainArrivingStationHelper(Graph& g, const std::string& station_name) {
-    Vertex* target = g.findVertex(station_name);
-    if (target == nullptr) {
-        return -1;
-    }
-
-    Station super = Station("super","","","","");
-    g.addVertex(super);
-
-    for (Vertex* v : g.getVertexSet()) {
-        if (!(v->getStation().getName() == station_name) && v->getAdj().size() == 1) {
-            for (auto v: g.getVertexSet()) {
-                for (auto e: v->getAdj()) {
-                    e->setFlow(0);
-                }
-            }
-
-            if (g.findAugmentingPath(v, target)) {
-                g.addEdge(super.getName(),v->getStation().getName(),std::numeric_limits<int>::max(),"");
-            }
-        }
-    }
-
-    int val = g.edmondsKarp(super.getName(), station_name);
-    g.removeVertex("super");
-    return val;
-}
-
 void Menu::maxTrainArrivingStation() {
     std::string station_name;
     while (true) {
@@ -353,7 +454,7 @@ void Menu::maxTrainArrivingStation() {
         }
     }
 
-    int max_arriving = maxTrainArrivingStationHelper(_graph, station_name);
+    int max_arriving = _graph.maxTrainsArriving(station_name);
 
     utils::clearScreen();
     if (max_arriving == -1) {
@@ -418,18 +519,16 @@ void Menu::maxTrainWithCost() {
     }
 
     _graph.dijkstra(source);
-    int flow = std::numeric_limits<int>::max();
-    int cost = dest->getDistance();
+    int flow = _graph.getPathCapacity(dest);
+    int cost = _graph.getDistance(dest);
 
-    Vertex* temp = dest;
-    while (temp->getStation().getName() != origin_station) {
-        if (flow > temp->getPath()->getWeight()) {
-            flow = temp->getPath()->getWeight();
-        }
-        temp = temp->getPath()->getOrigin();
+    utils::clearScreen();
+    if (flow == -1) {
+        std::cout << "Impossible path!\n";
+        utils::waitEnter();
+        return;
     }
 
-    utils::clearScreen();
     std::cout << "The minimum cost from " << origin_station << " to " << dest_station << " is " << flow * cost << '\n';
     utils::waitEnter();
 }
@@ -447,46 +546,316 @@ void Menu::mostAffectedStations(Graph& g) {
         return;
     }
 
-    std::vector<std::pair<std::string ,int>> diff;
-    for (Vertex* v : _graph.getVertexSet()) {
-        int original_max = maxTrainArrivingStationHelper(_graph, v->getStation().getName());
-        original_max = original_max == -1 ? 0 : original_max; //? in case the station doesn't have flow
-        int new_max = maxTrainArrivingStationHelper(g, v->getStation().getName());
-        new_max = new_max == -1 ? 0 : new_max; //? in case the station is not in the new graph or doesn't have flow
+    auto show_stations = [](std::ostream& out, const std::vector<std::pair<std::string, int>> &stations) {
+        out << "Station -> Difference\n\n";
+        for (const auto &station: stations) {
+            if (station.second == 0) {
+                break;
+            }
+
+            out << station.first << " -> " << station.second << '\n';
+        }
+    };
+
+    Ranking<std::string, int> ranking;
+    const auto &stations = _graph.getVertexSet();
+    size_t step = std::max<size_t>(1, stations.size() / 20); // show the provisional ranking about every 5%
+
+    bool finished = runTask("Comparing the stations", [&](TaskControl& control) {
+        TRACE_SPAN("mostAffectedStations", "analysis");
+        control.addWork((long long) stations.size());
+        for (size_t i = 0; i < stations.size() && !control.isCancelled(); i++) {
+            std::string name = stations[i]->getStation().getName();
+            int original_max = _graph.maxTrainsArriving(name);
+            original_max = original_max == -1 ? 0 : original_max; //? in case the station doesn't have flow
+            int new_max = g.maxTrainsArriving(name);
+            new_max = new_max == -1 ? 0 : new_max; //? in case the station is not in the new graph or doesn't have flow
+
+            ranking.set(name, original_max - new_max);
+            control.advance();
+
+            if ((i + 1) % step == 0 && i + 1 < stations.size()) {
+                std::ostringstream status;
+                status << "Provisional ranking:\n\n";
+                show_stations(status, ranking.top(k));
+                control.setStatus(status.str());
+            }
+        }
+    });
 
-        diff.push_back(std::make_pair(v->getStation().getName(), original_max - new_max));
+    if (!finished) {
+        std::cout << "Cancelled, ranking of the stations compared:\n\n";
     }
+    show_stations(std::cout, ranking.top(k));
 
-    auto cmp = [](const std::pair<std::string, int> &a, const std::pair<std::string, int> &b) {
-        return a.second > b.second;
-    };
-    std::priority_queue<
-            std::pair<std::string, int>,
-            std::vector<std::pair<std::string, int>>,
-            decltype(cmp)
-    > pq(cmp);
+    utils::waitEnter();
+}
+
+void Menu::failureSimulation(const Graph& g) {
+    double probability;
+    int num_scenarios;
+
+    std::cout << "Insert the failure probability of each connection (%): ";
+    std::cin >> probability;
+    std::cout << "Insert the number of scenarios to simulate: ";
+    std::cin >> num_scenarios;
+    std::cin.ignore(); // ignore '\n' for getline()
+
+    if (!std::cin || probability < 0 || probability > 100 || num_scenarios <= 0) {
+        std::cin.clear();
+        std::cout << "Invalid probability or number of scenarios!\n";
+        utils::waitEnter();
+        return;
+    }
+
+    FailureSimulation simulation(g, probability / 100);
+    while (true) {
+        utils::clearScreen();
+        std::string station_name, dest_name;
+        std::cout << "Insert a station to measure (empty to start the simulation): ";
+        getline(std::cin, station_name);
+        if (station_name.empty()) {
+            break;
+        }
+
+        std::cout << "Insert the destination station (empty for the trains arriving at " << station_name << "): ";
+        getline(std::cin, dest_name);
+
+        bool added = dest_name.empty() ? simulation.addArrivals(station_name)
+                                       : simulation.addPair(station_name, dest_name);
+        if (!added) {
+            std::cout << "Invalid station!\n";
+            utils::waitEnter();
+        }
+    }
+
+    utils::clearScreen();
+    if (simulation.getNumMeasures() == 0) {
+        return;
+    }
+
+    std::vector<FailureSimulation::Distribution> distributions;
+    bool finished = runTask("Simulating the failures", [&](TaskControl& control) {
+        distributions = simulation.run(num_scenarios, 1, 0, &control);
+    });
 
-    for (const auto &stations: diff) {
-        pq.push(stations);
-        if (pq.size() > k) {
-            pq.pop();
+    if (!finished) {
+        std::cout << "Cancelled, distributions of the scenarios simulated:\n\n";
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto &d: distributions) {
+        std::cout << d.name << " (" << d.baseline << " trains without failures, " << d.scenarios << " scenarios)\n";
+        std::cout << "  Lost trains: mean " << d.mean << ", median " << d.p50 << ", 90% " << d.p90
+                  << ", 95% " << d.p95 << ", 99% " << d.p99 << ", max " << d.max << '\n';
+        std::cout << "  Probability of losing trains: " << d.lossProbability * 100 << "%\n\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+
+    utils::waitEnter();
+}
+
+void Menu::criticalConnections(const Graph& g) {
+    std::string station_name, dest_name;
+    std::cout << "Insert the station (origin, or the arrival station if no destination): ";
+    getline(std::cin, station_name);
+    std::cout << "Insert the destination station (empty for the trains arriving at " << station_name << "): ";
+    getline(std::cin, dest_name);
+
+    int k;
+    std::cout << "Insert the number of connections you want to be shown: ";
+    std::cin >> k;
+    std::cin.ignore(); // ignore '\n' for waitEnter()
+
+    if (!std::cin || k < 0) {
+        std::cin.clear();
+        std::cout << "Input is negative!\n";
+        utils::waitEnter();
+        return;
+    }
+
+    if (g.findVertex(station_name) == nullptr || (!dest_name.empty() && g.findVertex(dest_name) == nullptr)) {
+        std::cout << "Invalid station!\n";
+        utils::waitEnter();
+        return;
+    }
+
+    utils::clearScreen();
+
+    std::vector<LinkCriticality::Link> links;
+    bool finished = runTask("Failing each connection", [&](TaskControl& control) {
+        LinkCriticality criticality(g);
+        links = dest_name.empty() ? criticality.arrivalLinks(station_name, 0, &control)
+                                  : criticality.pairLinks(station_name, dest_name, 0, &control);
+    });
+
+    if (!finished) {
+        std::cout << "Cancelled, ranking of the connections failed so far:\n\n";
+    }
+
+    std::cout << "Connection (capacity) -> Trains lost\n\n";
+    for (size_t i = 0; i < links.size() && i < (size_t) k; i++) {
+        std::cout << links[i].origin << " / " << links[i].dest << " (" << links[i].capacity << ") -> "
+                  << links[i].loss << '\n';
+    }
+    if (links.empty()) {
+        std::cout << "No connection failure loses trains.\n";
+    }
+
+    utils::waitEnter();
+}
+
+void Menu::capacityUpgradePlan() {
+    std::string level, origin, dest;
+    std::cout << "Plan between stations, municipalities or districts? (s/m/d): ";
+    getline(std::cin, level);
+    std::cout << "Insert the origin: ";
+    getline(std::cin, origin);
+    std::cout << "Insert the destination: ";
+    getline(std::cin, dest);
+
+    long long budget, increment;
+    std::cout << "Insert the number of trains that can be added: ";
+    std::cin >> budget;
+    std::cout << "Insert the number of trains added to a connection in each upgrade: ";
+    std::cin >> increment;
+    std::cin.ignore(); // ignore '\n' for waitEnter()
+
+    if (!std::cin || budget <= 0 || increment <= 0) {
+        std::cin.clear();
+        std::cout << "Input is not positive!\n";
+        utils::waitEnter();
+        return;
+    }
+
+    utils::clearScreen();
+
+    UpgradePlanner::Plan plan;
+    bool finished = runTask("Planning the upgrades", [&](TaskControl& control) {
+        UpgradePlanner planner(_graph);
+        if (level == "m" || level == "M") {
+            plan = planner.planRegions(RegionCentrality::MUNICIPALITY, origin, dest, budget, increment, &control);
+        } else if (level == "d" || level == "D") {
+            plan = planner.planRegions(RegionCentrality::DISTRICT, origin, dest, budget, increment, &control);
+        } else {
+            plan = planner.planPair(origin, dest, budget, increment, &control);
         }
+    });
+
+    if (plan.initialFlow == -1) {
+        std::cout << "Invalid origin or destination!\n";
+        utils::waitEnter();
+        return;
     }
 
-    diff.clear();
-    while (!pq.empty()) {
-        diff.insert(diff.begin(), pq.top());
-        pq.pop();
+    if (!finished) {
+        std::cout << "Cancelled, upgrades planned so far:\n\n";
     }
+    std::cout << "Max number of trains between " << origin << " and " << dest << ": " << plan.initialFlow << "\n\n";
+    for (const auto &step: plan.steps) {
+        std::cout << "+" << step.added << " on " << step.origin << " / " << step.dest << " -> " << step.flow << " trains\n";
+    }
+    if (plan.steps.empty()) {
+        std::cout << "No upgrade raises the number of trains.\n";
+    }
+
+    utils::waitEnter();
+}
+
+void Menu::weakestSplit(const Graph& g) {
+    std::string opt = "n";
+    std::cout << "Split each connected part of the network instead of the whole network? (y/N): ";
+    getline(std::cin, opt);
+    bool components = opt[0] == 'y' || opt[0] == 'Y';
 
     utils::clearScreen();
-    std::cout << "Station -> Difference\n\n";
-    for (const auto &stations: diff) {
-        if (stations.second == 0) {
-            break;
+
+    std::vector<GlobalMinCut::Cut> cuts;
+    bool finished = runTask("Splitting the network", [&](TaskControl& control) {
+        GlobalMinCut min_cut(g);
+        if (components) {
+            cuts = min_cut.componentCuts(0, &control);
+        } else {
+            cuts.push_back(min_cut.minCut(&control));
+        }
+    });
+
+    if (!finished) {
+        std::cout << (components ? "Cancelled, splits of the parts computed:\n\n" : "Cancelled.\n");
+    }
+
+    for (const auto &cut: cuts) {
+        if (cut.value == -1) {
+            continue;
+        }
+
+        std::cout << "Trains lost: " << cut.value << " (" << cut.side.size()
+                  << (cut.side.size() == 1 ? " station" : " stations") << " split from " << cut.otherSide.size() << ")\n";
+        std::cout << "Stations split:";
+        for (size_t i = 0; i < cut.side.size(); i++) {
+            std::cout << (i ? ", " : " ") << cut.side[i];
+        }
+        std::cout << '\n';
+        for (const auto &link: cut.links) {
+            std::cout << "  " << link.first << " / " << link.second << '\n';
         }
+        std::cout << '\n';
+    }
+    if (finished && (cuts.empty() || (cuts.size() == 1 && cuts[0].value == -1))) {
+        std::cout << "The network can't be split.\n";
+    }
+
+    utils::waitEnter();
+}
+
+void Menu::alternativeRoutes() {
+    std::string origin_station, dest_station;
+    std::cout << "Origin Station: ";
+    getline(std::cin, origin_station);
+    std::cout << "Destination Station: ";
+    getline(std::cin, dest_station);
+
+    int k;
+    std::cout << "Insert the number of routes you want to be shown: ";
+    std::cin >> k;
+    std::cin.ignore(); // ignore '\n' for waitEnter()
+
+    if (!std::cin || k <= 0) {
+        std::cin.clear();
+        std::cout << "Input is not positive!\n";
+        utils::waitEnter();
+        return;
+    }
+
+    if (_graph.findVertex(origin_station) == nullptr || _graph.findVertex(dest_station) == nullptr) {
+        std::cout << "Invalid station!\n";
+        utils::waitEnter();
+        return;
+    }
+
+    utils::clearScreen();
+
+    std::vector<KShortestPaths::Path> paths;
+    bool finished = runTask("Searching the routes", [&](TaskControl& control) {
+        paths = KShortestPaths(_graph).find(origin_station, dest_station, k, 0, &control);
+    });
+
+    if (!finished) {
+        std::cout << "Cancelled, routes found so far:\n\n";
+    }
 
-        std::cout << stations.first << " -> " << stations.second << '\n';
+    for (size_t i = 0; i < paths.size(); i++) {
+        const auto &path = paths[i];
+        std::cout << i + 1 << ". Cost " << path.cost << ", " << path.capacity
+                  << (path.capacity == 1 ? " train" : " trains") << " (total cost " << (long long) path.cost * path.capacity
+                  << "): ";
+        for (size_t j = 0; j < path.stations.size(); j++) {
+            std::cout << (j ? " -> " : "") << path.stations[j];
+        }
+        std::cout << '\n';
+    }
+    if (paths.empty()) {
+        std::cout << "Impossible path!\n";
     }
 
     utils::waitEnter();
@@ -638,7 +1007,8 @@ Graph Menu::createReducedGraph() {
         utils::clearScreen();
 
         bool found = false;
-        for (auto e : origin->getAdj()) {
+        std::vector<Edge *> adj = origin->getAdj(); // copy, removeEdge changes the adjacency list
+        for (auto e : adj) {
             if (e->getDest()->getStation().getName() == dest_name) {
                 showEdgeInfo(e);
 
@@ -648,7 +1018,8 @@ Graph Menu::createReducedGraph() {
                 getline(std::cin, opt);
 
                 if (opt[0] == 'y' || opt[0] == 'Y') {
-                    found = origin->removeEdge(dest->getStation());
+                    found = reduced_graph.removeEdge(origin_name, dest_name);
+                    break; // every edge to the destination was removed
                 }
             }
         }
@@ -684,6 +1055,8 @@ void Menu::init() {
         std::cout << "| 4. Max number of arriving at a station      |\n";
         std::cout << "| 5. Minimum Cost between 2 stations          |\n";
         std::cout << "| 6. Maintenance                              |\n";
+        std::cout << "| 7. Capacity upgrade plan                    |\n";
+        std::cout << "| 8. Alternative routes between 2 stations    |\n";
         std::cout << "|                                             |\n";
         std::cout << "| 0. Exit                                     |\n";
         std::cout << "-----------------------------------------------\n";
@@ -698,7 +1071,7 @@ void Menu::init() {
                 continue;
             }
 
-            if (opt[0] >= '0' && opt[0] <= '6' ) {
+            if (opt[0] >= '0' && opt[0] <= '8' ) {
                 break;
             }
 
@@ -727,6 +1100,12 @@ void Menu::init() {
             case '6':
                 reducedGraphMenu();
                 break;
+            case '7':
+                capacityUpgradePlan();
+                break;
+            case '8':
+                alternativeRoutes();
+                break;
             default:
                 break;
         }
@@ -743,6 +1122,9 @@ void Menu::reducedGraphMenu() {
         std::cout << "|                                             |\n";
         std::cout << "| 1. Max number of trains with line failures  |\n";
         std::cout << "| 2. Most Affected Stations                   |\n";
+        std::cout << "| 3. Random failures simulation               |\n";
+        std::cout << "| 4. Most critical connections                |\n";
+        std::cout << "| 5. Weakest split of the network             |\n";
         std::cout << "|                                             |\n";
         std::cout << "| 0. Return to Main Menu                      |\n";
         std::cout << "-----------------------------------------------\n";
@@ -757,7 +1139,7 @@ void Menu::reducedGraphMenu() {
                 continue;
             }
 
-            if (opt[0] >= '0' && opt[0] <= '2' ) {
+            if (opt[0] >= '0' && opt[0] <= '5' ) {
                 break;
             }
 
@@ -774,6 +1156,15 @@ void Menu::reducedGraphMenu() {
             case '2':
                 mostAffectedStations(reduced_graph);
                 break;
+            case '3':
+                failureSimulation(reduced_graph);
+                break;
+            case '4':
+                criticalConnections(reduced_graph);
+                break;
+            case '5':
+                weakestSplit(reduced_graph);
+                break;
             default:
                 break;
         }
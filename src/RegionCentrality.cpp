@@ -0,0 +1,162 @@
+#include "RegionCentrality.h"
+#include "MaxFlowSolver.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+RegionCentrality::RegionCentrality(const Graph& g) {
+    if (NetworkTopology::needsWideCapacity(g)) {
+        _wideNetwork = std::make_unique<FlowNetwork64>(g);
+    } else {
+        _network = std::make_unique<FlowNetwork>(g);
+    }
+
+    std::unordered_map<std::string, int> region_index[2];
+
+    // The network has the vertexes in the same order as the graph
+    for (auto v: g.getVertexSet()) {
+        std::string regions[2] = { v->getStation().getMunicipality(), v->getStation().getDistrict() };
+        int station = (int) _regionOf[MUNICIPALITY].size();
+
+        for (int level = MUNICIPALITY; level <= DISTRICT; level++) {
+            auto it = region_index[level].find(regions[level]);
+            if (it == region_index[level].end()) {
+                it = region_index[level].emplace(regions[level], (int) _regionNames[level].size()).first;
+                _regionNames[level].push_back(regions[level]);
+                _regionStations[level].emplace_back();
+            }
+
+            _regionOf[level].push_back(it->second);
+            _regionStations[level][it->second].push_back(station);
+        }
+    }
+}
+
+const std::vector<std::string>& RegionCentrality::getRegions(Level level) const {
+    return _regionNames[level];
+}
+
+long long RegionCentrality::getNumRegionPairs(Level level) const {
+    long long num_regions = (long long) _regionNames[level].size();
+    return num_regions * (num_regions - 1) / 2;
+}
+
+std::vector<std::vector<std::pair<std::string, long long>>> RegionCentrality::stationPairsScores(
+    const std::vector<Level>& levels,
+    const std::vector<long long>& sums
+) const {
+
+    std::vector<std::vector<std::pair<std::string, long long>>> scores;
+    for (Level level: levels) {
+        std::vector<std::pair<std::string, long long>> level_scores;
+        for (const auto &name: _regionNames[level]) {
+            level_scores.emplace_back(name, 0);
+        }
+
+        for (size_t v = 0; v < sums.size(); v++) {
+            utils::checkedAdd(level_scores[_regionOf[level][v]].second, sums[v]);
+        }
+
+        scores.push_back(std::move(level_scores));
+    }
+
+    return scores;
+}
+
+std::vector<std::pair<std::string, long long>> RegionCentrality::regionPairsScores(
+    Level level,
+    unsigned int numThreads,
+    const std::function<void(const Ranking<std::string, long long>&, double)>& onProgress,
+    TaskControl* control
+) const {
+    Ranking<std::string, long long> ranking;
+    for (const auto &name: _regionNames[level]) {
+        ranking.set(name, 0);
+    }
+
+    if (_wideNetwork) {
+        solveRegionPairs(*_wideNetwork, level, numThreads, ranking, onProgress, control);
+    } else {
+        solveRegionPairs(*_network, level, numThreads, ranking, onProgress, control);
+    }
+
+    return ranking.top(ranking.size());
+}
+
+template <typename Capacity>
+void RegionCentrality::solveRegionPairs(
+    const BasicFlowNetwork<Capacity>& network,
+    Level level,
+    unsigned int numThreads,
+    Ranking<std::string, long long>& ranking,
+    const std::function<void(const Ranking<std::string, long long>&, double)>& onProgress,
+    TaskControl* control
+) const {
+    TRACE_SPAN("solveRegionPairs", "analysis");
+    const auto &stations = _regionStations[level];
+    int num_regions = (int) stations.size();
+
+    // The network is symmetric, so only one of the two directions of each pair is solved.
+    // The pairs are taken in groups with the same first region, so each solver can warm start from the last flow.
+    size_t num_pairs = (size_t) num_regions * (num_regions - 1) / 2;
+
+    std::vector<long long> totals(num_regions, 0);
+    std::atomic<int> next_region(0);
+    std::mutex ranking_mutex;
+    size_t done = 0;
+    size_t step = std::max<size_t>(1, num_pairs / 100); // report about every 1% of the pairs
+    auto cancelled = [control]() {
+        return control && control->isCancelled();
+    };
+
+    utils::runWorkers(utils::numThreads(numThreads, num_regions), [&]() {
+        BasicMaxFlowSolver<Capacity> solver(network);
+        solver.setWarmStart(true);
+
+        std::vector<int> others;
+        std::vector<int> region_rank(num_regions);
+
+        for (int a = next_region++; a < num_regions && !cancelled(); a = next_region++) {
+            // Take the other regions in depth first order from the region, so each flow is close to the previous one
+            std::vector<int> rank = network.depthFirstRanks(stations[a][0]);
+            std::fill(region_rank.begin(), region_rank.end(), network.getNumVertex());
+            for (int v = 0; v < network.getNumVertex(); v++) {
+                region_rank[_regionOf[level][v]] = std::min(region_rank[_regionOf[level][v]], rank[v]);
+            }
+
+            others.clear();
+            for (int b = a + 1; b < num_regions; b++) {
+                others.push_back(b);
+            }
+            std::sort(others.begin(), others.end(), [&region_rank](int x, int y) {
+                return region_rank[x] != region_rank[y] ? region_rank[x] < region_rank[y] : x < y;
+            });
+
+            for (int b: others) {
+                if (cancelled()) {
+                    break;
+                }
+                long long flow = solver.maxFlow(stations[a], stations[b]);
+                flow = flow == -1 ? 0 : flow;
+
+                std::lock_guard<std::mutex> lock(ranking_mutex);
+                for (int region: {a, b}) {
+                    utils::checkedAdd(totals[region], flow);
+                    ranking.set(_regionNames[level][region], totals[region]);
+                }
+
+                done++;
+                if (control) {
+                    control->advance();
+                }
+                if (onProgress && done % step == 0 && done < num_pairs) {
+                    onProgress(ranking, (double) done / num_pairs);
+                }
+            }
+        }
+    });
+}
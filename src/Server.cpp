@@ -0,0 +1,223 @@
+#include "Server.h"
+#include "Batch.h"
+#include "Utils.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    /**
+     * @brief Set by SIGINT and SIGTERM
+     */
+    volatile std::sig_atomic_t stop_requested = 0;
+
+    void requestStop(int) {
+        stop_requested = 1;
+    }
+
+    /**
+     * @brief Stream buffer reading and writing a connection
+     */
+    class ConnectionBuffer : public std::streambuf {
+    private:
+        int _fd;
+        char _in[4096];
+        char _out[4096];
+
+        bool writeAll(const char* data, size_t size) {
+            while (size > 0) {
+                ssize_t n = send(_fd, data, size, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                data += n;
+                size -= n;
+            }
+            return true;
+        }
+
+    protected:
+        int_type underflow() override {
+            ssize_t n;
+            do {
+                n = recv(_fd, _in, sizeof(_in), 0);
+            } while (n < 0 && errno == EINTR);
+
+            if (n <= 0) {
+                return traits_type::eof(); // closed, timed out or failed
+            }
+            setg(_in, _in, _in + n);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        int_type overflow(int_type c) override {
+            if (sync() == -1) {
+                return traits_type::eof();
+            }
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync() override {
+            bool ok = writeAll(pbase(), pptr() - pbase());
+            setp(_out, _out + sizeof(_out));
+            return ok ? 0 : -1;
+        }
+
+    public:
+        explicit ConnectionBuffer(int fd): _fd(fd) {
+            setg(_in, _in, _in);
+            setp(_out, _out + sizeof(_out));
+        }
+    };
+}
+
+Server::Server(const Graph& g, std::string socketPath, unsigned int numWorkers)
+    : _graph(g),
+      _socketPath(std::move(socketPath)),
+      _numWorkers(utils::numThreads(numWorkers, std::numeric_limits<size_t>::max())) {}
+
+Server::~Server() {
+    if (_listenFd != -1) {
+        close(_listenFd);
+        unlink(_socketPath.c_str());
+    }
+}
+
+bool Server::listen() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (_socketPath.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::strcpy(address.sun_path, _socketPath.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        return false;
+    }
+
+    // A socket file left by a server that is not running anymore is replaced, a running server is not
+    struct stat info{};
+    if (stat(_socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        if (connect(fd, (sockaddr *) &address, sizeof(address)) == 0) {
+            close(fd);
+            errno = EADDRINUSE;
+            return false;
+        }
+        unlink(_socketPath.c_str());
+    }
+
+    if (bind(fd, (sockaddr *) &address, sizeof(address)) == -1 || ::listen(fd, SOMAXCONN) == -1) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+
+    _listenFd = fd;
+    return true;
+}
+
+void Server::serve(int fd) const {
+    timeval timeout{CLIENT_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    ConnectionBuffer buffer(fd);
+    std::istream in(&buffer);
+    std::ostream out(&buffer);
+
+    // The whole request is read before answering, a client writing all its queries before reading is not blocked
+    std::stringstream request;
+    request << in.rdbuf();
+
+    // The workers already use every thread, each group of max flow queries is solved in the worker
+    Batch batch(_graph, 1);
+    batch.run(request, out);
+
+    close(fd);
+}
+
+void Server::worker() {
+    while (true) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this]() { return _stopping || !_clients.empty(); });
+            if (_clients.empty()) {
+                return; // stopping and nothing left to answer
+            }
+            fd = _clients.front();
+            _clients.pop();
+        }
+
+        serve(fd);
+    }
+}
+
+void Server::run() {
+    if (_listenFd == -1) {
+        return;
+    }
+
+    // Stop on SIGINT/SIGTERM, without restarting the wait for connections
+    struct sigaction action{};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    stop_requested = 0;
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < _numWorkers; i++) {
+        workers.emplace_back(&Server::worker, this);
+    }
+
+    pollfd listening{_listenFd, POLLIN, 0};
+    while (!stop_requested) {
+        // The timeout covers a signal arriving right before poll
+        if (poll(&listening, 1, 1000) <= 0) {
+            continue;
+        }
+
+        int fd = accept(_listenFd, nullptr, nullptr);
+        if (fd == -1) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _clients.push(fd);
+        _ready.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready.notify_all();
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
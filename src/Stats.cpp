@@ -0,0 +1,65 @@
+#include "Stats.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+    /**
+     * @brief Counters of each thread, constant initialized so they can be used while allocating
+     */
+    thread_local stats::Counters counters;
+}
+
+stats::Counters& stats::Counters::operator+=(const Counters& other) {
+    augmentingPaths += other.augmentingPaths;
+    vertexScans += other.vertexScans;
+    edgeScans += other.edgeScans;
+    heapPushes += other.heapPushes;
+    heapPops += other.heapPops;
+    allocations += other.allocations;
+    for (int i = 0; i < (int) Phase::COUNT; i++) {
+        phaseMs[i] += other.phaseMs[i];
+    }
+    return *this;
+}
+
+stats::Counters& stats::current() {
+    return counters;
+}
+
+stats::Counters stats::take() {
+    Counters taken = counters;
+    counters = Counters();
+    return taken;
+}
+
+void stats::writeHeader(std::ostream& out) {
+    out << "augmenting_paths,vertex_scans,edge_scans,heap_pushes,heap_pops,allocations,"
+        << "lookup_ms,reset_ms,augment_ms,search_ms";
+}
+
+void stats::write(std::ostream& out, const Counters& c) {
+    out << c.augmentingPaths << ',' << c.vertexScans << ',' << c.edgeScans << ','
+        << c.heapPushes << ',' << c.heapPops << ',' << c.allocations;
+    for (double ms: c.phaseMs) {
+        out << ',' << ms;
+    }
+}
+
+#ifdef FEUP_DA1_STATS
+void* operator new(std::size_t size) {
+    STATS_ADD(allocations, 1);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
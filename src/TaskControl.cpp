@@ -0,0 +1,34 @@
+#include "TaskControl.h"
+
+#include <algorithm>
+
+void TaskControl::cancel() {
+    _cancelled = true;
+}
+
+bool TaskControl::isCancelled() const {
+    return _cancelled.load(std::memory_order_relaxed);
+}
+
+void TaskControl::addWork(long long amount) {
+    _total += amount;
+}
+
+void TaskControl::advance(long long amount) {
+    _done += amount;
+}
+
+double TaskControl::getProgress() const {
+    long long total = _total;
+    return total > 0 ? std::min(1.0, (double) _done / total) : 0;
+}
+
+void TaskControl::setStatus(const std::string& status) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _status = status;
+}
+
+std::string TaskControl::getStatus() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _status;
+}
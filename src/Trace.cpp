@@ -0,0 +1,118 @@
+#include "Trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Events a thread keeps before writing them, and the longest it keeps them
+     */
+    const size_t FLUSH_EVENTS = 4096;
+    const std::chrono::seconds FLUSH_INTERVAL(1);
+
+    struct Event {
+        const char* name;
+        const char* category;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+        int tid;
+    };
+
+    std::atomic<bool> enabled{false};
+    std::atomic<int> next_tid{0};
+
+    /**
+     * @brief Trace file and the start of the trace, protected by the mutex
+     */
+    std::mutex mutex;
+    std::ofstream output;
+    std::chrono::steady_clock::time_point origin;
+
+    double micros(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    }
+
+    /**
+     * @brief Events of a thread, written to the file when there are many, when they are old, when the thread
+     * exits or when the trace stops
+     */
+    struct ThreadBuffer {
+        int tid = next_tid++;
+        std::vector<Event> events;
+        std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+
+        void flush() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const Event& e: events) {
+                    if (!output.is_open() || e.start < origin) {
+                        continue; // tracing stopped, or the event is from a previous trace
+                    }
+                    // names and categories are literals of the code, nothing to escape
+                    output << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\""
+                           << ",\"ts\":" << micros(e.start - origin) << ",\"dur\":" << micros(e.end - e.start)
+                           << ",\"pid\":1,\"tid\":" << e.tid << '}';
+                }
+            }
+            events.clear();
+            lastFlush = std::chrono::steady_clock::now();
+        }
+
+        ~ThreadBuffer() {
+            flush();
+        }
+    };
+
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer buffer;
+        return buffer;
+    }
+}
+
+bool trace::start(const std::string& file) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        output.close();
+        output.open(file);
+        if (!output.is_open()) {
+            return false;
+        }
+        output << std::fixed << std::setprecision(3);
+        output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"feup_da1\"}}";
+        origin = std::chrono::steady_clock::now();
+    }
+    threadBuffer().events.clear();
+    enabled = true;
+    return true;
+}
+
+bool trace::stop() {
+    if (!enabled) {
+        return false;
+    }
+    enabled = false;
+    threadBuffer().flush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    output << "\n]}\n";
+    bool written = output.good();
+    output.close();
+    return written;
+}
+
+bool trace::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void trace::record(const char* name, const char* category,
+                   std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    ThreadBuffer& buffer = threadBuffer();
+    buffer.events.push_back({name, category, start, end, buffer.tid});
+    if (buffer.events.size() >= FLUSH_EVENTS || end - buffer.lastFlush >= FLUSH_INTERVAL) {
+        buffer.flush();
+    }
+}
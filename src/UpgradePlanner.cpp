@@ -0,0 +1,274 @@
+#include "UpgradePlanner.h"
+#include "BitsetBFS.h"
+#include "MaxFlowSolver.h"
+#include "Trace.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+UpgradePlanner::UpgradePlanner(const Graph& g): _network(g) {
+    // The network has the vertexes in the same order as the graph
+    for (auto v: g.getVertexSet()) {
+        _regionOf[RegionCentrality::MUNICIPALITY].push_back(v->getStation().getMunicipality());
+        _regionOf[RegionCentrality::DISTRICT].push_back(v->getStation().getDistrict());
+    }
+}
+
+UpgradePlanner::Plan UpgradePlanner::plan(
+    const std::vector<int>& sources,
+    const std::vector<int>& sinks,
+    long long budget,
+    long long increment,
+    TaskControl* control
+) const {
+    TRACE_SPAN("UpgradePlanner", "analysis");
+    int n = _network.getNumVertex();
+    int num_arcs = _network.getNumArcs();
+
+    MaxFlowSolver64 solver(_network);
+    long long max_flow = std::max(0LL, solver.maxFlow(sources, sinks));
+    std::vector<long long> capacity(num_arcs), flow(num_arcs);
+    for (int a = 0; a < num_arcs; a++) {
+        capacity[a] = _network.getCapacity(a);
+        flow[a] = solver.getFlow(a);
+    }
+    Plan result = {max_flow, {}};
+    if (control != nullptr) {
+        control->addWork(budget);
+    }
+
+    // Flow and capacity of the arcs before they changed, to undo a try
+    std::vector<std::pair<int, long long>> changed_flow, changed_capacity;
+    auto add_flow = [&](int a, long long delta) {
+        int twin = _network.getTwin(a);
+        changed_flow.emplace_back(a, flow[a]);
+        changed_flow.emplace_back(twin, flow[twin]);
+        flow[a] += delta;
+        flow[twin] -= delta;
+    };
+    auto upgrade = [&](int a, long long amount) {
+        changed_capacity.emplace_back(a, capacity[a]);
+        capacity[a] += amount;
+        int twin = _network.getTwin(a);
+        if (_network.isEdge(twin)) {
+            changed_capacity.emplace_back(twin, capacity[twin]);
+            capacity[twin] += amount;
+        }
+    };
+    auto undo = [&]() {
+        for (auto it = changed_flow.rbegin(); it != changed_flow.rend(); it++) {
+            flow[it->first] = it->second;
+        }
+        for (auto it = changed_capacity.rbegin(); it != changed_capacity.rend(); it++) {
+            capacity[it->first] = it->second;
+        }
+        changed_flow.clear();
+        changed_capacity.clear();
+    };
+
+    auto residual = [&](int a) {
+        return capacity[a] - flow[a];
+    };
+    auto tail = [this](int a) {
+        return _network.getHead(_network.getTwin(a));
+    };
+
+    // Augment the current flow until there is no augmenting path
+    BitsetBFS bfs(_network);
+    bfs.setTargets(sinks);
+    auto augment = [&]() {
+        long long gain = 0;
+        for (int t = bfs.search(sources, [&residual](int a) { return residual(a) > 0; }); t != -1;
+             t = bfs.search(sources, [&residual](int a) { return residual(a) > 0; })) {
+            long long path_flow = std::numeric_limits<long long>::max();
+            for (int v = t; bfs.getParent(v) != -2; v = tail(bfs.getParent(v))) {
+                path_flow = std::min(path_flow, residual(bfs.getParent(v)));
+            }
+            for (int v = t; bfs.getParent(v) != -2; v = tail(bfs.getParent(v))) {
+                add_flow(bfs.getParent(v), path_flow);
+            }
+            utils::checkedAdd(gain, path_flow);
+        }
+        return gain;
+    };
+
+    // Gain of upgrading a set of links, undone after
+    auto try_upgrades = [&](const std::vector<int>& links, long long amount) {
+        for (int a: links) {
+            upgrade(a, amount);
+        }
+        long long gain = augment();
+        undo();
+        return gain;
+    };
+
+    BitsetBFS reach(_network);
+    std::vector<bool> from_sources(n), to_sinks(n);
+    long long remaining = budget;
+    while (remaining > 0 && (control == nullptr || !control->isCancelled())) {
+        long long amount = std::min(increment, remaining);
+
+        // Stations the sources still reach, and stations that still reach the sinks
+        reach.search(sources, [&residual](int a) {
+            return residual(a) > 0;
+        });
+        for (int v = 0; v < n; v++) {
+            from_sources[v] = reach.isVisited(v);
+        }
+        reach.search(sinks, [this, &residual](int a) {
+            return residual(_network.getTwin(a)) > 0;
+        });
+        for (int v = 0; v < n; v++) {
+            to_sinks[v] = reach.isVisited(v);
+        }
+
+        // Try each saturated link between them
+        int best = -1;
+        long long best_gain = 0;
+        for (int a = 0; a < num_arcs; a++) {
+            if (control != nullptr && control->isCancelled()) {
+                break;
+            }
+            if (!_network.isEdge(a) || !from_sources[tail(a)] || !to_sinks[_network.getHead(a)]) {
+                continue;
+            }
+
+            long long gain = try_upgrades({a}, amount);
+            if (gain > best_gain) {
+                best = a;
+                best_gain = gain;
+            }
+        }
+
+        std::vector<int> upgraded;
+        if (control != nullptr && control->isCancelled()) {
+            break; // the round was not finished, its best link may not be the best one
+        } else if (best != -1) {
+            upgraded.push_back(best);
+        } else {
+            // The path from a source to a sink with the fewest links that can't take the increment (0-1 BFS), they
+            // are upgraded together
+            std::vector<int> distance(n, std::numeric_limits<int>::max()), parent(n, -1);
+            std::deque<int> queue;
+            for (int s: sources) {
+                distance[s] = 0;
+                queue.push_back(s);
+            }
+            while (!queue.empty()) {
+                int v = queue.front();
+                queue.pop_front();
+                for (int a = _network.arcsBegin(v); a < _network.arcsEnd(v); a++) {
+                    int w = _network.getHead(a);
+                    int cost = residual(a) >= amount ? 0 : 1;
+                    if (cost == 1 && !_network.isEdge(a)) {
+                        if (residual(a) <= 0) {
+                            continue;
+                        }
+                        cost = 0; // only the flow can be cancelled, the path takes less
+                    }
+                    if (distance[v] + cost >= distance[w]) {
+                        continue;
+                    }
+
+                    distance[w] = distance[v] + cost;
+                    parent[w] = a;
+                    if (cost == 0) {
+                        queue.push_front(w);
+                    } else {
+                        queue.push_back(w);
+                    }
+                }
+            }
+
+            int sink = -1;
+            for (int t: sinks) {
+                if (distance[t] != std::numeric_limits<int>::max() && (sink == -1 || distance[t] < distance[sink])) {
+                    sink = t;
+                }
+            }
+            for (int v = sink; v != -1 && parent[v] != -1; v = tail(parent[v])) {
+                if (residual(parent[v]) < amount && _network.isEdge(parent[v])) {
+                    upgraded.push_back(parent[v]);
+                }
+            }
+            std::reverse(upgraded.begin(), upgraded.end());
+
+            // Drop the links the flow can go around once the others are upgraded
+            long long path_gain = try_upgrades(upgraded, amount);
+            for (size_t i = 0; i < upgraded.size() && upgraded.size() > 1 && path_gain > 0;) {
+                std::vector<int> without = upgraded;
+                without.erase(without.begin() + (long) i);
+                if (try_upgrades(without, amount) == path_gain) {
+                    upgraded = std::move(without);
+                } else {
+                    i++;
+                }
+            }
+            if (path_gain == 0) {
+                upgraded.clear();
+            }
+        }
+
+        if (upgraded.empty() || (long long) upgraded.size() > remaining / amount) {
+            break; // no upgrade raises the flow or the budget is not enough
+        }
+
+        // Upgrade the links in order, the flow after each one is exact as the augmentation is incremental
+        for (int a: upgraded) {
+            upgrade(a, amount);
+            max_flow += augment();
+            result.steps.push_back({_network.getName(tail(a)), _network.getName(_network.getHead(a)), amount, max_flow});
+        }
+        changed_flow.clear();
+        changed_capacity.clear();
+        remaining -= (long long) upgraded.size() * amount;
+        if (control != nullptr) {
+            control->advance((long long) upgraded.size() * amount);
+        }
+    }
+
+    if (control != nullptr) {
+        control->advance(remaining); // the budget left is not spent
+    }
+    return result;
+}
+
+UpgradePlanner::Plan UpgradePlanner::planPair(
+    const std::string& source,
+    const std::string& dest,
+    long long budget,
+    long long increment,
+    TaskControl* control
+) const {
+    int s = _network.findIndex(source);
+    int t = _network.findIndex(dest);
+    if (s == -1 || t == -1 || s == t || budget <= 0 || increment <= 0) {
+        return {-1, {}};
+    }
+    return plan({s}, {t}, budget, increment, control);
+}
+
+UpgradePlanner::Plan UpgradePlanner::planRegions(
+    RegionCentrality::Level level,
+    const std::string& source,
+    const std::string& dest,
+    long long budget,
+    long long increment,
+    TaskControl* control
+) const {
+    std::vector<int> sources, sinks;
+    for (int v = 0; v < _network.getNumVertex(); v++) {
+        if (_regionOf[level][v] == source) {
+            sources.push_back(v);
+        } else if (_regionOf[level][v] == dest) {
+            sinks.push_back(v);
+        }
+    }
+
+    if (sources.empty() || sinks.empty() || budget <= 0 || increment <= 0) {
+        return {-1, {}};
+    }
+    return plan(sources, sinks, budget, increment, control);
+}
@@ -1,6 +1,11 @@
 #include "Utils.h"
+#include "Stats.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 void utils::clearScreen() {
     std::cout << "\033[2J\033[1;1H";
@@ -15,3 +20,45 @@ void utils::waitEnter() {
 
     utils::clearScreen();
 }
+
+std::string utils::cacheDirectory() {
+    const char* cache_home = std::getenv("XDG_CACHE_HOME");
+    if (cache_home != nullptr && *cache_home != '\0') {
+        return std::string(cache_home) + "/feup_da1";
+    }
+
+    const char* home = std::getenv("HOME");
+    if (home != nullptr && *home != '\0') {
+        return std::string(home) + "/.cache/feup_da1";
+    }
+    return "";
+}
+
+unsigned int utils::numThreads(unsigned int requested, size_t tasks) {
+    if (requested == 0) {
+        requested = std::thread::hardware_concurrency();
+    }
+
+    return (unsigned int) std::max<size_t>(1, std::min<size_t>(requested, tasks));
+}
+
+void utils::runWorkers(unsigned int numThreads, const std::function<void()>& worker) {
+    // The counters of each thread are added to the caller's, so the work is measured wherever it runs
+    std::vector<stats::Counters> counters(numThreads > 1 ? numThreads - 1 : 0);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numThreads; i++) {
+        threads.emplace_back([&worker, &counters, i]() {
+            worker();
+            counters[i - 1] = stats::take();
+        });
+    }
+
+    worker();
+
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    for (const auto &thread_counters: counters) {
+        stats::current() += thread_counters;
+    }
+}
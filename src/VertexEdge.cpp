@@ -1,19 +1,32 @@
 #include "VertexEdge.h"
 
+#include <algorithm>
+#include <limits>
+
 /*===== Vertex =====*/
 
-Vertex::Vertex(const Station& station): _station(station) {}
+Vertex::Vertex(const Station& station): _station(std::make_shared<const Station>(station)) {}
+
+Vertex::Vertex(std::shared_ptr<const Station> station): _station(std::move(station)) {}
 
 const Station& Vertex::getStation() const {
+    return *this->_station;
+}
+
+const std::shared_ptr<const Station>& Vertex::getSharedStation() const {
     return this->_station;
 }
 
-std::vector<Edge *> Vertex::getAdj() const {
+const std::vector<Edge *>& Vertex::getAdj() const {
     return this->_adj;
 }
 
-bool Vertex::isVisited() const {
-    return this->_visited;
+size_t Vertex::getIndex() const {
+    return this->_index;
+}
+
+bool Vertex::isVisited(unsigned int epoch) const {
+    return this->_visitedEpoch == epoch;
 }
 
 bool Vertex::isProcessing() const {
@@ -28,20 +41,24 @@ Edge* Vertex::getPath() const {
     return this->_path;
 }
 
-std::vector<Edge *> Vertex::getIncomming() const {
+const std::vector<Edge *>& Vertex::getIncomming() const {
     return this->_incomming;
 }
 
-int Vertex::getDistance() const{
-    return this->_distance;
+int Vertex::getDistance(unsigned int epoch) const{
+    return this->_distanceEpoch == epoch ? this->_distance : std::numeric_limits<int>::max();
 }
 
 void Vertex::setStation(const Station& station) {
-    this->_station = station;
+    this->_station = std::make_shared<const Station>(station);
+}
+
+void Vertex::setIndex(size_t index) {
+    this->_index = index;
 }
 
-void Vertex::setVisited(bool visited) {
-    this->_visited = visited;
+void Vertex::setVisited(unsigned int epoch) {
+    this->_visitedEpoch = epoch;
 }
 
 void Vertex::setProcessing(bool processing) {
@@ -52,8 +69,9 @@ void Vertex::setIndegree(unsigned int indegree) {
     this->_indegree = indegree;
 }
 
-void Vertex::setDistance(int distance) {
+void Vertex::setDistance(int distance, unsigned int epoch) {
     this->_distance = distance;
+    this->_distanceEpoch = epoch;
 }
 
 void Vertex::setPath(Edge* path) {
@@ -67,36 +85,38 @@ Edge* Vertex::addEdge(Vertex* dest, int weight, const std::string& service) {
     return newEdge;
 }
 
-bool Vertex::removeEdge(const Station& destStation) {
-    bool edgeRemoved = false;
-    for (auto it = _adj.begin(); it != _adj.end();) {
-        Edge* edge = *it;
-        Vertex* dest = edge->getDest();
-        if (dest->getStation() == destStation) {
-            it = _adj.erase(it);
-
-            for (auto it2 = dest->_incomming.begin(); it2 != dest->_incomming.end();) {
-                if ((*it2)->getOrigin()->getStation() == _station) {
-                    it2 = dest->_incomming.erase(it2);
-                } else {
-                    it2++;
-                }
-            }
-
-            delete edge;
-            edgeRemoved = true;
+std::pair<size_t, size_t> Vertex::detachEdge(Edge* edge) {
+    // Searched from the back, where the edges removed with their vertex are
+    auto detach = [edge](std::vector<Edge *>& edges) {
+        size_t position = edges.rend() - std::find(edges.rbegin(), edges.rend(), edge) - 1;
+        edges[position] = edges.back();
+        edges.pop_back();
+        return position;
+    };
+
+    size_t adj_position = detach(_adj);
+    return {adj_position, detach(edge->getDest()->_incomming)};
+}
+
+void Vertex::attachEdge(Edge* edge, std::pair<size_t, size_t> positions) {
+    auto attach = [edge](std::vector<Edge *>& edges, size_t position) {
+        if (position == edges.size()) {
+            edges.push_back(edge);
         } else {
-            it++;
+            edges.push_back(edges[position]);
+            edges[position] = edge;
         }
-    }
+    };
 
-    return edgeRemoved;
+    attach(_adj, positions.first);
+    attach(edge->getDest()->_incomming, positions.second);
 }
 
 /*===== Edge =====*/
 
 Edge::Edge(Vertex* origin, Vertex* dest, int weight, const std::string& service)
-    : _origin(origin), _dest(dest), _weight(weight), _service(service) {}
+    : _origin(origin), _dest(dest), _weight(weight), _service(service),
+      _serviceType(service == "STANDARD" ? Service::STANDARD : Service::ALFA_PENDULAR) {}
 
 Vertex* Edge::getDest() const {
     return this->_dest;
@@ -114,19 +134,28 @@ Edge* Edge::getReverse() const {
     return this->_reverse;
 }
 
-int Edge::getFlow() const {
-    return this->_flow;
+int Edge::getFlow(unsigned int epoch) const {
+    return this->_flowEpoch == epoch ? this->_flow : 0;
 }
 
 const std::string& Edge::getService() const {
     return this->_service;
 }
 
+Service Edge::getServiceType() const {
+    return this->_serviceType;
+}
+
+void Edge::setWeight(int weight) {
+    this->_weight = weight;
+}
+
 void Edge::setReverse(Edge* reverse) {
     this->_reverse = reverse;
 }
 
-void Edge::setFlow(int flow) {
+void Edge::setFlow(int flow, unsigned int epoch) {
     this->_flow = flow;
+    this->_flowEpoch = epoch;
 }
 
@@ -1,8 +1,127 @@
+#include "Batch.h"
 #include "Menu.h"
+#include "Server.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Utils.h"
 
-int main() {
-    Menu menu;
-    menu.init();
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
 
-    return 0;
+/**
+ * Usage: feup_da1                                                interactive menu
+ *        feup_da1 --batch [queries|-] [stations.csv network.csv]    answer the queries of a file (or stdin), see Batch.h
+ *        feup_da1 --serve <socket> [stations.csv network.csv]       answer queries over a UNIX socket, see Server.h
+ *
+ * With --stats (batch only), the time and the work of each query are reported to stderr, see Stats.h.
+ * With --trace <file> (any mode), loading, flow solves, scenarios and rankings are traced to a Chrome trace JSON
+ * file, see Trace.h.
+ * The max flows of all the pairs of stations (a flow equivalent tree) are cached in files, in ~/.cache/feup_da1 or
+ * the directory given with --cache <dir> (any mode), --no-cache to not use files, see AllPairsFlows.h.
+ */
+namespace {
+    /**
+     * @brief Write the trace, if tracing, before exiting
+     *
+     * @param code Exit code
+     * @return int Exit code, 2 if the trace could not be written
+     */
+    int finish(int code) {
+        if (trace::isEnabled() && !trace::stop()) {
+            std::cerr << "Could not write the trace\n";
+            return 2;
+        }
+        return code;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> args;
+    bool report_stats = false;
+    std::string trace_file;
+    std::string cache_directory = utils::cacheDirectory();
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--stats") {
+            report_stats = true;
+        } else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else if (std::string(argv[i]) == "--cache" && i + 1 < argc) {
+            cache_directory = argv[++i];
+        } else if (std::string(argv[i]) == "--no-cache") {
+            cache_directory.clear();
+        } else {
+            args.emplace_back(argv[i]);
+        }
+    }
+
+    bool interactive = args.empty() && !report_stats;
+    std::string mode = args.empty() ? "" : args[0];
+    bool serve = mode == "--serve";
+    if (!interactive && ((mode != "--batch" && mode != "--serve") || (serve && (args.size() == 1 || report_stats))
+        || args.size() == 3 || args.size() > 4)) {
+        std::cerr << "Usage: " << argv[0] << " [--batch [queries|-] [stations.csv network.csv] [--stats]] [--trace file]\n"
+                  << "       " << argv[0] << " --serve <socket> [stations.csv network.csv] [--trace file]\n"
+                  << "       " << argv[0] << " [--trace file]\n"
+                  << "Any mode: [--cache dir|--no-cache]\n";
+        return 2;
+    }
+
+    if (!trace_file.empty() && !trace::start(trace_file)) {
+        std::cerr << "Could not open " << trace_file << '\n';
+        return 2;
+    }
+
+    if (interactive) {
+        Menu menu(cache_directory);
+        menu.init();
+
+        return finish(0);
+    }
+
+    std::string target = args.size() >= 2 ? args[1] : "-";
+    std::string stations = args.size() == 4 ? args[2] : Menu::STATIONS_INPUT;
+    std::string network = args.size() == 4 ? args[3] : Menu::NETWORK_INPUT;
+
+    Graph g;
+    if (!g.readData(stations, network)) {
+        std::cerr << "Could not read " << stations << " and " << network << '\n';
+        return finish(2);
+    }
+    g.setCacheDirectory(cache_directory);
+
+    if (serve) {
+        Server server(g, target);
+        if (!server.listen()) {
+            std::cerr << "Could not listen on " << target << ": " << std::strerror(errno) << '\n';
+            return finish(2);
+        }
+
+        server.run();
+        return finish(0);
+    }
+
+    std::ifstream file;
+    if (target != "-") {
+        file.open(target);
+        if (!file.is_open()) {
+            std::cerr << "Could not open " << target << '\n';
+            return finish(2);
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+    Batch batch(g);
+    if (report_stats) {
+        if (!stats::ENABLED) {
+            std::cerr << "# counters are not compiled in (cmake -DFEUP_DA1_STATS=ON), only times are reported\n";
+        }
+        batch.setStatsOutput(&std::cerr);
+    }
+    int errors = batch.run(target != "-" ? file : std::cin, std::cout);
+
+    return finish(errors ? 1 : 0);
 }